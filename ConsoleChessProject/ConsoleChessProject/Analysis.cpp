@@ -0,0 +1,126 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Analysis.hpp"
+#include "Search.hpp"
+#include "GameState.hpp"
+#include "ConcurrentQueue.hpp"
+#include "HelperFunctions.hpp"
+
+namespace Engine
+{
+	class AnalysisJob
+	{
+	public:
+		//The search runs on a copy so the game can keep changing while it thinks
+		std::unique_ptr<GameState> Position;
+		std::atomic<bool> StopSignal = false;
+		std::atomic<bool> PonderSignal = false;
+		Utils::Collections::ConcurrentQueue<SearchProgress> Progress;
+		std::promise<SearchResult> ResultPromise;
+		std::shared_future<SearchResult> Result;
+		std::thread Worker;
+
+		AnalysisJob() : Position(std::make_unique<GameState>()), Result(ResultPromise.get_future().share()) {}
+
+		~AnalysisJob()
+		{
+			StopSignal.store(true, std::memory_order_relaxed);
+			if (Worker.joinable()) Worker.join();
+		}
+	};
+
+	AnalysisHandle::AnalysisHandle() : m_job(nullptr) {}
+	AnalysisHandle::AnalysisHandle(std::shared_ptr<AnalysisJob> job) : m_job(std::move(job)) {}
+
+	bool AnalysisHandle::IsValid() const
+	{
+		return m_job != nullptr;
+	}
+
+	bool AnalysisHandle::IsRunning() const
+	{
+		return m_job != nullptr && m_job->Result.wait_for(std::chrono::seconds::zero()) != std::future_status::ready;
+	}
+
+	void AnalysisHandle::Stop()
+	{
+		if (m_job != nullptr) m_job->StopSignal.store(true, std::memory_order_relaxed);
+	}
+
+	void AnalysisHandle::PonderHit()
+	{
+		if (m_job != nullptr) m_job->PonderSignal.store(false, std::memory_order_relaxed);
+	}
+
+	SearchResult AnalysisHandle::Wait()
+	{
+		if (m_job == nullptr)
+		{
+			Utils::Log(Utils::LogType::Error, "Tried to wait for an analysis but the handle has no analysis");
+			return { Board::NULL_MOVE, 0, 0, 0, 0, {}, false, 0, 0 };
+		}
+		return m_job->Result.get();
+	}
+
+	std::shared_future<SearchResult> AnalysisHandle::GetFuture() const
+	{
+		if (m_job == nullptr) return {};
+		return m_job->Result;
+	}
+
+	bool AnalysisHandle::TryPopProgress(SearchProgress& progress)
+	{
+		return m_job != nullptr && m_job->Progress.TryPop(progress);
+	}
+
+	std::vector<SearchProgress> AnalysisHandle::DrainProgress()
+	{
+		if (m_job == nullptr) return {};
+		return m_job->Progress.Drain();
+	}
+
+	static AnalysisHandle StartJob(const GameState& state, const SearchLimits& limits, TranspositionTable& table,
+		const AnalysisCallback& callback, const bool isPondering)
+	{
+		auto job = std::make_shared<AnalysisJob>();
+		CopyPosition(state, *job->Position);
+
+		SearchLimits jobLimits = limits;
+		//The job outlives its thread (its destructor joins it) so the thread can use it without owning it
+		AnalysisJob* jobPointer = job.get();
+		jobLimits.StopSignal = &jobPointer->StopSignal;
+		jobPointer->PonderSignal.store(isPondering, std::memory_order_relaxed);
+		jobLimits.PonderSignal = isPondering ? &jobPointer->PonderSignal : nullptr;
+		jobLimits.OnProgress = [jobPointer, callback](const SearchProgress& progress) -> void
+			{
+				jobPointer->Progress.Push(progress);
+				if (callback) callback(progress);
+			};
+
+		job->Worker = std::thread([jobPointer, jobLimits, &table, callback]() -> void
+			{
+				const SearchResult result = Search(*jobPointer->Position, jobLimits, table);
+				const SearchProgress finalProgress = { result.Depth, result.Score, result.Nodes, result.Seconds, result.PrincipalVariation, true };
+				jobPointer->Progress.Push(finalProgress);
+				//The callback comes before the result so anything waiting on the result knows the callback is done with
+				if (callback) callback(finalProgress);
+				jobPointer->ResultPromise.set_value(result);
+			});
+		return AnalysisHandle(std::move(job));
+	}
+
+	AnalysisHandle StartAnalysis(const GameState& state, const SearchLimits& limits, TranspositionTable& table,
+		const AnalysisCallback& callback)
+	{
+		return StartJob(state, limits, table, callback, false);
+	}
+
+	AnalysisHandle StartPondering(const GameState& state, const SearchLimits& limits, TranspositionTable& table)
+	{
+		return StartJob(state, limits, table, nullptr, true);
+	}
+}
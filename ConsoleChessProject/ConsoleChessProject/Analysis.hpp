@@ -0,0 +1,84 @@
+#pragma once
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+#include "GameState.hpp"
+#include "Search.hpp"
+#include "TranspositionTable.hpp"
+
+namespace Engine
+{
+	//Called on the analysis thread after each update is queued (for waking up the thread that drains the queue)
+	using AnalysisCallback = std::function<void(const SearchProgress& progress)>;
+
+	class AnalysisJob;
+
+	/// <summary>
+	/// Shared access to a search running on its own thread. Every completed depth (and then the final result) is put
+	/// in a queue that the owner drains from its own thread, so the thread that started it never waits on the engine.
+	/// The search is stopped and its thread joined once the last handle to it is destroyed
+	/// </summary>
+	class AnalysisHandle
+	{
+	private:
+		std::shared_ptr<AnalysisJob> m_job;
+
+	public:
+		AnalysisHandle();
+		explicit AnalysisHandle(std::shared_ptr<AnalysisJob> job);
+
+		//False for a default handle or one whose analysis could not be started
+		bool IsValid() const;
+		bool IsRunning() const;
+
+		/// <summary>
+		/// Asks the search to stop as soon as it checks its limits (the result is still the last completed depth)
+		/// </summary>
+		void Stop();
+
+		/// <summary>
+		/// Tells a pondering search that the predicted move was played, so its time limits start to apply
+		/// (counted from when pondering started). Does nothing for a normal analysis
+		/// </summary>
+		void PonderHit();
+
+		/// <summary>
+		/// Blocks until the search is done and returns its result
+		/// </summary>
+		/// <returns></returns>
+		SearchResult Wait();
+		std::shared_future<SearchResult> GetFuture() const;
+
+		bool TryPopProgress(SearchProgress& progress);
+		/// <summary>
+		/// Removes and returns every update the search has made since the last drain (oldest first)
+		/// </summary>
+		/// <returns></returns>
+		std::vector<SearchProgress> DrainProgress();
+	};
+
+	/// <summary>
+	/// Starts searching a copy of the position on a new thread. The limits' stop signal and progress callback are
+	/// replaced by the handle's, and with no other limit the analysis runs until it is stopped.
+	/// The table (and network in the limits) must outlive the analysis and must not be resized or loaded during it
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="limits"></param>
+	/// <param name="table"></param>
+	/// <param name="callback"></param>
+	/// <returns></returns>
+	AnalysisHandle StartAnalysis(const GameState& state, const SearchLimits& limits, TranspositionTable& table,
+		const AnalysisCallback& callback);
+
+	/// <summary>
+	/// Starts searching a copy of the position on the opponent's time. The time limits are ignored until
+	/// the handle's PonderHit is called, while depth and node limits still end the search early.
+	/// The same lifetime rules as StartAnalysis apply
+	/// </summary>
+	/// <param name="state">The position after the opponent's predicted reply</param>
+	/// <param name="limits"></param>
+	/// <param name="table"></param>
+	/// <returns></returns>
+	AnalysisHandle StartPondering(const GameState& state, const SearchLimits& limits, TranspositionTable& table);
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <format>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include "Search.hpp"
+#include "Nnue.hpp"
+#include "Tablebase.hpp"
+#include "GameAnnotation.hpp"
+
+//Headless batch annotation tool (built as its own console target with CONSOLE_LOGGING defined):
+//	<input pgn> <output pgn> [options]	searches every position of every game in the input and writes the games in the same
+//										order with evaluations and marked mistakes, then reports games and positions per second
+//Options (name=value), the per move budget defaults to depth 8 when none is given:
+//	depth=N nodes=N movetime=ms			the budget of each position's search
+//	threads=N							positions searched at once (defaults to every core)
+//	hash=MB								transposition table size of each thread
+//	network=file tablebases=directory	evaluate with the network and score endings from the tables
+
+static constexpr int DEFAULT_ANNOTATION_DEPTH = 8;
+
+static void PrintUsage()
+{
+	std::cout << "Usage:\n  <input pgn> <output pgn> [depth=N] [nodes=N] [movetime=ms] [threads=N] [hash=MB] "
+		"[network=file] [tablebases=directory]" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	Engine::AnnotationSettings settings;
+	settings.Threads = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, Engine::MAX_SEARCH_THREADS);
+	Engine::NnueNetwork network;
+	Engine::Tablebase tablebases;
+	for (int i = 3; i < argc; i++)
+	{
+		const std::string option = argv[i];
+		const size_t separator = option.find('=');
+		const std::string name = option.substr(0, separator);
+		const std::string value = separator == std::string::npos ? "" : option.substr(separator + 1);
+		if (value.empty())
+		{
+			PrintUsage();
+			return 1;
+		}
+
+		if (name == "depth") settings.Limits.Depth = std::stoi(value);
+		else if (name == "nodes") settings.Limits.Nodes = std::stoull(value);
+		else if (name == "movetime") settings.Limits.MoveTime = std::chrono::milliseconds(std::stoi(value));
+		else if (name == "threads") settings.Threads = std::stoi(value);
+		else if (name == "hash") settings.HashMegabytes = std::stoull(value);
+		else if (name == "network")
+		{
+			if (!network.TryLoad(value)) return 1;
+			settings.Limits.Network = &network;
+		}
+		else if (name == "tablebases")
+		{
+			if (!tablebases.TryLoad(value)) return 1;
+			settings.Limits.Tablebases = &tablebases;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	const bool hasBudget = settings.Limits.Depth > 0 || settings.Limits.Nodes > 0 || settings.Limits.MoveTime.count() > 0;
+	if (!hasBudget) settings.Limits.Depth = DEFAULT_ANNOTATION_DEPTH;
+
+	std::ifstream input(argv[1]);
+	if (!input.is_open())
+	{
+		std::cout << std::format("Could not open the input: {}", argv[1]) << std::endl;
+		return 1;
+	}
+	std::ofstream output(argv[2], std::ios::trunc);
+	if (!output.is_open())
+	{
+		std::cout << std::format("Could not open the output: {}", argv[2]) << std::endl;
+		return 1;
+	}
+
+	Engine::AnnotationReport report;
+	if (!Engine::TryAnnotateGames(input, output, settings, report)) return 1;
+
+	std::cout << std::format("Games: {} ({} unreadable) Positions: {} Nodes: {} Time: {:.2f}s Threads: {}",
+		report.GameCount, report.UnreadableGameCount, report.PositionCount, report.Nodes, report.Seconds, settings.Threads) << std::endl;
+	std::cout << std::format("Games/s: {:.2f} Positions/s: {:.1f} Stolen searches: {}",
+		Engine::GetGamesPerSecond(report), Engine::GetPositionsPerSecond(report), report.StolenSearchCount) << std::endl;
+	std::cout << std::format("Inaccuracies: {} Mistakes: {} Blunders: {}",
+		report.InaccuracyCount, report.MistakeCount, report.BlunderCount) << std::endl;
+	return 0;
+}
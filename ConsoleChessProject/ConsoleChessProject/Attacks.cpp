@@ -0,0 +1,322 @@
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include "Attacks.hpp"
+#include "Bitboard.hpp"
+#include "Globals.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define HAS_X64_INTRINSICS
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(HAS_X64_INTRINSICS) && !defined(_MSC_VER)
+#define BMI2_TARGET __attribute__((target("bmi2")))
+#else
+#define BMI2_TARGET
+#endif
+
+namespace Board
+{
+	//Total table sizes are the sums of 2^(relevant mask bits) over all squares
+	static constexpr size_t ROOK_TABLE_SIZE = 102400;
+	static constexpr size_t BISHOP_TABLE_SIZE = 5248;
+
+	struct SlidingAttackEntry
+	{
+		Bitboard Mask;
+		Bitboard Magic;
+		Bitboard* Attacks;
+		unsigned int Shift;
+	};
+
+	static std::array<Bitboard, ROOK_TABLE_SIZE> rookAttackTable;
+	static std::array<Bitboard, BISHOP_TABLE_SIZE> bishopAttackTable;
+	static std::array<SlidingAttackEntry, SQUARE_COUNT> rookEntries;
+	static std::array<SlidingAttackEntry, SQUARE_COUNT> bishopEntries;
+	static bool usePextIndexing = false;
+
+	static std::array<std::array<Bitboard, SQUARE_COUNT>, SQUARE_COUNT> betweenTable;
+	static std::array<std::array<Bitboard, SQUARE_COUNT>, SQUARE_COUNT> lineTable;
+
+	static constexpr std::array<SquareOffset, 4> ROOK_DIRECTIONS = { { {1, 0}, {-1, 0}, {0, 1}, {0, -1} } };
+	static constexpr std::array<SquareOffset, 4> BISHOP_DIRECTIONS = { { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} } };
+
+	BMI2_TARGET static inline Bitboard ParallelExtract(const Bitboard value, const Bitboard mask)
+	{
+#ifdef HAS_X64_INTRINSICS
+		return _pext_u64(value, mask);
+#else
+		return 0;
+#endif
+	}
+
+	/// <summary>
+	/// PEXT is only used when the cpu reports BMI2 and it is not an AMD cpu before Zen 3,
+	/// since those implement PEXT in microcode and it is much slower than a magic multiply
+	/// </summary>
+	/// <returns></returns>
+	static bool HasFastPext()
+	{
+#ifdef HAS_X64_INTRINSICS
+		unsigned int registers[4] = {};
+#if defined(_MSC_VER)
+		int msvcRegisters[4] = {};
+		__cpuid(msvcRegisters, 0);
+		if (msvcRegisters[0] < 7) return false;
+		std::memcpy(registers, msvcRegisters, sizeof(registers));
+#else
+		if (!__get_cpuid(0, &registers[0], &registers[1], &registers[2], &registers[3]) || registers[0] < 7) return false;
+#endif
+		//Vendor string is stored in ebx, edx, ecx order
+		char vendor[13] = {};
+		std::memcpy(vendor, &registers[1], 4);
+		std::memcpy(vendor + 4, &registers[3], 4);
+		std::memcpy(vendor + 8, &registers[2], 4);
+
+#if defined(_MSC_VER)
+		__cpuid(msvcRegisters, 1);
+		std::memcpy(registers, msvcRegisters, sizeof(registers));
+#else
+		__get_cpuid(1, &registers[0], &registers[1], &registers[2], &registers[3]);
+#endif
+		const unsigned int family = ((registers[0] >> 8) & 0xF) + ((registers[0] >> 20) & 0xFF);
+		if (std::strcmp(vendor, "AuthenticAMD") == 0 && family < 0x19) return false;
+
+#if defined(_MSC_VER)
+		__cpuidex(msvcRegisters, 7, 0);
+		std::memcpy(registers, msvcRegisters, sizeof(registers));
+#else
+		__cpuid_count(7, 0, registers[0], registers[1], registers[2], registers[3]);
+#endif
+		constexpr unsigned int BMI2_BIT = 1u << 8;
+		return (registers[1] & BMI2_BIT) != 0;
+#else
+		return false;
+#endif
+	}
+
+	//Steps each direction from the square until it hits a blocker (inclusive) or the edge.
+	//This is only used to fill the tables so speed does not matter here
+	static Bitboard CalculateSlidingAttacks(const Square square, const Bitboard occupancy,
+		const std::array<SquareOffset, 4>& directions)
+	{
+		Bitboard attacks = EMPTY_BITBOARD;
+		for (const auto& direction : directions)
+		{
+			int rank = GetRank(square) + direction.RankDelta;
+			int file = GetFile(square) + direction.FileDelta;
+			while (rank >= 0 && rank < BOARD_DIMENSION && file >= 0 && file < BOARD_DIMENSION)
+			{
+				const Bitboard bit = ToBitboard(rank * BOARD_DIMENSION + file);
+				attacks |= bit;
+				if (occupancy & bit) break;
+
+				rank += direction.RankDelta;
+				file += direction.FileDelta;
+			}
+		}
+		return attacks;
+	}
+
+	//The relevant occupancy excludes the board edges in each direction since a
+	//piece on the last square of a ray never changes which squares are attacked
+	static Bitboard CalculateRelevantMask(const Square square, const std::array<SquareOffset, 4>& directions)
+	{
+		Bitboard mask = EMPTY_BITBOARD;
+		for (const auto& direction : directions)
+		{
+			int rank = GetRank(square) + direction.RankDelta;
+			int file = GetFile(square) + direction.FileDelta;
+			while (rank + direction.RankDelta >= 0 && rank + direction.RankDelta < BOARD_DIMENSION &&
+				   file + direction.FileDelta >= 0 && file + direction.FileDelta < BOARD_DIMENSION)
+			{
+				mask |= ToBitboard(rank * BOARD_DIMENSION + file);
+				rank += direction.RankDelta;
+				file += direction.FileDelta;
+			}
+		}
+		return mask;
+	}
+
+	static inline size_t GetAttackIndex(const SlidingAttackEntry& entry, const Bitboard occupancy)
+	{
+		if (usePextIndexing) return static_cast<size_t>(ParallelExtract(occupancy, entry.Mask));
+		return static_cast<size_t>(((occupancy & entry.Mask) * entry.Magic) >> entry.Shift);
+	}
+
+	//Deterministic xorshift generator so the magics found are the same on every startup
+	static std::uint64_t NextRandom(std::uint64_t& seed)
+	{
+		seed ^= seed >> 12;
+		seed ^= seed << 25;
+		seed ^= seed >> 27;
+		return seed * 2685821657736338717ull;
+	}
+
+	/// <summary>
+	/// Fills the attack table for every square of one slider type. With PEXT the subsets map directly
+	/// to indices, otherwise a magic number is searched for that maps every subset without destructive collisions
+	/// </summary>
+	static void InitSlidingAttacks(Bitboard* table, std::array<SlidingAttackEntry, SQUARE_COUNT>& entries,
+		const std::array<SquareOffset, 4>& directions)
+	{
+		//Max relevant bits for any slider is 12 (rook on a corner)
+		constexpr size_t MAX_SUBSETS = 4096;
+		std::array<Bitboard, MAX_SUBSETS> occupancies;
+		std::array<Bitboard, MAX_SUBSETS> references;
+		std::array<int, MAX_SUBSETS> attemptStamps = {};
+
+		//Per rank seeds that are known to find magics quickly with this generator
+		constexpr std::array<std::uint64_t, BOARD_DIMENSION> RANK_SEEDS = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+		Bitboard* nextAttacks = table;
+		int attempt = 0;
+
+		for (Square square = 0; square < SQUARE_COUNT; square++)
+		{
+			SlidingAttackEntry& entry = entries[square];
+			entry.Mask = CalculateRelevantMask(square, directions);
+			const int relevantBits = PopCount(entry.Mask);
+			entry.Shift = 64 - relevantBits;
+			entry.Attacks = nextAttacks;
+			entry.Magic = 0;
+
+			//Carry rippler trick to walk every subset of the mask
+			size_t subsetCount = 0;
+			Bitboard subset = EMPTY_BITBOARD;
+			do
+			{
+				occupancies[subsetCount] = subset;
+				references[subsetCount] = CalculateSlidingAttacks(square, subset, directions);
+				subsetCount++;
+				subset = (subset - entry.Mask) & entry.Mask;
+			} while (subset);
+
+			if (usePextIndexing)
+			{
+				for (size_t i = 0; i < subsetCount; i++)
+					entry.Attacks[ParallelExtract(occupancies[i], entry.Mask)] = references[i];
+			}
+			else
+			{
+				std::uint64_t seed = RANK_SEEDS[GetRank(square)];
+				bool foundMagic = false;
+				while (!foundMagic)
+				{
+					//Sparse candidates (few set bits) are far more likely to be valid magics
+					entry.Magic = NextRandom(seed) & NextRandom(seed) & NextRandom(seed);
+					if (PopCount((entry.Mask * entry.Magic) >> 56) < 6) continue;
+
+					attempt++;
+					foundMagic = true;
+					for (size_t i = 0; i < subsetCount; i++)
+					{
+						const size_t index = GetAttackIndex(entry, occupancies[i]);
+						if (attemptStamps[index] < attempt)
+						{
+							attemptStamps[index] = attempt;
+							entry.Attacks[index] = references[i];
+						}
+						else if (entry.Attacks[index] != references[i])
+						{
+							foundMagic = false;
+							break;
+						}
+					}
+				}
+			}
+			nextAttacks += subsetCount;
+		}
+	}
+
+	//Uses the finished slider tables: two squares on the same rank, file or diagonal see each other
+	//on an empty board and the squares between them are where their rays overlap when each blocks the other
+	static void InitLineTables()
+	{
+		for (Square first = 0; first < SQUARE_COUNT; first++)
+		{
+			for (Square second = 0; second < SQUARE_COUNT; second++)
+			{
+				betweenTable[first][second] = EMPTY_BITBOARD;
+				lineTable[first][second] = EMPTY_BITBOARD;
+				if (first == second) continue;
+
+				const Bitboard ends = ToBitboard(first) | ToBitboard(second);
+				if (GetRookAttacks(first, EMPTY_BITBOARD) & ToBitboard(second))
+				{
+					betweenTable[first][second] = GetRookAttacks(first, ToBitboard(second)) & GetRookAttacks(second, ToBitboard(first));
+					lineTable[first][second] = (GetRookAttacks(first, EMPTY_BITBOARD) & GetRookAttacks(second, EMPTY_BITBOARD)) | ends;
+				}
+				else if (GetBishopAttacks(first, EMPTY_BITBOARD) & ToBitboard(second))
+				{
+					betweenTable[first][second] = GetBishopAttacks(first, ToBitboard(second)) & GetBishopAttacks(second, ToBitboard(first));
+					lineTable[first][second] = (GetBishopAttacks(first, EMPTY_BITBOARD) & GetBishopAttacks(second, EMPTY_BITBOARD)) | ends;
+				}
+			}
+		}
+	}
+
+	//Builds all sliding attack tables once at program startup
+	struct SlidingAttackTablesInitializer
+	{
+		SlidingAttackTablesInitializer()
+		{
+			usePextIndexing = HasFastPext();
+			InitSlidingAttacks(rookAttackTable.data(), rookEntries, ROOK_DIRECTIONS);
+			InitSlidingAttacks(bishopAttackTable.data(), bishopEntries, BISHOP_DIRECTIONS);
+			InitLineTables();
+		}
+	};
+	static const SlidingAttackTablesInitializer slidingAttackTablesInitializer;
+
+	Bitboard GetRookAttacks(const Square square, const Bitboard occupancy)
+	{
+		const SlidingAttackEntry& entry = rookEntries[square];
+		return entry.Attacks[GetAttackIndex(entry, occupancy)];
+	}
+
+	Bitboard GetBishopAttacks(const Square square, const Bitboard occupancy)
+	{
+		const SlidingAttackEntry& entry = bishopEntries[square];
+		return entry.Attacks[GetAttackIndex(entry, occupancy)];
+	}
+
+	Bitboard GetQueenAttacks(const Square square, const Bitboard occupancy)
+	{
+		return GetRookAttacks(square, occupancy) | GetBishopAttacks(square, occupancy);
+	}
+
+	Bitboard GetBetween(const Square first, const Square second)
+	{
+		return betweenTable[first][second];
+	}
+
+	Bitboard GetLine(const Square first, const Square second)
+	{
+		return lineTable[first][second];
+	}
+
+	Bitboard GetAttackersTo(const BitboardSet& board, const Square square, const ArmyColor byColor, const Bitboard occupancy)
+	{
+		const auto& pieces = board.Pieces[ToIndex(byColor)];
+		const Bitboard queens = pieces[ToIndex(PieceType::Queen)];
+
+		//A pawn of the attacker attacks the square exactly when a pawn of the other
+		//color on the square would attack that pawn, so we use the mirrored table
+		return (GetPawnAttacks(GetOppositeColor(byColor), square) & pieces[ToIndex(PieceType::Pawn)]) |
+			   (GetKnightAttacks(square) & pieces[ToIndex(PieceType::Knight)]) |
+			   (GetKingAttacks(square) & pieces[ToIndex(PieceType::King)]) |
+			   (GetBishopAttacks(square, occupancy) & (pieces[ToIndex(PieceType::Bishop)] | queens)) |
+			   (GetRookAttacks(square, occupancy) & (pieces[ToIndex(PieceType::Rook)] | queens));
+	}
+
+	bool IsUsingPextAttacks()
+	{
+		return usePextIndexing;
+	}
+}
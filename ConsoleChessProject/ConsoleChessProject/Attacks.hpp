@@ -0,0 +1,86 @@
+#pragma once
+#include <array>
+#include "Bitboard.hpp"
+#include "Color.hpp"
+#include "Globals.hpp"
+
+namespace Board
+{
+	struct SquareOffset
+	{
+		int RankDelta;
+		int FileDelta;
+	};
+
+	constexpr std::array<SquareOffset, 8> KNIGHT_OFFSETS = { {
+		{2, 1}, {1, 2}, {-1, 2}, {-2, 1}, {-2, -1}, {-1, -2}, {1, -2}, {2, -1} } };
+	constexpr std::array<SquareOffset, 8> KING_OFFSETS = { {
+		{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1} } };
+
+	//Light moves up the ranks and dark moves down so their pawn captures mirror each other
+	constexpr std::array<SquareOffset, 2> LIGHT_PAWN_CAPTURE_OFFSETS = { { {1, -1}, {1, 1} } };
+	constexpr std::array<SquareOffset, 2> DARK_PAWN_CAPTURE_OFFSETS = { { {-1, -1}, {-1, 1} } };
+
+	template<size_t OffsetCount>
+	constexpr std::array<Bitboard, SQUARE_COUNT> CreateLeaperAttacks(const std::array<SquareOffset, OffsetCount>& offsets)
+	{
+		std::array<Bitboard, SQUARE_COUNT> attacks = {};
+		for (Square square = 0; square < SQUARE_COUNT; square++)
+		{
+			for (const auto& offset : offsets)
+			{
+				const int rank = GetRank(square) + offset.RankDelta;
+				const int file = GetFile(square) + offset.FileDelta;
+				if (rank < 0 || rank >= BOARD_DIMENSION || file < 0 || file >= BOARD_DIMENSION) continue;
+				attacks[square] |= Bitboard{ 1 } << (rank * BOARD_DIMENSION + file);
+			}
+		}
+		return attacks;
+	}
+
+	inline constexpr std::array<Bitboard, SQUARE_COUNT> KNIGHT_ATTACKS = CreateLeaperAttacks(KNIGHT_OFFSETS);
+	inline constexpr std::array<Bitboard, SQUARE_COUNT> KING_ATTACKS = CreateLeaperAttacks(KING_OFFSETS);
+	inline constexpr std::array<std::array<Bitboard, SQUARE_COUNT>, TEAMS_COUNT> PAWN_ATTACKS = {
+		CreateLeaperAttacks(LIGHT_PAWN_CAPTURE_OFFSETS), CreateLeaperAttacks(DARK_PAWN_CAPTURE_OFFSETS) };
+
+	inline Bitboard GetKnightAttacks(const Square square) { return KNIGHT_ATTACKS[square]; }
+	inline Bitboard GetKingAttacks(const Square square) { return KING_ATTACKS[square]; }
+
+	/// <summary>
+	/// Returns the squares a pawn of the color on the square attacks (its diagonal captures)
+	/// </summary>
+	/// <param name="color"></param>
+	/// <param name="square"></param>
+	/// <returns></returns>
+	inline Bitboard GetPawnAttacks(const ArmyColor color, const Square square) { return PAWN_ATTACKS[ToIndex(color)][square]; }
+
+	//Sliding attacks are looked up from tables built at startup, indexed with PEXT
+	//when the cpu has fast BMI2 and with magic multiplication otherwise.
+	//Note: occupancy is the full board occupancy and the result includes the first blocker in each direction
+	Bitboard GetRookAttacks(const Square square, const Bitboard occupancy);
+	Bitboard GetBishopAttacks(const Square square, const Bitboard occupancy);
+	Bitboard GetQueenAttacks(const Square square, const Bitboard occupancy);
+
+	//Note: both are empty when the squares are not on the same rank, file or diagonal
+	//Returns the squares strictly between the two squares
+	Bitboard GetBetween(const Square first, const Square second);
+	//Returns the full line (edge to edge) going through both squares
+	Bitboard GetLine(const Square first, const Square second);
+
+	/// <summary>
+	/// Returns every piece of the color that attacks the square when the board has the occupancy.
+	/// The occupancy is passed separately so callers can test squares with pieces removed (like a moving king)
+	/// </summary>
+	/// <param name="board"></param>
+	/// <param name="square"></param>
+	/// <param name="byColor"></param>
+	/// <param name="occupancy"></param>
+	/// <returns></returns>
+	Bitboard GetAttackersTo(const BitboardSet& board, const Square square, const ArmyColor byColor, const Bitboard occupancy);
+
+	/// <summary>
+	/// Returns true if sliding attack tables are indexed with the BMI2 PEXT instruction
+	/// </summary>
+	/// <returns></returns>
+	bool IsUsingPextAttacks();
+}
@@ -0,0 +1,188 @@
+#include <iostream>
+#include <string>
+#include <memory>
+#include <format>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include "GameState.hpp"
+#include "BoardManager.hpp"
+#include "Perft.hpp"
+#include "Search.hpp"
+#include "TranspositionTable.hpp"
+#include "MoveGeneration.hpp"
+#include "MoveExecution.hpp"
+#include "Evaluation.hpp"
+#include "Nnue.hpp"
+
+//Headless search benchmark (built as its own console target with CONSOLE_LOGGING defined):
+//	threads [maxThreads] [moveTimeMs]	searches every reference position with 1, 2, 4... up to maxThreads
+//										and reports nodes per second and the scaling over one thread
+//	ordering [depth]					searches every reference position to the depth on one thread and reports
+//										how often cutoffs come from the first move and the effective branching factor
+//	eval <networkFile> [depth]			evaluates every node of the reference positions' trees to the depth with the classical
+//										evaluation and the network at each supported simd level and reports evaluations per second
+//										(the time of the same walk without evaluating is taken off so only evaluating is measured)
+
+static constexpr int DEFAULT_BENCH_MOVE_TIME_MS = 1000;
+static constexpr int DEFAULT_ORDERING_DEPTH = 8;
+static constexpr int DEFAULT_EVAL_DEPTH = 4;
+
+struct BenchResult
+{
+	std::uint64_t Nodes;
+	double Seconds;
+};
+
+static BenchResult RunSearchBench(const int threads, const std::chrono::milliseconds moveTime)
+{
+	//Every run starts from an empty table so earlier runs do not make later ones look faster
+	Engine::TranspositionTable table(Engine::DEFAULT_HASH_MEGABYTES);
+	auto state = std::make_unique<GameState>();
+	BenchResult benchResult = { 0, 0 };
+
+	for (const auto& position : Board::GetPerftReferencePositions())
+	{
+		if (!Board::TryLoadFen(*state, position.Fen)) continue;
+
+		Engine::SearchLimits limits;
+		limits.MoveTime = moveTime;
+		limits.Threads = threads;
+		const Engine::SearchResult result = Engine::Search(*state, limits, table);
+		benchResult.Nodes += result.Nodes;
+		benchResult.Seconds += result.Seconds;
+	}
+	return benchResult;
+}
+
+static void RunOrderingBench(const int depth)
+{
+	auto state = std::make_unique<GameState>();
+	for (const auto& position : Board::GetPerftReferencePositions())
+	{
+		if (!Board::TryLoadFen(*state, position.Fen)) continue;
+
+		Engine::TranspositionTable table(Engine::DEFAULT_HASH_MEGABYTES);
+		Engine::SearchLimits limits;
+		limits.Depth = depth;
+		const Engine::SearchResult result = Engine::Search(*state, limits, table);
+		const double branchingFactor = result.Depth > 0 ? std::pow(static_cast<double>(result.Nodes), 1.0 / result.Depth) : 0;
+
+		std::cout << std::format("{} depth {}: Nodes: {} Time: {:.3f}s First move cutoffs: {:.1f}% Branching factor: {:.2f}",
+			position.Name, result.Depth, result.Nodes, result.Seconds, result.FirstMoveCutoffRate * 100, branchingFactor) << std::endl;
+	}
+}
+
+enum class BenchEvaluator
+{
+	None,
+	Classical,
+	Network,
+};
+
+//Returns the sum of every score so the evaluations can not be optimized away and the simd levels can be checked to agree
+static std::int64_t WalkAndEvaluate(GameState& state, const int depth, const BenchEvaluator evaluator, const Engine::NnueNetwork& network,
+	Engine::NnueAccumulator* accumulators, std::uint64_t& nodes)
+{
+	nodes++;
+	std::int64_t scoreSum = 0;
+	if (evaluator == BenchEvaluator::Classical) scoreSum += Engine::Evaluate(state);
+	else if (evaluator == BenchEvaluator::Network) scoreSum += network.Evaluate(accumulators[0], state.CurrentPlayer);
+	if (depth == 0) return scoreSum;
+
+	Board::MoveList moves;
+	Board::GenerateLegalMoves(state, moves);
+	for (const auto& move : moves)
+	{
+		Board::MakeMove(state, move);
+		if (evaluator == BenchEvaluator::Network) network.UpdateAccumulator(state, accumulators[0], accumulators[1]);
+		scoreSum += WalkAndEvaluate(state, depth - 1, evaluator, network, accumulators + 1, nodes);
+		Board::UnmakeMove(state);
+	}
+	return scoreSum;
+}
+
+static BenchResult RunEvaluationWalk(const int depth, const BenchEvaluator evaluator, const Engine::NnueNetwork& network, 
+	std::int64_t& scoreSum)
+{
+	auto state = std::make_unique<GameState>();
+	auto accumulators = std::make_unique<Engine::NnueAccumulator[]>(depth + 1);
+	BenchResult benchResult = { 0, 0 };
+	scoreSum = 0;
+
+	const auto startTime = std::chrono::steady_clock::now();
+	for (const auto& position : Board::GetPerftReferencePositions())
+	{
+		if (!Board::TryLoadFen(*state, position.Fen)) continue;
+		if (evaluator == BenchEvaluator::Network) network.RefreshAccumulator(*state, accumulators[0]);
+		scoreSum += WalkAndEvaluate(*state, depth, evaluator, network, accumulators.get(), benchResult.Nodes);
+	}
+	benchResult.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	return benchResult;
+}
+
+static void RunEvaluationWalkBench(const std::string& name, const int depth, const BenchEvaluator evaluator, 
+	const Engine::NnueNetwork& network, const BenchResult& walkOnly)
+{
+	std::int64_t scoreSum = 0;
+	const BenchResult result = RunEvaluationWalk(depth, evaluator, network, scoreSum);
+	const double seconds = std::max(result.Seconds - walkOnly.Seconds, 1e-9);
+	std::cout << std::format("{}: Evaluations: {} Time: {:.3f}s Evaluations per second: {:.0f} Score sum: {}",
+		name, result.Nodes, seconds, result.Nodes / seconds, scoreSum) << std::endl;
+}
+
+static int RunEvaluationBench(const std::string& networkPath, const int depth)
+{
+	Engine::NnueNetwork network;
+	if (!network.TryLoad(networkPath)) return 1;
+
+	const Engine::SimdLevel bestLevel = Engine::GetNnueSimdLevel();
+	std::int64_t scoreSum = 0;
+	const BenchResult walkOnly = RunEvaluationWalk(depth, BenchEvaluator::None, network, scoreSum);
+	RunEvaluationWalkBench("Classical", depth, BenchEvaluator::Classical, network, walkOnly);
+	for (const auto& level : { Engine::SimdLevel::Scalar, Engine::SimdLevel::Sse2, Engine::SimdLevel::Avx2 })
+	{
+		if (!Engine::IsSimdLevelSupported(level)) continue;
+		Engine::TrySetNnueSimdLevel(level);
+		RunEvaluationWalkBench(std::format("Network ({})", Engine::ToString(level)), depth, BenchEvaluator::Network, network, walkOnly);
+	}
+	Engine::TrySetNnueSimdLevel(bestLevel);
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::string command = argc > 1 ? argv[1] : "threads";
+	if (command == "ordering")
+	{
+		RunOrderingBench(argc > 2 ? std::stoi(argv[2]) : DEFAULT_ORDERING_DEPTH);
+		return 0;
+	}
+	if (command == "eval" && argc > 2)
+	{
+		return RunEvaluationBench(argv[2], argc > 3 ? std::stoi(argv[3]) : DEFAULT_EVAL_DEPTH);
+	}
+	if (command != "threads")
+	{
+		std::cout << "Usage:\n  threads [maxThreads] [moveTimeMs]\n  ordering [depth]\n  eval <networkFile> [depth]" << std::endl;
+		return 1;
+	}
+
+	const int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	const int maxThreads = std::clamp(argc > 2 ? std::stoi(argv[2]) : hardwareThreads, 1, Engine::MAX_SEARCH_THREADS);
+	const std::chrono::milliseconds moveTime(argc > 3 ? std::stoi(argv[3]) : DEFAULT_BENCH_MOVE_TIME_MS);
+
+	double singleThreadNodesPerSecond = 0;
+	for (int threads = 1; ; threads = std::min(threads * 2, maxThreads))
+	{
+		const BenchResult result = RunSearchBench(threads, moveTime);
+		const double nodesPerSecond = result.Seconds > 0 ? result.Nodes / result.Seconds : 0;
+		if (threads == 1) singleThreadNodesPerSecond = nodesPerSecond;
+
+		std::cout << std::format("Threads: {} Nodes: {} Time: {:.3f}s NPS: {:.0f} Scaling: {:.2f}x", threads, result.Nodes, 
+			result.Seconds, nodesPerSecond, singleThreadNodesPerSecond > 0 ? nodesPerSecond / singleThreadNodesPerSecond : 0) << std::endl;
+		if (threads == maxThreads) break;
+	}
+	return 0;
+}
@@ -0,0 +1,58 @@
+#include <array>
+#include <string>
+#include "Bitboard.hpp"
+#include "Point2DInt.hpp"
+#include "Globals.hpp"
+
+namespace Board
+{
+	static std::array<Utils::Point2DInt, SQUARE_COUNT> CreateSquarePositions()
+	{
+		std::array<Utils::Point2DInt, SQUARE_COUNT> positions;
+		for (Square square = 0; square < SQUARE_COUNT; square++)
+		{
+			positions[square] = Utils::Point2DInt(BOARD_DIMENSION - 1 - GetRank(square), GetFile(square));
+		}
+		return positions;
+	}
+	static const std::array<Utils::Point2DInt, SQUARE_COUNT> SQUARE_POSITIONS = CreateSquarePositions();
+
+	Square ToSquare(const Utils::Point2DInt& pos)
+	{
+		return ToSquare(pos.x, pos.y);
+	}
+
+	const Utils::Point2DInt& ToPosition(const Square square)
+	{
+		return SQUARE_POSITIONS[square];
+	}
+
+	BitboardSet::BitboardSet()
+	{
+		Clear();
+	}
+
+	void BitboardSet::Clear()
+	{
+		for (auto& colorPieces : Pieces) colorPieces.fill(EMPTY_BITBOARD);
+		ColorOccupancy.fill(EMPTY_BITBOARD);
+		Occupancy = EMPTY_BITBOARD;
+		PieceCodes.fill(NO_PIECE);
+		PiecePointers.fill(nullptr);
+	}
+
+	//Prints the bitboard as it appears on the board (rank 8 at the top)
+	std::string ToStringBitboard(const Bitboard bitboard)
+	{
+		std::string str;
+		for (int row = 0; row < BOARD_DIMENSION; row++)
+		{
+			for (int col = 0; col < BOARD_DIMENSION; col++)
+			{
+				str += (bitboard & ToBitboard(ToSquare(row, col))) ? '1' : '.';
+			}
+			str += '\n';
+		}
+		return str;
+	}
+}
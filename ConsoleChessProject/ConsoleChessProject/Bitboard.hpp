@@ -0,0 +1,137 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string>
+#include "Point2DInt.hpp"
+#include "Piece.hpp"
+#include "Color.hpp"
+#include "Globals.hpp"
+
+namespace Board
+{
+	using Bitboard = std::uint64_t;
+	using Square = int;
+
+	constexpr int SQUARE_COUNT = BOARD_DIMENSION * BOARD_DIMENSION;
+	constexpr int PIECE_TYPE_COUNT = 6;
+	constexpr Square NO_SQUARE = -1;
+	constexpr Bitboard EMPTY_BITBOARD = 0;
+
+	//Color and type packed into one byte (color * PIECE_TYPE_COUNT + type)
+	//so the square lookup table stays small enough to live in a single cache line pair
+	using PieceCode = std::uint8_t;
+	constexpr PieceCode NO_PIECE = TEAMS_COUNT * PIECE_TYPE_COUNT;
+
+	constexpr int ToIndex(const ArmyColor color) { return static_cast<int>(color); }
+	constexpr int ToIndex(const PieceType type) { return static_cast<int>(type); }
+
+	constexpr PieceCode ToPieceCode(const ArmyColor color, const PieceType type)
+	{
+		return static_cast<PieceCode>(ToIndex(color) * PIECE_TYPE_COUNT + ToIndex(type));
+	}
+	constexpr ArmyColor GetColorFromCode(const PieceCode code) { return static_cast<ArmyColor>(code / PIECE_TYPE_COUNT); }
+	constexpr PieceType GetTypeFromCode(const PieceCode code) { return static_cast<PieceType>(code % PIECE_TYPE_COUNT); }
+
+	//NOTE: squares use little endian rank-file order (a1 = 0, h8 = 63) while board positions
+	//are (row, col) with row 0 being the top of the board (dark's back rank), so row 7 is rank 1
+	constexpr Square ToSquare(const int row, const int col) { return (BOARD_DIMENSION - 1 - row) * BOARD_DIMENSION + col; }
+	constexpr int GetRank(const Square square) { return square / BOARD_DIMENSION; }
+	constexpr int GetFile(const Square square) { return square % BOARD_DIMENSION; }
+	constexpr Bitboard ToBitboard(const Square square) { return Bitboard{ 1 } << square; }
+
+	Square ToSquare(const Utils::Point2DInt& pos);
+
+	/// <summary>
+	/// Returns a reference to a static position for the square so callers
+	/// that store position references (like PiecePositionData) stay valid
+	/// </summary>
+	/// <param name="square"></param>
+	/// <returns></returns>
+	const Utils::Point2DInt& ToPosition(const Square square);
+
+	//Castling rights are packed into 4 bits, one per color and side
+	using CastlingRights = std::uint8_t;
+	constexpr CastlingRights NO_CASTLING = 0;
+	constexpr CastlingRights LIGHT_KING_SIDE_CASTLE = 1 << 0;
+	constexpr CastlingRights LIGHT_QUEEN_SIDE_CASTLE = 1 << 1;
+	constexpr CastlingRights DARK_KING_SIDE_CASTLE = 1 << 2;
+	constexpr CastlingRights DARK_QUEEN_SIDE_CASTLE = 1 << 3;
+	constexpr CastlingRights ALL_CASTLING = LIGHT_KING_SIDE_CASTLE | LIGHT_QUEEN_SIDE_CASTLE | 
+											DARK_KING_SIDE_CASTLE | DARK_QUEEN_SIDE_CASTLE;
+
+	inline int PopCount(const Bitboard bitboard) { return std::popcount(bitboard); }
+	inline Square GetLeastSignificantSquare(const Bitboard bitboard) { return std::countr_zero(bitboard); }
+	inline Square PopLeastSignificantSquare(Bitboard& bitboard)
+	{
+		const Square square = std::countr_zero(bitboard);
+		bitboard &= bitboard - 1;
+		return square;
+	}
+
+	/// <summary>
+	/// The main position store for a game state. Holds one bitboard per color and piece type,
+	/// occupancy per color and overall, and a square indexed table of piece codes and pointers
+	/// so piece lookups are a single array read instead of a hash map find
+	/// </summary>
+	struct BitboardSet
+	{
+		std::array<std::array<Bitboard, PIECE_TYPE_COUNT>, TEAMS_COUNT> Pieces;
+		std::array<Bitboard, TEAMS_COUNT> ColorOccupancy;
+		Bitboard Occupancy;
+
+		std::array<PieceCode, SQUARE_COUNT> PieceCodes;
+		std::array<Piece*, SQUARE_COUNT> PiecePointers;
+
+		BitboardSet();
+
+		void Clear();
+
+		inline bool HasPiece(const Square square) const { return PieceCodes[square] != NO_PIECE; }
+		inline Bitboard GetPieces(const ArmyColor color, const PieceType type) const
+		{
+			return Pieces[ToIndex(color)][ToIndex(type)];
+		}
+
+		inline void AddPiece(const Square square, const PieceCode code, Piece* piece)
+		{
+			const Bitboard bit = ToBitboard(square);
+			Pieces[code / PIECE_TYPE_COUNT][code % PIECE_TYPE_COUNT] |= bit;
+			ColorOccupancy[code / PIECE_TYPE_COUNT] |= bit;
+			Occupancy |= bit;
+			PieceCodes[square] = code;
+			PiecePointers[square] = piece;
+		}
+
+		inline Piece* RemovePiece(const Square square)
+		{
+			const PieceCode code = PieceCodes[square];
+			const Bitboard bit = ToBitboard(square);
+			Pieces[code / PIECE_TYPE_COUNT][code % PIECE_TYPE_COUNT] &= ~bit;
+			ColorOccupancy[code / PIECE_TYPE_COUNT] &= ~bit;
+			Occupancy &= ~bit;
+
+			Piece* removed = PiecePointers[square];
+			PieceCodes[square] = NO_PIECE;
+			PiecePointers[square] = nullptr;
+			return removed;
+		}
+
+		//Note: the destination square must be empty (captures remove the captured piece first)
+		inline void MovePiece(const Square from, const Square to)
+		{
+			const PieceCode code = PieceCodes[from];
+			const Bitboard fromTo = ToBitboard(from) | ToBitboard(to);
+			Pieces[code / PIECE_TYPE_COUNT][code % PIECE_TYPE_COUNT] ^= fromTo;
+			ColorOccupancy[code / PIECE_TYPE_COUNT] ^= fromTo;
+			Occupancy ^= fromTo;
+
+			PieceCodes[to] = code;
+			PiecePointers[to] = PiecePointers[from];
+			PieceCodes[from] = NO_PIECE;
+			PiecePointers[from] = nullptr;
+		}
+	};
+
+	std::string ToStringBitboard(const Bitboard bitboard);
+}
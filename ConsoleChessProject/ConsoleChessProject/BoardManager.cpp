@@ -2,6 +2,9 @@
 #include <vector>
 #include <optional>
 #include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <cctype>
 #include "BoardManager.hpp"
 #include "BoardSetup.hpp"
 #include "Point2DInt.hpp"
@@ -12,6 +15,12 @@
 #include "Globals.hpp"
 #include "GameState.hpp"
 #include "PieceMoveResult.hpp"
+#include "Bitboard.hpp"
+#include "Attacks.hpp"
+#include "MoveGeneration.hpp"
+#include "MoveExecution.hpp"
+#include "Zobrist.hpp"
+#include "PieceSquareTables.hpp"
 
 namespace Board
 {
@@ -22,6 +31,9 @@ namespace Board
 	static bool inCheckmate;
 	static bool inCheck;*/
 	static std::vector<Utils::Point2DInt> _allPossiblePositions;
+
+	//Promotions add new pieces so we reserve room for every pawn promoting once
+	static constexpr int MAX_PROMOTED_PIECES = TEAMS_COUNT * BOARD_DIMENSION;
 	//static std::vector<PieceMoveCallbackType> _pieceMoveEvent;
 	//static std::vector<MoveExecutedCallbackType> _successfulMoveEvent;
 
@@ -110,7 +122,7 @@ namespace Board
 	//}
 
 	/// <summary>
-	///  Will get the piece in play at the specified position using .find for map (fast)
+	///  Will get the piece in play at the specified position using the square table of the bitboards (fast)
 	/// Note: state is not modified but needs to be non-const to supply
 	/// correct args to underlying function
 	/// </summary>
@@ -119,25 +131,27 @@ namespace Board
 	/// <returns></returns>
 	static Piece* TryGetPieceAtPositionMutable(GameState& state, const Utils::Point2DInt& pos)
 	{
-		PiecePositionMapType::iterator it = state.InPlayPieces.find(pos);
-		if (it == state.InPlayPieces.end()) return nullptr;
-		else return it->second;
+		if (!IsWithinBounds(pos)) return nullptr;
+		return state.Bitboards.PiecePointers[ToSquare(pos)];
 	}
 
 	const Piece* TryGetPieceAtPosition(const GameState& state, const Utils::Point2DInt& pos)
 	{
-		PiecePositionMapType::const_iterator it = state.InPlayPieces.find(pos);
-		if (it == state.InPlayPieces.end()) return nullptr;
-		else return it->second;
+		if (!IsWithinBounds(pos)) return nullptr;
+		return state.Bitboards.PiecePointers[ToSquare(pos)];
 	}
 
 	std::optional<Utils::Point2DInt> TryGetPositionOfPiece(const GameState& state, const Piece& piece)
 	{
-		for (const auto& piecePos : state.InPlayPieces)
+		//Only squares holding the same color and type can match so we just scan that bitboard
+		Bitboard candidates = state.Bitboards.GetPieces(piece.m_Color, piece.m_PieceType);
+		while (candidates)
 		{
-			if (*piecePos.second == piece)
+			const Square square = PopLeastSignificantSquare(candidates);
+			const Piece* pieceAtSquare = state.Bitboards.PiecePointers[square];
+			if (pieceAtSquare != nullptr && *pieceAtSquare == piece)
 			{
-				return piecePos.first;
+				return ToPosition(square);
 			}
 		}
 		return std::nullopt;
@@ -153,9 +167,11 @@ namespace Board
 		std::string boardRepresentation;
 		std::string currentPieceStr;
 		int row = 0;
-		for (const auto& piecePos : state.InPlayPieces)
+		Bitboard occupied = state.Bitboards.Occupancy;
+		while (occupied)
 		{
-			currentPieceStr = std::format("[{}@ {}] ", piecePos.second->ToString(true), piecePos.first.ToString());
+			const Square square = PopLeastSignificantSquare(occupied);
+			currentPieceStr = std::format("[{}@ {}] ", state.Bitboards.PiecePointers[square]->ToString(true), ToPosition(square).ToString());
 			boardRepresentation += currentPieceStr;
 			row++;
 
@@ -236,17 +252,21 @@ namespace Board
 		const std::optional<std::vector<Piece::State>>& targetState)
 	{
 		std::vector<PiecePositionData> foundPieces;
-		bool checkType = type.has_value();
 		bool checkState = targetState.has_value() && targetState.value().size() > 0;
-		for (const auto& piecePos : state.InPlayPieces)
+
+		//Filtering by color and type is just picking the right bitboard
+		Bitboard candidates = type.has_value() ? state.Bitboards.GetPieces(color, type.value()) : 
+												 state.Bitboards.ColorOccupancy[ToIndex(color)];
+		while (candidates)
 		{
-			if (checkType && piecePos.second->m_PieceType != type.value()) continue;
+			const Square square = PopLeastSignificantSquare(candidates);
+			const Piece* piece = state.Bitboards.PiecePointers[square];
 			if (checkState)
 			{
 				bool pieceStateMatches = false;
 				for (const auto& state : targetState.value())
 				{
-					if (piecePos.second->m_State == state)
+					if (piece->m_State == state)
 					{
 						pieceStateMatches = true;
 						break;
@@ -255,8 +275,8 @@ namespace Board
 				if (!pieceStateMatches) continue;
 			}
 
-			if (piecePos.second->m_Color == color)
-				foundPieces.emplace_back(*piecePos.second, piecePos.first);
+			//Note: the position is a static reference so it stays valid for the data's lifetime
+			foundPieces.emplace_back(*piece, ToPosition(square));
 		}
 		return foundPieces;
 	}
@@ -286,22 +306,6 @@ namespace Board
 		return false;
 	}
 
-	static bool EraseMoveInfoWithData(std::vector<MoveInfo>& allMoveInfo, const std::function<bool(MoveInfo)>& iterationCheck)
-	{
-		int index = 0;
-		for (const auto& moveInfo : allMoveInfo)
-		{
-			if (iterationCheck(moveInfo))
-			{
-				auto startIt = allMoveInfo.begin() + index;
-				allMoveInfo.erase(startIt);
-				return true;
-			}
-			index++;
-		}
-		return false;
-	}
-
 	//Will check if the position is within bounds of the board
 	bool IsWithinBounds(const Utils::Point2DInt& pos)
 	{
@@ -316,6 +320,15 @@ namespace Board
 		tiles.fill(emptyRow);*/
 		state.AllPieces.clear();
 		state.InPlayPieces.clear();
+		state.Bitboards.Clear();
+		state.CastlingRights = NO_CASTLING;
+		state.EnPassantSquare = NO_SQUARE;
+		state.Checkers = EMPTY_BITBOARD;
+		state.StateHistoryCount = 0;
+		state.Hash = 0;
+		state.Evaluation = {};
+		state.InCheck = false;
+		state.InCheckmate = false;
 	}
 
 	static Piece CreatePiece(const ArmyColor& color, const PieceType& pieceType)
@@ -354,223 +367,44 @@ namespace Board
 	//	}
 	//}
 
-	struct CheckOrMateResult
-	{
-		bool IsCheckmate;
-		bool IsCheck;
-	};
-
 	/// <summary>
-	/// Will return a result whether the game state has a piece at posAttemptingCheck
-	/// for a check (attack to king) or checkmate (king can not excape direct attack)
+	/// Updates the checkers, check and checkmate of the state for the player that moves next.
+	/// Check comes straight from the attackers of the king so no moves are generated unless it is a check
 	/// </summary>
 	/// <param name="state"></param>
-	/// <param name="posAttemptingCheck"></param>
-	/// <returns></returns>
-	static CheckOrMateResult IsCheckOrMateByPieceAt(const GameState& state, const Utils::Point2DInt& posAttemptingCheck)
-	{
-		const Piece* pieceAttemptingCheck = TryGetPieceAtPosition(state, posAttemptingCheck);
-
-		//Standard chess rules would prohibit a king check or checkmating another king since a king
-		//would then be in attack range of another king, meaning your king would not be able to move
-		//there since then your king is at risk of check or mate
-		if (pieceAttemptingCheck->m_PieceType == PieceType::King) return { false, false };
-
-		const std::vector<MoveInfo> possibleMoves = GetPossibleMovesForPieceAt(state, posAttemptingCheck);
-
-		const Piece* pieceChecked = nullptr;
-		bool inCheckResult = false;
-		if (pieceAttemptingCheck != nullptr)
-		{
-			for (const auto& possibleMove : possibleMoves)
-			{
-				for (const auto& pieceMove : possibleMove.PiecesMoved)
-				{
-					//If this move is not for this piece we do not consider it
-					if (&pieceMove.PieceRef != pieceAttemptingCheck) continue;
-
-					//If the piece at the end of the path is a king of a different color it is a check
-					pieceChecked = TryGetPieceAtPosition(state, pieceMove.NewPos);
-					if (pieceChecked != nullptr && pieceChecked->m_PieceType == PieceType::King &&
-						pieceChecked->m_Color != pieceAttemptingCheck->m_Color)
-					{
-						inCheckResult = true;
-						break;
-					}
-				}
-			}
-		}
-
-		bool inCheckmateResult = false;
-		if (inCheckResult)
-		{
-			std::vector<PiecePositionData> kingPositions = TryGetPiecesPosition(state, pieceAttemptingCheck->m_Color ==
-				ArmyColor::Dark ? ArmyColor::Light : ArmyColor::Dark, PieceType::King,
-				std::vector<Piece::State>{ Piece::State::InPlay });
-			if (kingPositions.size() != 1)
-			{
-				std::string error = std::format("Tried to check for check and checkmate but no king was found!");
-				Utils::Log(Utils::LogType::Error, error);
-				return { false, false };
-			}
-			const std::vector<MoveInfo> kingMoves = GetPossibleMovesForPieceAt(state, kingPositions[0].Pos);
-			inCheckmateResult = kingMoves.size() == 0;
-		}
-
-		return { inCheckmateResult, inCheckResult };
-	}
-
-	/// <summary>
-	/// Will check if it is a check or checkmate and then update the state. Returns true if it was updated
-	/// </summary>
-	static bool UpdateCheckOrMate(GameState& state, const Utils::Point2DInt& posAttemptingCheck)
+	/// <param name="colorToMove"></param>
+	static void UpdateCheckState(GameState& state, const ArmyColor& colorToMove)
 	{
-		CheckOrMateResult result = IsCheckOrMateByPieceAt(state, posAttemptingCheck);
-		if (result.IsCheck == state.InCheck && result.IsCheckmate == state.InCheckmate) return false;
-
-		state.InCheck = result.IsCheck;
-		state.InCheckmate = result.IsCheckmate;
-		return true;
+		state.Checkers = CalculateCheckers(state.Bitboards, colorToMove);
+		state.InCheck = state.Checkers != EMPTY_BITBOARD;
+		state.InCheckmate = state.InCheck && !HasLegalMove(state, colorToMove);
 	}
 
 	/// <summary>
-	/// Will get all the positions that a check or checkmate can be done from 
-	/// (AKA a piece is there and can check or checkmate the opposing king)
+	/// Moves the piece at the square of the in play map to the other square.
+	/// The map node is moved to its new key instead of being erased and emplaced again so nothing is reallocated
 	/// </summary>
 	/// <param name="state"></param>
-	/// <param name="color"></param>
-	/// <returns></returns>
-	static std::vector<PiecePositionData> GetPiecePositionsForcingCheckOrMate(const GameState& state, const ArmyColor& color)
-	{
-		std::vector<PiecePositionData> checkablePiecePositions;
-		for (const auto& piece : state.InPlayPieces)
-		{
-			if (piece.second->m_Color != color) continue;
-			CheckOrMateResult result = IsCheckOrMateByPieceAt(state, piece.first);
-			if (result.IsCheck || result.IsCheckmate)
-				checkablePiecePositions.emplace_back(*piece.second, piece.first);
-		}
-
-		return checkablePiecePositions;
-	}
-
-	static bool TryUpdatePiecePosition(GameState& state, const PiecePositionData& currentData, const Utils::Point2DInt& newPos)
+	/// <param name="from"></param>
+	/// <param name="to"></param>
+	static void MoveInPlayPiece(GameState& state, const Square from, const Square to)
 	{
-		Utils::Log(std::format("PIECE CHECK BEFORE TRY MOVE {} -> {} found piece: {}", currentData.Pos.ToString(),
-			newPos.ToString(), currentData.PieceRef.ToString()));
-
-		if (!TryGetPieceAtPosition(state, currentData.Pos))
+		auto pieceMovedNode = state.InPlayPieces.extract(ToPosition(from));
+		if (pieceMovedNode.empty())
 		{
-			std::string error = std::format("Tried to update pos of piece: {} from pos: {} "
-				"but it is not located there", currentData.PieceRef.ToString(), currentData.Pos.ToString());
+			std::string error = std::format("Tried to move the in play piece at pos: {} to pos: {} "
+				"but there are no pieces at that position", ToPosition(from).ToString(), ToPosition(to).ToString());
 			Utils::Log(Utils::LogType::Error, error);
-			return false;
+			return;
 		}
 
-		if (!IsWithinBounds(currentData.Pos))
-		{
-			std::string error = std::format("Tried to update pos of piece: {} from pos: {} "
-				"but current pos is not valid", currentData.PieceRef.ToString(), currentData.Pos.ToString());
-			Utils::Log(Utils::LogType::Error, error);
-			return false;
-		}
-
-		if (!IsWithinBounds(newPos))
-		{
-			std::string error = std::format("Tried to update pos of piece: {} from pos: {} "
-				"to pos: {} but new pos is not valid", currentData.PieceRef.ToString(), currentData.Pos.ToString(), newPos.ToString());
-			Utils::Log(Utils::LogType::Error, error);
-			return false;
-		}
-
-		std::function<void()> undoCaptureFunc = nullptr;
-
-		//We then have to first check for the piece at new pos before removing to add to captured
-		Piece* pieceAtNewPos = TryGetPieceAtPositionMutable(state, newPos);
-		if (pieceAtNewPos != nullptr)
-		{
-			if (pieceAtNewPos->m_Color == currentData.PieceRef.m_Color)
-			{
-				std::string error = std::format("Tried to place board piece: {} at pos: {} "
-					"but piece of same team color exists at new pos: {}",
-					currentData.PieceRef.ToString(), newPos.ToString(), currentData.PieceRef.ToString());
-				Utils::Log(Utils::LogType::Error, error);
-				return false;
-			}
-
-			//We make a copy so that we can reuse piece data if we need to undo
-			/*
-			Piece capturedPieceCopy = *pieceAtNewPos;
-			pieceAtNewPos->UpdateState(Piece::State::Captured);
-			state.CapturedPieces.push_back(capturedPieceCopy);
-			state.PiecePositions.erase(newPos);
-
-			undoCaptureFunc = [newPos, &capturedPieceCopy, &state]() -> void
-				{
-					capturedPieceCopy.UpdateState(Piece::State::InPlay);
-					state.CapturedPieces.pop_back(); 
-					state.PiecePositions.emplace(newPos, capturedPieceCopy);
-				};
-			*/
-
-			pieceAtNewPos->UpdateState(Piece::State::Captured);
-			state.CapturedPieces.push_back(pieceAtNewPos);
-			state.InPlayPieces.erase(newPos);
-
-		}
-
-		auto pieceMovedIt = state.InPlayPieces.find(currentData.Pos);
-		bool hasPiece = pieceMovedIt!= state.InPlayPieces.end();
-		//Note: since we delete the old pos and move to new pos, we have to ensure we copy the data
-		//otherwise using the pieceref and ptrs will not work since they are referencing data that will be deleted
-		//(and most likely due to them being made from the collection, will point to a different wrong piece)
-		
-		if (hasPiece)
-		{
-			Piece* movedPiecePtr = pieceMovedIt->second;
-			size_t elementsErased= state.InPlayPieces.erase(currentData.Pos);
-			if (elementsErased == 0)
-			{
-				std::string error = std::format("Tried to move board piece: {} at pos: {}"
-					"but failed to retrieve it and/or remove it from its old position {}",
-					currentData.PieceRef.ToString(), newPos.ToString(), currentData.Pos.ToString());
-				Utils::Log(Utils::LogType::Error, error);
-
-				if (undoCaptureFunc != nullptr) undoCaptureFunc();
-				state.InPlayPieces.emplace(currentData.Pos, movedPiecePtr);
-				return false;
-			}
-
-			state.InPlayPieces.emplace(newPos, movedPiecePtr);
-			//InvokePieceMoveEvent(state);
-		}
-		else
-		{
-			std::string error = std::format("Tried to move board piece: {} at pos: {}"
-				"but there are no pieces at that position: {}",
-				currentData.PieceRef.ToString(), newPos.ToString(), currentData.Pos.ToString());
-			Utils::Log(Utils::LogType::Error, error);
-
-			if (undoCaptureFunc != nullptr) undoCaptureFunc();
-			return false;
-		}
-		PiecePositionMapType oldPos = state.InPlayPieces;
-		std::vector<Piece*> oldCaptured = state.CapturedPieces;
-
-		/*Utils::Log(std::format("PIECE CHECK TRY MOVE {} -> {} found piece: {}", currentData.Pos.ToString(), newPos.ToString(), currentData.PieceRef.ToString()));
-		Utils::Log(std::format("PIECE CHECK Updated piece position of {} from {} -> {}. Old:[pos:{}, captured:{}] New:[pos:{}, captured:{}],",
-			currentData.PieceRef.ToString(), currentData.Pos.ToString(), newPos.ToString(), 
-			Utils::ToStringIterable(oldPos), Utils::ToStringIterable<std::vector<Piece>, Piece>(oldCaptured), 
-			Utils::ToStringIterable(state.PiecePositions), Utils::ToStringIterable<std::vector<Piece>, Piece>(state.CapturedPieces)));*/
-		return true;
+		pieceMovedNode.key() = ToPosition(to);
+		state.InPlayPieces.insert(std::move(pieceMovedNode));
 	}
 
-	static bool TryUpdatePiecePosition(GameState& state, const PiecePositionData currentData, Utils::Point2DInt newPos, MoveInfo moveInfo)
+	static void AddPreviousMove(GameState& state, const ArmyColor color, const MoveInfo& moveInfo)
 	{
-		if (!TryUpdatePiecePosition(state, currentData, newPos)) return false;
-
 		//Utils::Log(std::format("POOPY DOPZY Adding previous moves with move info: {}", moveInfo.ToString()));
-		ArmyColor color = currentData.PieceRef.m_Color;
 		if (state.PreviousMoves.find(color) == state.PreviousMoves.end())
 		{
 			state.PreviousMoves.emplace(color, std::vector<MoveInfo>{moveInfo });
@@ -583,7 +417,6 @@ namespace Board
 			Utils::Log(std::format("CALC MOVE INFO: ADDING MOVE INFO {} all prev moves: {}",
 				moveInfo.ToString(), Utils::ToStringIterable<std::vector<MoveInfo>, MoveInfo>(state.PreviousMoves.at(color))));
 		}
-		return true;
 	}
 
 	static bool TryCreatePieceAtPos(GameState& state, const ArmyColor& color,
@@ -609,6 +442,7 @@ namespace Board
 		state.AllPieces.push_back(CreatePiece(color, pieceType));
 		Piece* piecePtr = &(state.AllPieces.at(state.AllPieces.size() - 1));
 		state.InPlayPieces.emplace(pos, piecePtr);
+		state.Bitboards.AddPiece(ToSquare(pos), ToPieceCode(color, pieceType), piecePtr);
 		return true;
 
 		/*Piece* pieceCreated = &(state.AllPieces.at(state.AllPieces.size() - 1));
@@ -627,6 +461,77 @@ namespace Board
 		//return std::nullopt;
 	}
 
+	/// <summary>
+	/// Plays the generated move on the state with MakeMove (which keeps the bitboards, hash and evaluation up to date
+	/// and passes the turn) and then updates the in play pieces to match, including the rook of a castle, the pawn taken 
+	/// en passant and the new piece of a promotion. The positions whose pieces changed are added to changedPositions
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="move"></param>
+	/// <param name="changedPositions"></param>
+	/// <returns></returns>
+	static bool TryExecuteMove(GameState& state, const Move& move, std::vector<Utils::Point2DInt>& changedPositions)
+	{
+		//A long game drops its oldest move from the undo stack instead of filling it, so that move can no longer be undone.
+		//Searches copy only the latest part of the stack (with room for their own plies) so they are not affected
+		if (state.StateHistoryCount == MAX_STATE_HISTORY)
+		{
+			std::shift_left(state.StateHistory.begin(), state.StateHistory.end(), 1);
+			state.StateHistoryCount--;
+		}
+
+		const Square from = move.GetFrom();
+		const Square to = move.GetTo();
+		Piece* movedPiece = state.Bitboards.PiecePointers[from];
+
+		//All pieces can not reallocate since pointers to its pieces are stored on the board
+		if (move.IsPromotion() && state.AllPieces.size() >= state.AllPieces.capacity())
+		{
+			std::string error = std::format("Tried to promote piece: {} at pos: {} to {} "
+				"but there is no reserved space left for new pieces", movedPiece->ToString(), 
+				ToPosition(from).ToString(), ToString(move.GetPromotionType()));
+			Utils::Log(Utils::LogType::Error, error);
+			return false;
+		}
+
+		if (!MakeMove(state, move)) return false;
+		changedPositions.push_back(ToPosition(to));
+
+		const StateInfo& info = state.StateHistory[state.StateHistoryCount - 1];
+		if (info.CapturedPiece != nullptr)
+		{
+			const Square capturedSquare = move.GetFlag() != MoveFlag::EnPassant ? to : 
+				movedPiece->m_Color == ArmyColor::Light ? to - BOARD_DIMENSION : to + BOARD_DIMENSION;
+			info.CapturedPiece->UpdateState(Piece::State::Captured);
+			state.CapturedPieces.push_back(info.CapturedPiece);
+			state.InPlayPieces.erase(ToPosition(capturedSquare));
+			if (capturedSquare != to) changedPositions.push_back(ToPosition(capturedSquare));
+		}
+		MoveInPlayPiece(state, from, to);
+
+		if (move.IsCastle())
+		{
+			const Square rookFrom = move.GetFlag() == MoveFlag::KingSideCastle ? to + 1 : to - 2;
+			const Square rookTo = move.GetFlag() == MoveFlag::KingSideCastle ? to - 1 : to + 1;
+			MoveInPlayPiece(state, rookFrom, rookTo);
+
+			changedPositions.push_back(ToPosition(rookFrom));
+			changedPositions.push_back(ToPosition(rookTo));
+		}
+		else if (move.IsPromotion())
+		{
+			//The pawn leaves play without being captured and the game gets its own piece in place of 
+			//the shared promotion piece the move put on the board
+			movedPiece->UpdateState(Piece::State::Undefined);
+			state.AllPieces.push_back(CreatePiece(movedPiece->m_Color, move.GetPromotionType()));
+			Piece* promotedPiece = &state.AllPieces.back();
+			promotedPiece->UpdateState(Piece::State::InPlay);
+			state.InPlayPieces.at(ToPosition(to)) = promotedPiece;
+			state.Bitboards.PiecePointers[to] = promotedPiece;
+		}
+		return true;
+	}
+
 	//Will place all pieces from default board positions. If the peice exists it will be moved
 	//otherwise it will be created and moved
 	//NOTE: this func assumes that it is in a default state where pieces are added without considering
@@ -767,8 +672,12 @@ namespace Board
 		//We do not want to cause problems with reallocations and pointers that could be invalidated
 		//if the vector is moved elsewhere, so we must reserve the size (but the elements will be empty
 		// and will not be default initialized, so we still need to push)
-		state.AllPieces.reserve(TEAMS_COUNT*COLOR_PIECES_COUNT);
+		state.AllPieces.reserve(TEAMS_COUNT*COLOR_PIECES_COUNT + MAX_PROMOTED_PIECES);
 		PlaceDefaultBoardPieces(state);
+		state.CastlingRights = CalculateCastlingRights(state.Bitboards);
+		UpdateCheckState(state, state.CurrentPlayer);
+		state.Hash = CalculateHash(state);
+		state.Evaluation = CalculateEvaluationScore(state.Bitboards);
 
 		std::unordered_map<Utils::Point2DInt, Piece> stuff;
 		for (const auto& thing : state.InPlayPieces)
@@ -780,88 +689,112 @@ namespace Board
 		Utils::Log(std::format("CALC: After place state pieces: {}", Utils::ToStringIterable(stuff)));
 	}
 
-	struct CastleInfo
+	static std::optional<PieceType> TryGetPieceTypeFromFenChar(const char fenChar)
 	{
-		const bool canCastle;
-		const bool isKingSide;
-		const bool isQueenSide;
-
-		const Utils::Point2DInt kingSideCastleMove;
-		const Utils::Point2DInt queenSideCastleMove;
-	};
+		switch (std::tolower(static_cast<unsigned char>(fenChar)))
+		{
+		case 'p':
+			return PieceType::Pawn;
+		case 'n':
+			return PieceType::Knight;
+		case 'b':
+			return PieceType::Bishop;
+		case 'r':
+			return PieceType::Rook;
+		case 'q':
+			return PieceType::Queen;
+		case 'k':
+			return PieceType::King;
+		default:
+			return std::nullopt;
+		}
+	}
 
-	/// <summary>
-	/// Castleing occurs when the king and rook have not moved yet during the game
-	/// the king is not in check, and there are no pieces between rook and king
-	/// </summary>
-	/// <param name="state"></param>
-	/// <param name="color"></param>
-	/// <returns></returns>
-	static CastleInfo CanCastle(const GameState& state, const ArmyColor& color)
+	bool TryLoadFen(GameState& state, const std::string& fen)
 	{
-		if (state.InCheck || state.InCheckmate) return { false, false, false };
-
-		//Note: we dont want to check rook because it would check any rook moved and 
-		//we might still be able to castle on one side and not on the other
-		if (HasMovedPiece(state, color, PieceType::King)) return { false, false, false };
-		/*const std::vector<PiecePositionData> rooks = TryGetPiecesPosition(state, color, PieceType::Rook,
-			std::vector<Piece::State>{ Piece::State::InPlay });*/
-
-		//TODO: optimize these calls so they are batched together to find pos for both rook and king at the same time
-		const std::vector<PiecePositionData> kingPositions = TryGetPiecesPosition(state, color, PieceType::King,
-			std::vector<Piece::State>{ Piece::State::InPlay });
-		if (kingPositions.empty()) return { false, false, false };
-		Utils::Point2DInt kingPos = kingPositions[0].Pos;
-
-		const std::vector<PiecePositionData> rookPositions = TryGetPiecesPosition(state, color, PieceType::Rook,
-			std::vector < Piece::State> { Piece::State::InPlay });
-		if (rookPositions.empty()) return { false, false, false };
-
-		bool canKingSide = false;
-		bool canQueenSide = false;
-		bool checkingKingSide = false;
-		int spacesMissing = 0;
-		Utils::Point2DInt currentPosCheck;
-		for (const auto& rookPos : rookPositions)
+		ResetBoard(state);
+		state.AllPieces.reserve(SQUARE_COUNT + MAX_PROMOTED_PIECES);
+
+		std::istringstream fenStream(fen);
+		std::string placement, sideToMove, castling, enPassant;
+		fenStream >> placement >> sideToMove >> castling >> enPassant;
+		if (placement.empty() || sideToMove.empty())
 		{
-			if (rookPos.Pos.x != kingPos.x) continue;
+			Utils::Log(Utils::LogType::Error, std::format("Tried to load fen: {} but it is missing "
+				"the placement or side to move", fen));
+			return false;
+		}
 
-			spacesMissing = 0;
-			currentPosCheck = kingPos;
-			checkingKingSide = rookPos.Pos.y > currentPosCheck.y ? true : false;
-			while ((checkingKingSide && currentPosCheck.y >= rookPos.Pos.y) || 
-					(!checkingKingSide && currentPosCheck.y <=rookPos.Pos.y))
+		//Placement starts at rank 8 which is row 0 of the board positions
+		int row = 0;
+		int col = 0;
+		for (const char fenChar : placement)
+		{
+			if (fenChar == '/')
 			{
-				//King side goes up the cols queen side goes down
-				if (checkingKingSide) currentPosCheck = { currentPosCheck.x, currentPosCheck.y + 1 };
-				else currentPosCheck = { currentPosCheck.x, currentPosCheck.y - 1 };
-
-				//Since we do the decrement/incremenet above, it can check to rook pos after loop condition
-				if ((checkingKingSide && currentPosCheck.y >= rookPos.Pos.y) ||
-					(!checkingKingSide && currentPosCheck.y <= rookPos.Pos.y)) break;
-
-				if (TryGetPieceAtPosition(state, currentPosCheck)==nullptr)
-				{
-					spacesMissing++;
-				}
-				//If there is a piece here we can just exit early
-				else break;
+				row++;
+				col = 0;
+				continue;
+			}
+			if (fenChar >= '1' && fenChar <= '8')
+			{
+				col += fenChar - '0';
+				continue;
 			}
 
-			//If the spaces between rook and king are all empty it means we can castle
-			if (spacesMissing == std::abs(rookPos.Pos.y - kingPos.y) - 1)
+			const std::optional<PieceType> maybeType = TryGetPieceTypeFromFenChar(fenChar);
+			const ArmyColor color = std::isupper(static_cast<unsigned char>(fenChar)) ? ArmyColor::Light : ArmyColor::Dark;
+			if (!maybeType.has_value() || !TryCreatePieceAtPos(state, color, maybeType.value(), { row, col }))
 			{
-				if (checkingKingSide) canKingSide = true;
-				else canQueenSide = true;
+				Utils::Log(Utils::LogType::Error, std::format("Tried to load fen: {} but failed to place "
+					"piece: {} at pos: {}", fen, std::string(1, fenChar), Utils::Point2DInt(row, col).ToString()));
+				ResetBoard(state);
+				return false;
 			}
+			state.AllPieces.back().UpdateState(Piece::State::InPlay);
+			col++;
 		}
 
-		Utils::Point2DInt kingSideCastleMove = canKingSide ? Utils::Point2DInt{ kingPos.x, kingPos.y + 2 } : Utils::Point2DInt{};
-		Utils::Point2DInt queenSideCastleMove = canQueenSide ? Utils::Point2DInt{ kingPos.x, kingPos.y - 2 } : Utils::Point2DInt{};
-		Utils::Log(std::format("King side move: {} queen side: {} kingPos: {}", 
-			kingSideCastleMove.ToString(), queenSideCastleMove.ToString(), kingPos.ToString()));
-		return { canKingSide || canQueenSide, canKingSide, canQueenSide, kingSideCastleMove, queenSideCastleMove };
+		if (sideToMove != "w" && sideToMove != "b")
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to load fen: {} but side to move: {} "
+				"is not w or b", fen, sideToMove));
+			ResetBoard(state);
+			return false;
+		}
+		state.CurrentPlayer = sideToMove == "w" ? ArmyColor::Light : ArmyColor::Dark;
+
+		for (const char castlingChar : castling)
+		{
+			if (castlingChar == 'K') state.CastlingRights |= LIGHT_KING_SIDE_CASTLE;
+			else if (castlingChar == 'Q') state.CastlingRights |= LIGHT_QUEEN_SIDE_CASTLE;
+			else if (castlingChar == 'k') state.CastlingRights |= DARK_KING_SIDE_CASTLE;
+			else if (castlingChar == 'q') state.CastlingRights |= DARK_QUEEN_SIDE_CASTLE;
+		}
+		//Rights for pieces that are not on their start squares are dropped so the generator can trust them
+		state.CastlingRights &= CalculateCastlingRights(state.Bitboards);
+
+		if (enPassant.size() == 2 && enPassant[0] >= 'a' && enPassant[0] <= 'h' && enPassant[1] >= '1' && enPassant[1] <= '8')
+		{
+			state.EnPassantSquare = (enPassant[1] - '1') * BOARD_DIMENSION + (enPassant[0] - 'a');
+		}
+
+		UpdateCheckState(state, state.CurrentPlayer);
+		state.Hash = CalculateHash(state);
+		state.Evaluation = CalculateEvaluationScore(state.Bitboards);
+		return true;
 	}
+
+	struct CastleInfo
+	{
+		const bool canCastle;
+		const bool isKingSide;
+		const bool isQueenSide;
+
+		const Utils::Point2DInt kingSideCastleMove;
+		const Utils::Point2DInt queenSideCastleMove;
+	};
+
 	static CastleInfo IsCastleMove(const GameState& state, const PiecePositionData currentData, const Utils::Point2DInt& newPos)
 	{
 		if (currentData.PieceRef.m_PieceType != PieceType::King) return { false, false, false };
@@ -921,186 +854,16 @@ namespace Board
 			return {};
 		}
 
-		std::vector<MoveInfo> possibleMoves;
-		const auto isDuplicatePos = [&possibleMoves](const Utils::Point2DInt& pos) -> bool
-			{
-				for (const auto& moves : possibleMoves)
-				{
-					for (const auto& movePos : moves.PiecesMoved)
-					{
-						if (movePos.NewPos == pos) return true;
-					}
-				}
-				return false;
-			};
+		//The generator only emits legal moves (including castling, en passant and promotions)
+		//so the compact moves just need to be expanded for the caller
+		MoveList moves;
+		GenerateLegalMovesForPieceAt(state, ToSquare(startPos), moves);
 
-		Utils::Point2DInt moveNewPos;
-		
-		Utils::Log(std::format("MOVE {} DIRS: {}", std::to_string(GetMoveDirsForPiece(movedPiece->m_Color, movedPiece->m_PieceType).size()),
-			Utils::ToStringIterable<std::vector<Utils::Vector2D>, Utils::Vector2D>(GetMoveDirsForPiece(movedPiece->m_Color, movedPiece->m_PieceType))));
-
-		const std::vector<Utils::Vector2D> moveDirs = GetMoveDirsForPiece(movedPiece->m_Color, movedPiece->m_PieceType);
-		const Piece* pieceAtNewPos = nullptr;
-		for (auto& movePos : moveDirs)
-		{
-			moveNewPos = GetVectorEndPoint(startPos, movePos);
-			pieceAtNewPos = TryGetPieceAtPosition(state, moveNewPos);
-
-			
-			//TODO: this is an issue with this if a piece can move any amount in a direction since they then might be able to 
-			//go though pieces of different opposing color
-			bool isNoPieceOrOpposingPieceAtNewPos = pieceAtNewPos == nullptr || pieceAtNewPos->m_Color != movedPiece->m_Color;
-			bool canMoveOverOthers = CanPieceMoveOverPieces(movedPiece->m_PieceType);
-			bool moveOverPiecesFollowsRules = canMoveOverOthers || 
-											 (!canMoveOverOthers && !HasPieceWithinPositionRange(state, startPos, moveNewPos, false));
-
-			Utils::Log(std::format("Is {} (start: {} new pos: {}) within bounds in bounds: {} piece in range: {} "
-				"dupliate: {} new pos rules: {} move over rules: {}",
-				startPos.ToString(), movePos.ToString(Utils::Vector2D::VectorForm::Component), moveNewPos.ToString(),
-				std::to_string(IsWithinBounds(moveNewPos)),
-				std::to_string(HasPieceWithinPositionRange(state, startPos, moveNewPos, false)),
-				std::to_string(isDuplicatePos(moveNewPos)),
-				std::to_string(isNoPieceOrOpposingPieceAtNewPos), std::to_string(moveOverPiecesFollowsRules)));
-
-
-			if (IsWithinBounds(moveNewPos) && !isDuplicatePos(moveNewPos) && 
-				isNoPieceOrOpposingPieceAtNewPos && moveOverPiecesFollowsRules)
-			{
-				//We have to check if it is a capture because capture moves might not be different
-				//from move dirs so we might capture during regualar moves
-				//and we can save some time by first making sure if there actually is a piece at the new pos
-				SpecialMove specialMove = SpecialMove::None;
-				const Piece* capturePiece = nullptr;
-				if (pieceAtNewPos != nullptr)
-				{
-					//capturePiece = TryGetCapturePiece(state, PiecePositionData{ *movedPiece, startPos }, moveNewPos);
-					capturePiece = TryGetPieceAtPosition(state, moveNewPos);
-					specialMove= (capturePiece != nullptr) ? SpecialMove::Capture : SpecialMove::None;
-					/*if (capturePiece != nullptr) capturedPieceValue = capturePiece;*/
-				}
-
-				Utils::Log(Utils::LogType::Error, std::format("ADDING move for piece {} {} -> {} has capture: {}", 
-					movedPiece->ToString(), startPos.ToString(), moveNewPos.ToString(), capturePiece!=nullptr? capturePiece->ToString() : "NUL"));
-				possibleMoves.emplace_back(
-					std::vector<MovePiecePositionData>
-				{
-					MovePiecePositionData(*movedPiece, startPos, moveNewPos)
-				},
-					"",
-					specialMove,
-					nullptr,
-					capturePiece,
-					false,
-					false
-					);
-
-				/*Utils::Log(std::format("RETURNING MOVES:{}",
-					Utils::ToStringIterable<std::vector<MoveInfo>, MoveInfo>(possibleMoves)));*/
-			}
-		}
-		
-		const std::vector<Utils::Vector2D> captureMoves = GetCaptureMovesForPiece(movedPiece->m_Color, movedPiece->m_PieceType);
-		Utils::Log(Utils::LogType::Error, std::format("POSSIBLE {} {} CAPTURES: {}",
-			ToString(movedPiece->m_PieceType), std::to_string(possibleMoves.size()), 
-			Utils::ToStringIterable<std::vector<Utils::Vector2D>, Utils::Vector2D>(captureMoves)));
-
-		//Since capture moves return the same as move dirs if there are no special capture dirs
-		//there is no point repeating those moves if we already checking them for moving (and also check for capturing)
-		if (captureMoves != moveDirs)
-		{
-			for (auto& captureMove : captureMoves)
-			{
-				moveNewPos = GetVectorEndPoint(startPos, captureMove);
-				pieceAtNewPos = TryGetPieceAtPosition(state, moveNewPos);
-
-				bool isOpposingPieceAtNewPos = pieceAtNewPos != nullptr && pieceAtNewPos->m_Color != movedPiece->m_Color;
-				if (IsWithinBounds(moveNewPos) && isOpposingPieceAtNewPos &&
-					!isDuplicatePos(moveNewPos) && !HasPieceWithinPositionRange(state, startPos, moveNewPos, false))
-				{
-					possibleMoves.emplace_back(
-						std::vector<MovePiecePositionData>
-					{
-						MovePiecePositionData(*movedPiece, startPos, moveNewPos)
-					},
-						"",
-						SpecialMove::Capture,
-						nullptr,
-						pieceAtNewPos,
-						false,
-						false
-						);
-				}
-			}
-		}
-
-		CastleInfo castleInfo = CanCastle(state, movedPiece->m_Color);
-		Utils::Log(std::format("Checking {} castle: {} [k:{} move: {}] [q:{} move:{}]", ToString(movedPiece->m_Color),
-			std::to_string(castleInfo.canCastle),
-			std::to_string(castleInfo.isKingSide), castleInfo.kingSideCastleMove.ToString(),
-			std::to_string(castleInfo.isQueenSide), castleInfo.queenSideCastleMove.ToString()));
-
-		if (movedPiece->m_PieceType == PieceType::King && castleInfo.canCastle)
-		{
-			if (castleInfo.isKingSide && !isDuplicatePos(castleInfo.kingSideCastleMove))
-			{
-				possibleMoves.emplace_back(
-					std::vector<MovePiecePositionData>
-				{
-					MovePiecePositionData(*movedPiece, startPos, castleInfo.kingSideCastleMove)
-				},
-					"",
-					SpecialMove::KingSideCastle,
-					nullptr,
-					nullptr,
-					false,
-					false
-				);
-			}
-			else if (castleInfo.isQueenSide && !isDuplicatePos(castleInfo.queenSideCastleMove))
-			{
-				possibleMoves.emplace_back(
-					std::vector<MovePiecePositionData>
-				{
-					MovePiecePositionData(*movedPiece, startPos, castleInfo.queenSideCastleMove)
-				},
-					"",
-					SpecialMove::QueenSideCastle,
-					nullptr,
-					nullptr,
-					false,
-					false
-				);
-			}
-			else
-			{
-				std::string error = std::format("Tried to get moves for piece {} at pos: {} "
-					"and was checking for castleing, which resulted in TRUE, but found no side to castle!",
-					movedPiece->ToString(), startPos.ToString());
-					Utils::Log(Utils::LogType::Error, error);
-					return {};
-			}
-		}
-
-		if (movedPiece->m_PieceType == PieceType::King)
+		std::vector<MoveInfo> possibleMoves;
+		possibleMoves.reserve(moves.Size());
+		for (const auto& move : moves)
 		{
-			//Kings also get checked for any positions that are able to be checked
-			//and those positions are illegal and are removed
-			std::vector<PiecePositionData> checkPositions = GetPiecePositionsForcingCheckOrMate(state, movedPiece->m_Color);
-			if (checkPositions.size() != 0)
-			{
-				for (const auto& checkPos : checkPositions)
-				{
-					EraseMoveInfoWithData(possibleMoves, [&checkPos, movedPiece](MoveInfo info) -> bool
-						{
-							for (const auto& move : info.PiecesMoved)
-							{
-								if (&move.PieceRef != movedPiece) continue;
-								if (move.NewPos == checkPos.Pos) return true;
-							}
-							return false;
-						});
-				}
-			}
+			possibleMoves.push_back(ToMoveInfo(state, move));
 		}
 		
 		Utils::Log(std::format("When getting all possible moves for piece: {} found: {}", movedPiece->ToString(),
@@ -1110,7 +873,8 @@ namespace Board
 
 	//Will check if it is possible to move to that point using a variety of bounds checks,
 	//valid moves, and special move checks
-	PieceMoveResult TryMove(GameState& state, const Utils::Point2DInt& currentPos, const Utils::Point2DInt& newPos)
+	PieceMoveResult TryMove(GameState& state, const Utils::Point2DInt& currentPos, const Utils::Point2DInt& newPos,
+		const PieceType promotionType)
 	{
 		if (!IsWithinBounds(currentPos))
 			return { newPos, false, std::format("Tried to move from a place outside the board") };
@@ -1122,31 +886,88 @@ namespace Board
 		if (!IsWithinBounds(newPos))
 			return { newPos, false, std::format("Tried to move to a place outside the board") };
 
-		const std::vector<MoveInfo> possibleMoves = GetPossibleMovesForPieceAt(state, currentPos);
-		if (possibleMoves.empty())
+		//The move is played for the current player so pieces of the other player can not move
+		if (movedPiece->m_Color != state.CurrentPlayer)
+			return { newPos, false, std::format("It is not {}'s turn", ToString(movedPiece->m_Color)) };
+
+		MoveList possibleMoves;
+		GenerateLegalMovesForPieceAt(state, ToSquare(currentPos), possibleMoves);
+		if (possibleMoves.IsEmpty())
 			return { newPos, false, std::format("There are no possible moves for this piece") };
 
-		for (const auto& moveInfo : possibleMoves)
+		const Square newSquare = ToSquare(newPos);
+		for (const auto& move : possibleMoves)
 		{
-			for (const auto& move : moveInfo.PiecesMoved)
-			{
-				//If the piece moved for this move is not the one we want we skip
-				if (&move.PieceRef != movedPiece) continue;
-
-				if (move.NewPos == newPos)
-				{
-					//Utils::Log(std::format("Trying to update piece position to {} with mvoe info: {}", move.NewPos.ToString(), moveInfo.ToString()));
-					TryUpdatePiecePosition(state, PiecePositionData{ *movedPiece, currentPos }, newPos, moveInfo);
-					/*Utils::Log(std::format("MOVE INFO: after update peice {} all prev moves: {}",
-						moveInfo.ToString(), Utils::ToStringIterable<std::vector<MoveInfo>, MoveInfo>(state.PreviousMoves.at(movedPiece->m_Color))));*/
-					//InvokeSuccessfulMoveEvent(state);
-					return { newPos, true };
-				}
-			}
+			//Only the start and end positions are given so the promotion type picks between the promotions
+			if (move.GetTo() != newSquare) continue;
+			if (move.IsPromotion() && move.GetPromotionType() != promotionType) continue;
+
+			//The move info references the pieces as they are before the move so it is created first
+			const MoveInfo moveInfo = ToMoveInfo(state, move);
+			std::vector<Utils::Point2DInt> changedPositions;
+			if (!TryExecuteMove(state, move, changedPositions))
+				return { newPos, false, std::format("Failed to update the board for the move") };
+
+			AddPreviousMove(state, movedPiece->m_Color, moveInfo);
+			UpdateCheckState(state, state.CurrentPlayer);
+			//InvokeSuccessfulMoveEvent(state);
+			return { changedPositions, true };
 		}
 		return { newPos, false, std::format("New pos does not match any pos for this piece") };
 	}
 
+	PieceMoveResult TryUndoMove(GameState& state)
+	{
+		if (state.StateHistoryCount == 0)
+			return { INVALID_MOVE, false, std::format("There are no moves to undo") };
+
+		//What the move changed is read before it is unmade since the pieces are no longer where the move left them after
+		const StateInfo info = state.StateHistory[state.StateHistoryCount - 1];
+		const Move move = info.MovePlayed;
+		const Square from = move.GetFrom();
+		const Square to = move.GetTo();
+		Piece* pieceAtTo = state.Bitboards.PiecePointers[to];
+		if (!UnmakeMove(state))
+			return { INVALID_MOVE, false, std::format("Failed to undo the move on the board") };
+
+		std::vector<Utils::Point2DInt> changedPositions = { ToPosition(from), ToPosition(to) };
+		MoveInPlayPiece(state, to, from);
+
+		if (move.IsCastle())
+		{
+			const Square rookFrom = move.GetFlag() == MoveFlag::KingSideCastle ? to + 1 : to - 2;
+			const Square rookTo = move.GetFlag() == MoveFlag::KingSideCastle ? to - 1 : to + 1;
+			MoveInPlayPiece(state, rookTo, rookFrom);
+
+			changedPositions.push_back(ToPosition(rookFrom));
+			changedPositions.push_back(ToPosition(rookTo));
+		}
+		else if (move.IsPromotion())
+		{
+			//Moves are undone in the reverse order they were played so the promoted piece is the last piece created
+			pieceAtTo->UpdateState(Piece::State::Undefined);
+			if (!state.AllPieces.empty() && &state.AllPieces.back() == pieceAtTo) state.AllPieces.pop_back();
+			info.PromotedPawn->UpdateState(Piece::State::InPlay);
+			state.InPlayPieces.at(ToPosition(from)) = info.PromotedPawn;
+		}
+
+		if (info.CapturedPiece != nullptr)
+		{
+			const Square capturedSquare = move.GetFlag() != MoveFlag::EnPassant ? to :
+				state.CurrentPlayer == ArmyColor::Light ? to - BOARD_DIMENSION : to + BOARD_DIMENSION;
+			info.CapturedPiece->UpdateState(Piece::State::InPlay);
+			auto capturedIt = std::find(state.CapturedPieces.rbegin(), state.CapturedPieces.rend(), info.CapturedPiece);
+			if (capturedIt != state.CapturedPieces.rend()) state.CapturedPieces.erase(std::next(capturedIt).base());
+			state.InPlayPieces.emplace(ToPosition(capturedSquare), info.CapturedPiece);
+			if (capturedSquare != to) changedPositions.push_back(ToPosition(capturedSquare));
+		}
+
+		auto previousMovesIt = state.PreviousMoves.find(state.CurrentPlayer);
+		if (previousMovesIt != state.PreviousMoves.end() && !previousMovesIt->second.empty()) previousMovesIt->second.pop_back();
+		UpdateCheckState(state, state.CurrentPlayer);
+		return { changedPositions, true };
+	}
+
 	std::string CleanInput(const std::string& input)
 	{
 		std::string cleaned = Utils::StringUtil(input).Trim().RemoveChar(' ').ToString();
@@ -105,6 +105,19 @@ namespace Board
 
 	void ResetBoard(const GameState& state);
 	void CreateDefaultBoard(GameState& state);
+
+	//The standard starting position in Forsyth-Edwards Notation
+	const std::string START_POSITION_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+	/// <summary>
+	/// Resets the board and sets up the position described by the FEN (placement, side to move,
+	/// castling rights and en passant square). The move counters are optional and ignored.
+	/// Returns false and logs the error if the FEN is malformed (the board is left reset)
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="fen"></param>
+	/// <returns></returns>
+	bool TryLoadFen(GameState& state, const std::string& fen);
 	const Piece* TryGetPieceAtPosition(const GameState& state, const Utils::Point2DInt& pos);
 	std::optional<Utils::Point2DInt> TryGetPositionOfPiece(const GameState& state, const Piece& piece);
 
@@ -121,7 +134,18 @@ namespace Board
 	bool HasMovedPiece(const GameState& state, const ArmyColor& color, const PieceType& type);
 
 	std::vector<MoveInfo> GetPossibleMovesForPieceAt(const GameState& state, const Utils::Point2DInt& pos);
-	PieceMoveResult TryMove(GameState& state, const Utils::Point2DInt& currentPos, const Utils::Point2DInt& moveToPos);
+	//Note: pawns reaching the last rank promote to the promotion type (a queen unless a caller like the engine picks one).
+	//Only the current player's pieces move and the move passes the turn to the other player (see MakeMove)
+	PieceMoveResult TryMove(GameState& state, const Utils::Point2DInt& currentPos, const Utils::Point2DInt& moveToPos,
+		const PieceType promotionType = PieceType::Queen);
+	/// <summary>
+	/// Takes back the last move played with TryMove (with UnmakeMove), putting back the pieces it captured or replaced
+	/// and giving the turn back to the player that made it. The positions whose pieces changed are the attempted positions of the result.
+	/// Only the last MAX_STATE_HISTORY moves of a game can be taken back
+	/// </summary>
+	/// <param name="state"></param>
+	/// <returns></returns>
+	PieceMoveResult TryUndoMove(GameState& state);
 
 	std::string CleanInput(const std::string& input);
 
@@ -13,11 +13,14 @@
 #include "Cell.hpp"
 #include "PieceMoveResult.hpp"
 #include "ThemeControllerUI.hpp"
+#include "Search.hpp"
+#include "Bitboard.hpp"
 
 static std::unordered_map<Utils::Point2DInt, Cell*> cells;
 static Cell* lastSelected;
 static std::vector<Cell*> previousMoveCells;
 static std::vector<Cell*> currentCellMoves;
+static std::vector<Cell*> candidateMoveCells;
 //static const std::unordered_map<ArmyColor, CellColors> cellColorData =
 //{
 //	{ArmyColor::Light, CellColors{LIGHT_CELL_COLOR, LIGHT_CELL_HOVER_COLOR, LIGHT_CELL_SELECTED_COLOR, 
@@ -149,6 +152,34 @@ void UpdateInteractablePieces(const ArmyColor& interactableColor)
 	}
 }
 
+void DisableAllPieces()
+{
+	for (const auto& cell : cells)
+	{
+		if (cell.second->HasPiece()) cell.second->SetState(CellState::Disabled, true);
+	}
+}
+
+void ShowCandidateMoves(const std::vector<Engine::SearchResult>& lines)
+{
+	ClearCandidateMoves();
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		Cell* cell = TryGetCellAtPosition(Board::ToPosition(lines[i].BestMove.GetTo()));
+		//Lines ending on the same square (like promotions) keep the note of the better one
+		if (cell == nullptr || cell->HasAnnotation()) continue;
+
+		cell->SetAnnotation(std::format("{} {}", i + 1, Engine::ToScoreString(lines[i].Score)));
+		candidateMoveCells.push_back(cell);
+	}
+}
+
+void ClearCandidateMoves()
+{
+	for (const auto& cell : candidateMoveCells) cell->ClearAnnotation();
+	candidateMoveCells.clear();
+}
+
 bool IsDarkCell(const Utils::Point2DInt& pos)
 {
 	return (pos.x % 2 == 0 && pos.y % 2 == 0) || (pos.x % 2 == 1 && pos.y % 2 == 1);
@@ -277,7 +308,10 @@ void BindCellEventsForGameState(Core::GameManager& manager, const std::string& g
 						continue;
 					}
 
-					if (!TryRenderUpdateCells(manager, *maybeGameState, std::vector<Utils::Point2DInt>{ startPos.value(), endPos.value() }))
+					//Castling and en passant also change cells other than the start and end which are in the attempted positions
+					std::vector<Utils::Point2DInt> changedPositions = { startPos.value() };
+					changedPositions.insert(changedPositions.end(), result.AttemptedPositions.begin(), result.AttemptedPositions.end());
+					if (!TryRenderUpdateCells(manager, *maybeGameState, changedPositions))
 					{
 						const std::string error = std::format("Tried update the rendering for cells "
 							"{} -> {} but failed!", startPos.value().ToString(), endPos.value().ToString());
@@ -293,6 +327,7 @@ void BindCellEventsForGameState(Core::GameManager& manager, const std::string& g
 					}
 
 					ResetCellVisuals();
+					ClearCandidateMoves();
 					//lastSelected->Highlight(HighlightColorType::PreviousMove);
 					//clickedCell->Highlight(HighlightColorType::PreviousMove);
 					lastSelected->SetState(CellState::PreviousMoveHighlighted, true);
@@ -379,6 +414,8 @@ void BindCellEventsForGameState(Core::GameManager& manager, const std::string& g
 				{
 					for (const auto& piecesMoved : move.PiecesMoved)
 					{
+						//Other pieces moved by the move (like the rook when castling) are not destinations for this piece
+						if (piecesMoved.OldPos != cell.first) continue;
 						cellAtPosition = TryGetCellAtPosition(piecesMoved.NewPos);
 						if (cellAtPosition == nullptr) continue;
 
@@ -490,7 +527,7 @@ bool TryRenderUpdateCells(const Core::GameManager& manager, const GameState& gam
 		auto piecePairIt = gameState.InPlayPieces.find(updatePos);
 		Utils::Log(std::format("Piece positions: {}", Utils::ToStringIterable(gameState.InPlayPieces)));
 		
-		const Piece* updatedPiecePtr = piecePairIt->second;
+		const Piece* updatedPiecePtr = piecePairIt != gameState.InPlayPieces.end() ? piecePairIt->second : nullptr;
 		if (piecePairIt != gameState.InPlayPieces.end())
 			Utils::Log(std::format("Piece At new pos: {} is {}", updatePos.ToString(), updatedPiecePtr->ToString()));
 
@@ -526,6 +563,30 @@ bool TryRenderUpdateCells(const Core::GameManager& manager, const GameState& gam
 }
 
 
+bool TryRenderBoardChange(const Core::GameManager& manager, const GameState& gameState, const std::vector<Utils::Point2DInt>& positions,
+	const std::vector<Utils::Point2DInt>& previousMovePositions)
+{
+	//Previous move cells are cleared first since resetting the cell visuals keeps them highlighted
+	for (const auto& cell : previousMoveCells) cell->ResetStateToDefault();
+	previousMoveCells.clear();
+	ResetCellVisuals();
+	ClearCandidateMoves();
+
+	if (lastSelected != nullptr) lastSelected->ResetStateToDefault();
+	lastSelected = nullptr;
+	if (!TryRenderUpdateCells(manager, gameState, positions)) return false;
+
+	for (const auto& pos : previousMovePositions)
+	{
+		Cell* cell = TryGetCellAtPosition(pos);
+		if (cell == nullptr) continue;
+
+		cell->SetState(CellState::PreviousMoveHighlighted, true);
+		previousMoveCells.push_back(cell);
+	}
+	return true;
+}
+
 void EndCleanup()
 {
 
@@ -8,6 +8,7 @@
 #include "Piece.hpp"
 #include "GameState.hpp"
 #include "GameManager.hpp"
+#include "Search.hpp"
 #include "Globals.hpp"
 
 const wxSize BOARD_SIZE = wxSize(CELL_SIZE.x * BOARD_DIMENSION, CELL_SIZE.y * BOARD_DIMENSION);
@@ -41,5 +42,27 @@ bool TryRenderAllPieces(const Core::GameManager& manager, const GameState& state
 bool TryRenderUpdateCells(const Core::GameManager& manager, 
 	const GameState& gameState, std::vector<Utils::Point2DInt> positions);
 
+/// <summary>
+/// Renders a change to the board that did not come from clicking the cells (like an engine move or an undone move) after clearing
+/// the selection, possible moves, previous move and candidate move highlights. The interactable pieces still need updating after
+/// </summary>
+/// <param name="manager"></param>
+/// <param name="gameState"></param>
+/// <param name="positions"></param>
+/// <param name="previousMovePositions">The start and end of the move that was made (if any) to highlight as the previous move</param>
+/// <returns></returns>
+bool TryRenderBoardChange(const Core::GameManager& manager, const GameState& gameState, const std::vector<Utils::Point2DInt>& positions,
+	const std::vector<Utils::Point2DInt>& previousMovePositions = {});
+
 void UpdateInteractablePieces(const ArmyColor& interactableColor);
+//For while no player can move (like when the engine is thinking)
+void DisableAllPieces();
+
+/// <summary>
+/// Marks the destination of each line's move with its rank and score (from the point of view of the player to move).
+/// Replaces the candidates shown before and is cleared once a move is made
+/// </summary>
+/// <param name="lines">Best first, like GameManager::StartCandidateSearch gives them</param>
+void ShowCandidateMoves(const std::vector<Engine::SearchResult>& lines);
+void ClearCandidateMoves();
 void EndCleanup();
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <format>
+#include <optional>
+#include "GameState.hpp"
+#include "BoardManager.hpp"
+#include "MoveGeneration.hpp"
+#include "OpeningBook.hpp"
+#include "HelperFunctions.hpp"
+
+//Headless opening book tool (built as its own console target with CONSOLE_LOGGING defined):
+//	build <book file> <pgn files...> [maxply=N]	replays the games in the PGN files and writes the moves played up to the ply
+//	probe <book file> <fen>						the book moves of the position with their weights
+
+static const std::string MAX_PLY_OPTION = "maxply=";
+
+static void PrintUsage()
+{
+	std::cout << "Usage:\n"
+		<< std::format("  build <book file> <pgn files...> [maxply=N (default {})]\n", Engine::DEFAULT_BOOK_MAX_PLY)
+		<< "  probe <book file> <fen>" << std::endl;
+}
+
+static std::string GetRemainingArgs(const int argc, char* argv[], const int startIndex)
+{
+	std::string args;
+	for (int i = startIndex; i < argc; i++)
+	{
+		if (!args.empty()) args += ' ';
+		args += argv[i];
+	}
+	return args;
+}
+
+static int RunBuild(const int argc, char* argv[])
+{
+	const std::string bookPath = argv[2];
+	int maxPly = Engine::DEFAULT_BOOK_MAX_PLY;
+	std::vector<std::string> pgnPaths;
+	for (int i = 3; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		if (arg.rfind(MAX_PLY_OPTION, 0) != 0)
+		{
+			pgnPaths.push_back(arg);
+			continue;
+		}
+
+		const std::optional<int> parsedPly = Utils::TryParse<int>(arg.substr(MAX_PLY_OPTION.size()));
+		if (!parsedPly.has_value())
+		{
+			std::cout << std::format("The max ply is not a number: {}", arg) << std::endl;
+			return 1;
+		}
+		maxPly = parsedPly.value();
+	}
+	if (pgnPaths.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	Engine::OpeningBookBuildReport report;
+	if (!Engine::TryBuildOpeningBook(pgnPaths, bookPath, maxPly, report)) return 1;
+
+	std::cout << std::format("Games: {} ({} skipped) Positions: {} Entries: {} Time: {:.2f}s Games/s: {:.0f}",
+		report.GameCount, report.SkippedGameCount, report.PositionCount, report.EntryCount, report.Seconds,
+		report.Seconds > 0 ? report.GameCount / report.Seconds : 0.0) << std::endl;
+	return 0;
+}
+
+static int RunProbe(const int argc, char* argv[])
+{
+	Engine::OpeningBook book;
+	if (!book.TryLoad(argv[2])) return 1;
+
+	//The game state holds the whole undo stack so it lives on the heap
+	auto state = std::make_unique<GameState>();
+	if (!Board::TryLoadFen(*state, GetRemainingArgs(argc, argv, 3))) return 1;
+
+	const std::span<const Engine::OpeningBookEntry> entries = book.FindEntries(state->Hash);
+	if (entries.empty())
+	{
+		std::cout << "The position is not in the book" << std::endl;
+		return 1;
+	}
+
+	Board::MoveList legalMoves;
+	Board::GenerateLegalMoves(*state, legalMoves);
+	for (const auto& entry : entries)
+	{
+		const Board::Move move(entry.Move);
+		std::cout << std::format("{} weight: {}{}", Board::ToCoordinateNotation(move), entry.Weight,
+			legalMoves.Contains(move) ? "" : " (not legal here)") << std::endl;
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::string command = argc > 1 ? argv[1] : "";
+	if (command == "build" && argc > 3) return RunBuild(argc, argv);
+	if (command == "probe" && argc > 3) return RunProbe(argc, argv);
+
+	PrintUsage();
+	return 1;
+}
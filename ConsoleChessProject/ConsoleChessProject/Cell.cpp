@@ -245,6 +245,39 @@ void Cell::RemoveOverlaySprite()
 	Refresh();
 }
 
+void Cell::SetAnnotation(const std::string& text)
+{
+	if (m_annotationText == nullptr)
+	{
+		m_annotationText = new wxStaticText(this, wxID_ANY, "", wxDefaultPosition);
+		m_annotationText->SetFont(GetFont().Smaller());
+		//Like the sprites it must not take the clicks meant for the cell
+		m_annotationText->Enable(false);
+	}
+
+	m_annotationText->SetLabel(text);
+	m_annotationText->SetBackgroundColour(m_colors.PossibleMoveColor);
+	m_annotationText->SetSize(m_annotationText->GetBestSize());
+	m_annotationText->SetPosition(wxPoint(0, 0));
+	m_annotationText->Show();
+	m_annotationText->Raise();
+	Refresh();
+}
+
+void Cell::ClearAnnotation()
+{
+	if (m_annotationText == nullptr) return;
+
+	m_annotationText->SetLabel("");
+	m_annotationText->Hide();
+	Refresh();
+}
+
+bool Cell::HasAnnotation() const
+{
+	return m_annotationText != nullptr && m_annotationText->IsShown();
+}
+
 void Cell::UpdateCanClick(const bool isClickable, const bool updateVisual)
 {
 	m_isClickable = isClickable;
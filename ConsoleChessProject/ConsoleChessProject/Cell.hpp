@@ -63,6 +63,8 @@ private:
 
 	wxStaticBitmap* m_bitMapDisplay = nullptr;
 	wxStaticBitmap* m_overlayPanel = nullptr;
+	//Created the first time the cell is annotated
+	wxStaticText* m_annotationText = nullptr;
 
 public:
 	const bool& m_IsClickable;
@@ -135,6 +137,15 @@ public:
 	void UpdateCanClick(const bool isClickable, const bool updateVisual);
 	void AddOnClickCallback(const std::function<void(Cell*)>& callback);
 
+	/// <summary>
+	/// Shows a short note (like the rank and score of a candidate move) in the corner of the cell.
+	/// It stays on top of whatever state the cell is in until it is cleared
+	/// </summary>
+	/// <param name="text"></param>
+	void SetAnnotation(const std::string& text);
+	void ClearAnnotation();
+	bool HasAnnotation() const;
+
 	void SetState(const CellState& state, const bool updateVisual);
 	void ToggleState(const CellState& state);
 	void ResetStateToDefault();
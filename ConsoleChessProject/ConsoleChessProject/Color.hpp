@@ -7,4 +7,9 @@ enum class ArmyColor
 	Dark,
 };
 
+constexpr ArmyColor GetOppositeColor(const ArmyColor color)
+{
+	return color == ArmyColor::Light ? ArmyColor::Dark : ArmyColor::Light;
+}
+
 std::string ToString(const ArmyColor& color);
\ No newline at end of file
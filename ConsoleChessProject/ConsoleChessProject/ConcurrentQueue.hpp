@@ -0,0 +1,59 @@
+#pragma once
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Utils
+{
+	namespace Collections
+	{
+		/// <summary>
+		/// First in first out queue that any number of threads can push to and pop from.
+		/// Meant for handing results from worker threads to the ui thread, so it only locks for the push or pop itself
+		/// </summary>
+		template<typename T>
+		class ConcurrentQueue
+		{
+		private:
+			std::deque<T> m_items;
+			mutable std::mutex m_mutex;
+
+		public:
+			void Push(T item)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_items.push_back(std::move(item));
+			}
+
+			bool TryPop(T& item)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_items.empty()) return false;
+
+				item = std::move(m_items.front());
+				m_items.pop_front();
+				return true;
+			}
+
+			/// <summary>
+			/// Removes and returns every item in the order they were pushed
+			/// </summary>
+			/// <returns></returns>
+			std::vector<T> Drain()
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				std::vector<T> items(std::make_move_iterator(m_items.begin()), std::make_move_iterator(m_items.end()));
+				m_items.clear();
+				return items;
+			}
+
+			bool IsEmpty() const
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				return m_items.empty();
+			}
+		};
+	}
+}
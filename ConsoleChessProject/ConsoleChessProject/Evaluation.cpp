@@ -0,0 +1,30 @@
+#include <algorithm>
+#include "Evaluation.hpp"
+#include "GameState.hpp"
+#include "PieceSquareTables.hpp"
+#include "Bitboard.hpp"
+#include "Piece.hpp"
+
+namespace Engine
+{
+	int GetPieceValue(const PieceType type)
+	{
+		return Board::PIECE_VALUES[Board::ToIndex(type)];
+	}
+
+	int GetMaterialAdvantage(const GameState& state, const ArmyColor color)
+	{
+		const auto& material = state.Evaluation.Material;
+		const int lightAdvantage = material[Board::ToIndex(ArmyColor::Light)] - material[Board::ToIndex(ArmyColor::Dark)];
+		return color == ArmyColor::Light ? lightAdvantage : -lightAdvantage;
+	}
+
+	int Evaluate(const GameState& state)
+	{
+		//Promotions can take the phase past the starting amount so it is capped to stay a pure middlegame score
+		const Board::TaperedScore& score = state.Evaluation.Score;
+		const int phase = std::min(state.Evaluation.Phase, Board::MAX_GAME_PHASE);
+		const int lightScore = (score.Middlegame * phase + score.Endgame * (Board::MAX_GAME_PHASE - phase)) / Board::MAX_GAME_PHASE;
+		return state.CurrentPlayer == ArmyColor::Light ? lightScore : -lightScore;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "GameState.hpp"
+
+namespace Engine
+{
+	/// <summary>
+	/// Returns the static score of the position in centipawns from the point of view
+	/// of the player to move (positive means the player to move is ahead).
+	/// The middlegame and endgame piece-square scores kept by MakeMove are blended by the game phase
+	/// </summary>
+	/// <param name="state"></param>
+	/// <returns></returns>
+	int Evaluate(const GameState& state);
+
+	/// <summary>
+	/// Returns the value of the piece type in centipawns (the king is worth 0 since it is never traded)
+	/// </summary>
+	/// <param name="type"></param>
+	/// <returns></returns>
+	int GetPieceValue(const PieceType type);
+
+	/// <summary>
+	/// Returns how much more material (in centipawns) the color has than its opponent
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="color"></param>
+	/// <returns></returns>
+	int GetMaterialAdvantage(const GameState& state, const ArmyColor color);
+}
@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "GameAnnotation.hpp"
+#include "WorkStealingPool.hpp"
+#include "Pgn.hpp"
+#include "Nnue.hpp"
+#include "MoveExecution.hpp"
+#include "HelperFunctions.hpp"
+
+namespace Engine
+{
+	//Games that are replayed, searched or waiting for the games before them to be written, per thread
+	static constexpr size_t GAMES_IN_FLIGHT_PER_THREAD = 4;
+	//Scores past this count as the same when measuring what a move lost, so a longer mate than the best one is not a blunder
+	static constexpr int MAX_LOSS_SCORE = 1000;
+	//Movetext lines are wrapped before this many characters like PGN export asks for
+	static constexpr size_t PGN_LINE_LENGTH = 80;
+
+	struct PositionAnalysis
+	{
+		Board::Move BestMove;
+		//Centipawns from the point of view of the player to move
+		int Score;
+		std::uint64_t Nodes;
+	};
+
+	struct AnnotationJob
+	{
+		Board::PgnGame Game;
+		std::unique_ptr<GameState> StartPosition;
+		//The moves of the game up to the first one that could not be read
+		std::vector<Board::Move> Moves;
+		//One per position from the start to after the last move read (empty when the start position could not be read)
+		std::vector<PositionAnalysis> Analyses;
+		bool IsReadable = true;
+		int ReplayWorkerIndex = 0;
+		std::atomic<size_t> RemainingSearches = 0;
+		//Guarded by the pipeline's mutex
+		bool IsDone = false;
+	};
+
+	struct AnnotationPipeline
+	{
+		const AnnotationSettings* Settings = nullptr;
+		//Each worker's own table and position to search on, so searches never wait on each other
+		std::vector<std::unique_ptr<TranspositionTable>> Tables;
+		std::vector<std::unique_ptr<GameState>> Positions;
+		std::mutex Mutex;
+		std::condition_variable GameDone;
+		std::atomic<std::uint64_t> StolenSearchCount = 0;
+	};
+
+	double GetGamesPerSecond(const AnnotationReport& report)
+	{
+		return report.Seconds > 0 ? report.GameCount / report.Seconds : 0;
+	}
+
+	double GetPositionsPerSecond(const AnnotationReport& report)
+	{
+		return report.Seconds > 0 ? report.PositionCount / report.Seconds : 0;
+	}
+
+	static void MarkDone(AnnotationPipeline& pipeline, AnnotationJob& job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(pipeline.Mutex);
+			job.IsDone = true;
+		}
+		pipeline.GameDone.notify_all();
+	}
+
+	static void SearchPosition(AnnotationPipeline& pipeline, AnnotationJob& job, const size_t ply, const int workerIndex)
+	{
+		//Replaying from the start costs far less than the search and saves keeping a copy of every position of the game
+		GameState& position = *pipeline.Positions[workerIndex];
+		CopyPosition(*job.StartPosition, position);
+		for (size_t i = 0; i < ply; i++) Board::MakeMove(position, job.Moves[i]);
+
+		SearchLimits limits = pipeline.Settings->Limits;
+		limits.Threads = 1;
+		limits.OnProgress = nullptr;
+		const SearchResult result = Search(position, limits, *pipeline.Tables[workerIndex]);
+		job.Analyses[ply] = { result.BestMove, result.Score, result.Nodes };
+
+		if (workerIndex != job.ReplayWorkerIndex) pipeline.StolenSearchCount.fetch_add(1, std::memory_order_relaxed);
+		if (job.RemainingSearches.fetch_sub(1, std::memory_order_acq_rel) == 1) MarkDone(pipeline, job);
+	}
+
+	static void ReplayGame(AnnotationPipeline& pipeline, Utils::WorkStealingPool& pool, AnnotationJob& job, const int workerIndex)
+	{
+		job.ReplayWorkerIndex = workerIndex;
+		job.StartPosition = std::make_unique<GameState>();
+		if (!Board::TryLoadPgnStartPosition(*job.StartPosition, job.Game))
+		{
+			job.IsReadable = false;
+			MarkDone(pipeline, job);
+			return;
+		}
+
+		GameState& position = *pipeline.Positions[workerIndex];
+		CopyPosition(*job.StartPosition, position);
+		for (const auto& san : job.Game.Moves)
+		{
+			Board::Move move;
+			if (!Board::TryParseSanMove(position, san, move) || !Board::MakeMove(position, move))
+			{
+				job.IsReadable = false;
+				break;
+			}
+			job.Moves.push_back(move);
+		}
+
+		//The searches go on this worker's queue so idle workers take the ones it does not get to first.
+		//The job is written and destroyed once its last search is done, so it is not read after that one is queued
+		const size_t positionCount = job.Moves.size() + 1;
+		job.Analyses.resize(positionCount);
+		job.RemainingSearches.store(positionCount, std::memory_order_relaxed);
+		for (size_t ply = 0; ply < positionCount; ply++)
+		{
+			pool.Submit([&pipeline, &job, ply](const int searchWorkerIndex) -> void
+				{
+					SearchPosition(pipeline, job, ply, searchWorkerIndex);
+				});
+		}
+	}
+
+	static std::string ToEvalString(const int lightScore)
+	{
+		if (!IsMateScore(lightScore)) return std::format("{:.2f}", lightScore / 100.0);
+
+		const int matePlies = MATE_SCORE - std::abs(lightScore);
+		return std::format("#{}{}", lightScore > 0 ? "" : "-", (matePlies + 1) / 2);
+	}
+
+	static std::string EscapeTagValue(const std::string& value)
+	{
+		std::string escaped;
+		for (const char character : value)
+		{
+			if (character == '"' || character == '\\') escaped += '\\';
+			escaped += character;
+		}
+		return escaped;
+	}
+
+	//The move number the game starts at, which is the last field of its FEN tag when it has one
+	static int GetStartMoveNumber(const Board::PgnGame& game)
+	{
+		const std::optional<std::string> fen = Board::TryGetPgnTag(game, "FEN");
+		if (!fen.has_value()) return 1;
+
+		std::istringstream fields(fen.value());
+		std::string field;
+		std::string lastField;
+		while (fields >> field) lastField = field;
+		const int moveNumber = std::atoi(lastField.c_str());
+		return moveNumber > 0 ? moveNumber : 1;
+	}
+
+	/// <summary>
+	/// Collects movetext tokens into lines that are wrapped before PGN_LINE_LENGTH (a comment is never split)
+	/// </summary>
+	class MovetextWriter
+	{
+	private:
+		std::ostream& m_output;
+		std::string m_line;
+
+	public:
+		explicit MovetextWriter(std::ostream& output) : m_output(output), m_line() {}
+
+		void Add(const std::string& token)
+		{
+			if (!m_line.empty() && m_line.size() + 1 + token.size() > PGN_LINE_LENGTH)
+			{
+				m_output << m_line << '\n';
+				m_line.clear();
+			}
+			if (!m_line.empty()) m_line += ' ';
+			m_line += token;
+		}
+
+		void Finish()
+		{
+			if (!m_line.empty()) m_output << m_line << '\n';
+			m_line.clear();
+		}
+	};
+
+	static void WriteGame(std::ostream& output, const AnnotationJob& job, const AnnotationSettings& settings,
+		GameState& position, AnnotationReport& report)
+	{
+		for (const auto& [name, value] : job.Game.Tags) output << std::format("[{} \"{}\"]\n", name, EscapeTagValue(value));
+		output << '\n';
+
+		MovetextWriter movetext(output);
+		int moveNumber = GetStartMoveNumber(job.Game);
+		bool isLightToMove = job.Analyses.empty() || job.StartPosition->CurrentPlayer == ArmyColor::Light;
+		if (!job.Analyses.empty()) CopyPosition(*job.StartPosition, position);
+
+		for (size_t ply = 0; ply < job.Game.Moves.size(); ply++)
+		{
+			//Moves are followed by a comment so dark's moves need their number too
+			movetext.Add(std::format("{}{}", moveNumber, isLightToMove ? "." : "..."));
+			if (ply >= job.Moves.size())
+			{
+				//The moves after one that could not be read are written as they were
+				movetext.Add(job.Game.Moves[ply]);
+			}
+			else
+			{
+				const Board::Move& move = job.Moves[ply];
+				const PositionAnalysis& before = job.Analyses[ply];
+				const PositionAnalysis& after = job.Analyses[ply + 1];
+
+				const int bestScore = std::clamp(before.Score, -MAX_LOSS_SCORE, MAX_LOSS_SCORE);
+				const int playedScore = std::clamp(-after.Score, -MAX_LOSS_SCORE, MAX_LOSS_SCORE);
+				const int loss = before.BestMove == move ? 0 : std::max(bestScore - playedScore, 0);
+
+				std::string nag;
+				std::string judgement;
+				if (loss >= settings.BlunderLoss)
+				{
+					nag = "$4";
+					judgement = "Blunder";
+					report.BlunderCount++;
+				}
+				else if (loss >= settings.MistakeLoss)
+				{
+					nag = "$2";
+					judgement = "Mistake";
+					report.MistakeCount++;
+				}
+				else if (loss >= settings.InaccuracyLoss)
+				{
+					nag = "$6";
+					judgement = "Inaccuracy";
+					report.InaccuracyCount++;
+				}
+
+				//The best move is written before the move is made since its notation depends on the position
+				const std::string bestMoveSan = judgement.empty() || before.BestMove.IsNull() ? "" :
+					Board::ToSanNotation(position, before.BestMove);
+				movetext.Add(Board::ToSanNotation(position, move));
+				if (!nag.empty()) movetext.Add(nag);
+				Board::MakeMove(position, move);
+
+				//After a mate or stalemate there is nothing to evaluate
+				std::string comment;
+				if (!after.BestMove.IsNull())
+				{
+					const int lightScore = position.CurrentPlayer == ArmyColor::Light ? after.Score : -after.Score;
+					comment = std::format("[%eval {}]", ToEvalString(lightScore));
+				}
+				if (!judgement.empty())
+				{
+					if (!comment.empty()) comment += ' ';
+					comment += bestMoveSan.empty() ? std::format("{}.", judgement) : std::format("{}. Best was {}.", judgement, bestMoveSan);
+				}
+				if (!comment.empty()) movetext.Add(std::format("{{ {} }}", comment));
+			}
+
+			if (!isLightToMove) moveNumber++;
+			isLightToMove = !isLightToMove;
+		}
+
+		movetext.Add(job.Game.Result);
+		movetext.Finish();
+		output << '\n';
+
+		report.PositionCount += job.Analyses.size();
+		for (const auto& analysis : job.Analyses) report.Nodes += analysis.Nodes;
+		if (!job.IsReadable) report.UnreadableGameCount++;
+	}
+
+	bool TryAnnotateGames(std::istream& input, std::ostream& output, const AnnotationSettings& settings, AnnotationReport& report)
+	{
+		report = {};
+		if (settings.Threads < 1 || settings.Threads > MAX_SEARCH_THREADS)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to annotate games with {} threads but it must be "
+				"between 1 and {}", settings.Threads, MAX_SEARCH_THREADS));
+			return false;
+		}
+		//Checked once here instead of failing every search
+		if (settings.Limits.Depth < 0 || settings.Limits.Depth >= MAX_PLY)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to annotate games to depth: {} but it must be "
+				"between 0 (no depth limit) and {}", settings.Limits.Depth, MAX_PLY - 1));
+			return false;
+		}
+		if (settings.Limits.Network != nullptr && !settings.Limits.Network->IsLoaded())
+		{
+			Utils::Log(Utils::LogType::Error, "Tried to annotate games with a network evaluation but the network is not loaded");
+			return false;
+		}
+
+		const auto startTime = std::chrono::steady_clock::now();
+		AnnotationPipeline pipeline;
+		pipeline.Settings = &settings;
+		for (int i = 0; i < settings.Threads; i++)
+		{
+			pipeline.Tables.push_back(std::make_unique<TranspositionTable>(settings.HashMegabytes));
+			pipeline.Positions.push_back(std::make_unique<GameState>());
+		}
+
+		//Declared after the pipeline so its workers are stopped before what they use is destroyed
+		Utils::WorkStealingPool pool(settings.Threads);
+		const size_t maxGamesInFlight = settings.Threads * GAMES_IN_FLIGHT_PER_THREAD;
+		std::deque<std::unique_ptr<AnnotationJob>> jobs;
+		auto writePosition = std::make_unique<GameState>();
+
+		Board::PgnReader reader(input);
+		bool isInputDone = false;
+		while (!isInputDone || !jobs.empty())
+		{
+			if (!isInputDone && jobs.size() < maxGamesInFlight)
+			{
+				auto job = std::make_unique<AnnotationJob>();
+				if (!reader.TryReadGame(job->Game))
+				{
+					isInputDone = true;
+					continue;
+				}
+
+				AnnotationJob* jobPointer = job.get();
+				pool.Submit([&pipeline, &pool, jobPointer](const int workerIndex) -> void
+					{
+						ReplayGame(pipeline, pool, *jobPointer, workerIndex);
+					});
+				jobs.push_back(std::move(job));
+				report.GameCount++;
+
+				//Keep reading while there is room unless the oldest game can be written already
+				std::lock_guard<std::mutex> lock(pipeline.Mutex);
+				if (!jobs.front()->IsDone) continue;
+			}
+
+			//Games are written in the order they were read, so a finished game waits for the ones before it
+			{
+				std::unique_lock<std::mutex> lock(pipeline.Mutex);
+				pipeline.GameDone.wait(lock, [&jobs]() -> bool { return jobs.front()->IsDone; });
+			}
+			WriteGame(output, *jobs.front(), settings, *writePosition, report);
+			jobs.pop_front();
+		}
+
+		pool.WaitUntilIdle();
+		report.StolenSearchCount = pipeline.StolenSearchCount.load(std::memory_order_relaxed);
+		report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+		output.flush();
+		if (!output)
+		{
+			Utils::Log(Utils::LogType::Error, "Tried to write the annotated games but writing the output failed");
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include "Search.hpp"
+#include "TranspositionTable.hpp"
+
+namespace Engine
+{
+	//Centipawns a move has to lose against the best move to be marked as each kind of error
+	constexpr int DEFAULT_INACCURACY_LOSS = 50;
+	constexpr int DEFAULT_MISTAKE_LOSS = 100;
+	constexpr int DEFAULT_BLUNDER_LOSS = 300;
+
+	struct AnnotationSettings
+	{
+		//The budget of the search of every position. Its thread count is not used since the positions are searched in parallel instead
+		SearchLimits Limits;
+		int Threads = 1;
+		//Size of each thread's own transposition table
+		size_t HashMegabytes = DEFAULT_HASH_MEGABYTES;
+		int InaccuracyLoss = DEFAULT_INACCURACY_LOSS;
+		int MistakeLoss = DEFAULT_MISTAKE_LOSS;
+		int BlunderLoss = DEFAULT_BLUNDER_LOSS;
+	};
+
+	struct AnnotationReport
+	{
+		std::uint64_t GameCount;
+		//Games with a start position or move that could not be read. They are still written with the moves before it annotated
+		std::uint64_t UnreadableGameCount;
+		std::uint64_t PositionCount;
+		std::uint64_t Nodes;
+		std::uint64_t InaccuracyCount;
+		std::uint64_t MistakeCount;
+		std::uint64_t BlunderCount;
+		//Position searches that ran on another thread than the one that replayed their game
+		std::uint64_t StolenSearchCount;
+		double Seconds;
+	};
+
+	double GetGamesPerSecond(const AnnotationReport& report);
+	double GetPositionsPerSecond(const AnnotationReport& report);
+
+	/// <summary>
+	/// Reads the games of the PGN input one at a time, searches every position of their main lines with the settings' budget
+	/// and writes them to the output in the same order with the evaluation after each move as a [%eval] comment (from light's
+	/// point of view, in pawns or #moves to mate) and the moves that lost too much marked with $6 (?!), $2 (?) or $4 (??) and
+	/// the best move. The input's comments and variations are not kept.
+	/// Each game is replayed on one of the pool's threads, which queues a search per position that idle threads steal,
+	/// so one long game is spread over every thread. Only a few games per thread are held at once so any input size can be streamed
+	/// </summary>
+	/// <param name="input"></param>
+	/// <param name="output"></param>
+	/// <param name="settings"></param>
+	/// <param name="report"></param>
+	/// <returns></returns>
+	bool TryAnnotateGames(std::istream& input, std::ostream& output, const AnnotationSettings& settings, AnnotationReport& report);
+}
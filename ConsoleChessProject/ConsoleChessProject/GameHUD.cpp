@@ -5,6 +5,7 @@
 #include "ResourceManager.hpp"
 #include "GameManager.hpp"
 #include "GameState.hpp"
+#include "WinProbability.hpp"
 #include "Color.hpp"
 #include "UIGlobals.hpp"
 #include "DirectionalLayout.hpp"
@@ -44,9 +45,10 @@ static void SetWinDisplayValue(float percent)
 
 static void UpdateWinningDisplay(const Core::GameManager& manager, const GameState& state)
 {
-	std::unordered_map<ArmyColor, float> percents = manager.CalculateWinPercentage(state);
-	Utils::Log(std::format("CALC: update win display with percetn: {}", std::to_string(percents.at(ArmyColor::Dark))));
-	SetWinDisplayValue(percents.at(ArmyColor::Dark));
+	//This is the static estimate (or an earlier search of the position) until the search of the turn arrives
+	const float darkProbability = manager.CalculateWinProbability(state, ArmyColor::Dark);
+	Utils::Log(std::format("CALC: update win display with percetn: {}", std::to_string(darkProbability)));
+	SetWinDisplayValue(darkProbability);
 }
 
 void CreateWinChanceDisplay(Core::GameManager& manager, wxWindow* parent)
@@ -83,24 +85,33 @@ void CreateWinChanceDisplay(Core::GameManager& manager, wxWindow* parent)
 	//layoutParent->AddChild(winningSliderPanel, 1, SpacingType::Center);
 	SetWinDisplayValue(0.5);
 
+	manager.AddEventCallback(Core::GameEventType::StartGame, 
+		[&manager](const GameState& state) -> void{ UpdateWinningDisplay(manager, state); });
 	manager.AddEventCallback(Core::GameEventType::SuccessfulTurn, 
 		[&manager](const GameState& state) -> void{ UpdateWinningDisplay(manager, state); });
+	manager.AddEventCallback(Core::GameEventType::MoveUndone, 
+		[&manager](const GameState& state) -> void{ UpdateWinningDisplay(manager, state); });
+	//Search results come from the worker thread so they are moved over to the ui thread
+	manager.AddWinProbabilityCallback([](const Engine::WinProbability& probability) -> void
+		{
+			winningSliderPanel->CallAfter([probability]() -> void { SetWinDisplayValue(1 - probability.Light); });
+		});
 }
 
-static void UpdateCaptureDisplay(const GameState& state)
+static void UpdateCaptureDisplay(const Core::GameManager& manager, const GameState& state)
 {
 	/*Utils::Log(std::format("DISPLAY: Update display game state: dark: {} light:",
 		std::to_string(state.TeamValue.size())));*/
 
 		//std::to_string(state.TeamValue.at(ColorTheme::Dark)), std::to_string(state.TeamValue.at(ColorTheme::Light))));
-	lightValueText->SetLabel("PTS: "+std::to_string(state.TeamValue.at(ArmyColor::Light)));
+	lightValueText->SetLabel("PTS: "+std::to_string(manager.GetTeamPoints(state, ArmyColor::Light)));
 	lightValueText->SetSize(lightValueText->GetBestSize());
 
 	wxPoint lightCenterPos = wxPoint((lightValueText->GetParent()->GetSize().x - 
 		lightValueText->GetSize().x)/2, lightValueText->GetPosition().y);
 	lightValueText->SetPosition(lightCenterPos);
 
-	darkValueText->SetLabel("PTS: "+std::to_string(state.TeamValue.at(ArmyColor::Dark)));
+	darkValueText->SetLabel("PTS: "+std::to_string(manager.GetTeamPoints(state, ArmyColor::Dark)));
 	darkValueText->SetSize(darkValueText->GetBestSize());
 
 	wxPoint darkCenterPos = wxPoint((lightValueText->GetParent()->GetSize().x - 
@@ -202,6 +213,10 @@ void CreateCaptureDisplay(Core::GameManager& manager, wxWindow* parent)
 	darkLayout->AddChild(darkPanelPieces, 1, SpacingType::Center);
 	displayRoot->AddChild(darkLayout, 1, SPACING_ALL_SIDES, LAYOUT_SPACING);
 
-	manager.AddEventCallback(Core::GameEventType::SuccessfulTurn, &UpdateCaptureDisplay);
-	manager.AddEventCallback(Core::GameEventType::StartGame, &UpdateCaptureDisplay);
+	manager.AddEventCallback(Core::GameEventType::SuccessfulTurn, 
+		[&manager](const GameState& state) -> void{ UpdateCaptureDisplay(manager, state); });
+	manager.AddEventCallback(Core::GameEventType::MoveUndone, 
+		[&manager](const GameState& state) -> void{ UpdateCaptureDisplay(manager, state); });
+	manager.AddEventCallback(Core::GameEventType::StartGame, 
+		[&manager](const GameState& state) -> void{ UpdateCaptureDisplay(manager, state); });
 }
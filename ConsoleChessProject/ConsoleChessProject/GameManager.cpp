@@ -3,7 +3,14 @@
 #include <format>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <memory>
 #include <optional>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include <atomic>
+#include <future>
 #include "HelperFunctions.hpp"
 #include "GameManager.hpp"
 #include "Color.hpp"
@@ -11,11 +18,21 @@
 #include "Event.hpp"
 #include "GameState.hpp"
 #include "PieceMoveResult.hpp"
+#include "Search.hpp"
+#include "Evaluation.hpp"
+#include "Bitboard.hpp"
+#include "MoveGeneration.hpp"
+#include "MoveExecution.hpp"
 
 namespace Core
 {
+	//The win chances only need a rough search, bounded by both so slow machines still get one quickly
+	static constexpr int WIN_PROBABILITY_DEPTH = 10;
+	static constexpr std::chrono::milliseconds WIN_PROBABILITY_TIME{ 250 };
+
 	GameManager::GameManager()
-		: m_allGameStates(), m_eventListeners{} //,GameStartEvent(), GameEndEvent(), TurnChangeEvent()
+		: m_allGameStates(), m_eventListeners{}, m_engineTimeBudgets(), m_transpositionTable(Engine::DEFAULT_HASH_MEGABYTES), 
+		m_bookRandom(std::random_device{}()) //,GameStartEvent(), GameEndEvent(), TurnChangeEvent()
 	{
 		//Utils::Log(std::format("GAME MANAGER created Current game states: {}", std::to_string(TotalGameStatesCount())));
 	}
@@ -74,6 +91,11 @@ namespace Core
 			return {};
 		}
 
+		//Results from finished games are useless to the new one so they are cleared when no other game still uses them.
+		//Otherwise the age of each new search makes them the first entries to be replaced
+		if (m_allGameStates.empty()) m_transpositionTable.Clear();
+		else m_transpositionTable.NewSearch();
+
 		auto newStateIt= m_allGameStates.emplace(newGameStateID, GameState{});
 		if (!newStateIt.second)
 		{
@@ -85,7 +107,6 @@ namespace Core
 
 		GameState& newState = newStateIt.first->second;
 		newState.CurrentPlayer = ArmyColor::Light;
-		newState.TeamValue = { {ArmyColor::Light, 0}, {ArmyColor::Dark, 0}};
 		Board::CreateDefaultBoard(newState);
 		InvokeEvent(newState, GameEventType::StartGame);
 		
@@ -127,103 +148,448 @@ namespace Core
 		/*Utils::Log(std::format("MOVE INFO: game manager try move update peice all prev moves: {}",
 			Utils::ToStringIterable<std::vector<MoveInfo>, MoveInfo>(maybeGameState->PreviousMoves.at(maybeGameState->CurrentPlayer))));*/
 
-		if (moveResult.IsValidMove) InvokeEvent(*maybeGameState, GameEventType::PieceMoved);
+		if (moveResult.IsValidMove)
+		{
+			ResolvePondering(gameStateID, *maybeGameState);
+			InvokeEvent(*maybeGameState, GameEventType::PieceMoved);
+		}
 		return moveResult;
 	}
 
-	std::vector<MoveInfo> GameManager::TryGetPossibleMovesForPieceAt(const std::string& gameStateID, const Utils::Point2DInt& pos)
+	PieceMoveResult GameManager::TryUndoMove(const std::string& gameStateID)
 	{
 		GameState* maybeGameState = TryGetGameStateMutable(gameStateID);
-		//Utils::Log(std::format("Try get possible moves game manager has state: {}", std::to_string(maybeGameState!=nullptr)));
-		if (!IsValidGameState(maybeGameState, std::format("GetPossibleMoves(id:{})", gameStateID)))
+		if (!IsValidGameState(maybeGameState, std::format("TryUndoMove(id:{})", gameStateID)))
 		{
-			return {};
+			return { Board::INVALID_MOVE, false, std::format("Failed to retrieve current game data") };
 		}
-		return Board::GetPossibleMovesForPieceAt(*maybeGameState, pos);
+
+		//An engine move being searched would be for the position that is taken back
+		StopEngineMove(gameStateID);
+		PieceMoveResult undoResult = Board::TryUndoMove(*maybeGameState);
+		if (!undoResult.IsValidMove) return undoResult;
+
+		StopPondering(gameStateID);
+		m_ponderPredictions.erase(gameStateID);
+		RequestWinProbability(*maybeGameState);
+		InvokeEvent(*maybeGameState, GameEventType::MoveUndone);
+		return undoResult;
 	}
 
-	std::optional<MoveValueInfo> GameManager::TryCalculateLastMoveValue(const std::string& gameStateID, const ArmyColor color)
+	std::shared_future<EngineMove> GameManager::StartEngineMove(const std::string& gameStateID, const Engine::SearchLimits& limits,
+		const EngineMoveCallback& callback)
 	{
 		GameState* maybeGameState = TryGetGameStateMutable(gameStateID);
-		//Utils::Log(std::format("Try get possible moves game manager has state: {}", std::to_string(maybeGameState!=nullptr)));
-		if (!IsValidGameState(maybeGameState, std::format("TryCalculateMoveValue(id:{})", gameStateID)))
+		if (!IsValidGameState(maybeGameState, std::format("StartEngineMove(id:{})", gameStateID))) return {};
+
+		StopEngineMove(gameStateID);
+		EngineMoveSearch search = { maybeGameState->Hash, limits, false, {}, std::make_unique<std::atomic<bool>>(false), {}, {} };
+		auto budgetIt = m_engineTimeBudgets.find(gameStateID);
+		search.UsesBudget = budgetIt != m_engineTimeBudgets.end() && 
+			limits.MoveTime.count() == 0 && limits.RemainingTime.count() == 0;
+		if (search.UsesBudget)
 		{
-			return std::nullopt;
+			//An empty clock still gets a millisecond so the search keeps a deadline and only completes its first depth
+			search.Limits.RemainingTime = std::max(budgetIt->second.RemainingTime, std::chrono::milliseconds{ 1 });
+			search.Limits.Increment = budgetIt->second.Increment;
 		}
+		ApplyEngineResources(search.Limits);
+		search.Limits.StopSignal = search.StopSignal.get();
+
+		//Picked here since these are quick and only the searches need the worker
+		EngineMove pickedMove = { maybeGameState->Hash, {}, {} };
+		auto ponderIt = m_ponderSearches.find(gameStateID);
+		const Board::Move bookMove = m_openingBook.PickMove(*maybeGameState, m_bookRandom());
+		const Board::Move tablebaseMove = bookMove.IsNull() ? m_tablebases.GetBestMove(*maybeGameState) : Board::NULL_MOVE;
+		std::chrono::steady_clock::time_point ponderHitTime = {};
+		if (!bookMove.IsNull())
+		{
+			StopPondering(gameStateID);
+			pickedMove.Result.BestMove = bookMove;
+			pickedMove.Result.PrincipalVariation = { bookMove };
+			Utils::Log(std::format("[GAME_MANAGER]: Engine move of game: {} comes from the opening book", gameStateID));
+		}
+		else if (!tablebaseMove.IsNull())
+		{
+			//The ending is solved so there is nothing to search
+			StopPondering(gameStateID);
+			pickedMove.Result.BestMove = tablebaseMove;
+			pickedMove.Result.Score = Engine::ToSearchScore(m_tablebases.Probe(*maybeGameState).value(), 0);
+			pickedMove.Result.PrincipalVariation = { tablebaseMove };
+			Utils::Log(std::format("[GAME_MANAGER]: Engine move of game: {} comes from the tablebases", gameStateID));
+		}
+		else if (ponderIt != m_ponderSearches.end() && ponderIt->second.IsHit)
+		{
+			//The search has been on this position since the engine's last move and its time has been counting since then,
+			//so it is usually done already. The time before the hit was the opponent's
+			search.PonderHandle = ponderIt->second.Handle;
+			ponderHitTime = ponderIt->second.HitTime;
+			m_ponderSearches.erase(ponderIt);
+			Utils::Log(std::format("[GAME_MANAGER]: Engine move of game: {} comes from its ponder search", gameStateID));
+		}
+		else StopPondering(gameStateID);
+
+		const bool isPicked = !pickedMove.Result.BestMove.IsNull();
+		auto position = std::make_shared<GameState>();
+		if (!isPicked && !search.PonderHandle.IsValid()) Engine::CopyPosition(*maybeGameState, *position);
+
+		auto resultPromise = std::make_shared<std::promise<EngineMove>>();
+		search.Result = resultPromise->get_future().share();
+		const Engine::SearchLimits searchLimits = search.Limits;
+		Engine::AnalysisHandle ponderHandle = search.PonderHandle;
+		Engine::TranspositionTable& table = m_transpositionTable;
+		search.Worker = std::async(std::launch::async, 
+			[pickedMove, isPicked, position, ponderHandle, ponderHitTime, searchLimits, &table, callback, resultPromise]() mutable -> void
+			{
+				EngineMove move = pickedMove;
+				if (!isPicked && ponderHandle.IsValid())
+				{
+					move.Result = ponderHandle.Wait();
+					move.SearchTime = std::chrono::steady_clock::now() - ponderHitTime;
+				}
+				else if (!isPicked)
+				{
+					move.Result = Engine::Search(*position, searchLimits, table);
+					move.SearchTime = std::chrono::duration<double>(move.Result.Seconds);
+				}
+				//The callback comes before the result so anything waiting on the result knows the callback is done with
+				if (callback) callback(move);
+				resultPromise->set_value(move);
+			});
+
+		std::shared_future<EngineMove> result = search.Result;
+		m_engineMoveSearches.insert_or_assign(gameStateID, std::move(search));
+		return result;
+	}
 
-		/*Utils::Log(std::format("MOVE INFO: Try calc last move for color: {} previous moves: {}", ToString(color),
-			maybeGameState != nullptr ? Utils::ToStringIterable<std::vector<MoveInfo>, MoveInfo>(maybeGameState->PreviousMoves.at(color)) : "NULL"));*/
-
-		auto colorMovesIt = maybeGameState->PreviousMoves.find(color);
-		if (colorMovesIt == maybeGameState->PreviousMoves.end())
+	PieceMoveResult GameManager::TryPlayEngineMove(const std::string& gameStateID, const EngineMove& engineMove)
+	{
+		GameState* maybeGameState = TryGetGameStateMutable(gameStateID);
+		if (!IsValidGameState(maybeGameState, std::format("TryPlayEngineMove(id:{})", gameStateID)))
 		{
-			/*Utils::Log(Utils::LogType::Error, std::format("MOVE INFO: Previous moves for color not found {} ",
-				ToString(color)));*/
+			return { Board::INVALID_MOVE, false, std::format("Failed to retrieve current game data") };
+		}
 
-			return std::nullopt;
+		//A search started after this move's (or none at all) means the move was replaced or stopped
+		auto searchIt = m_engineMoveSearches.find(gameStateID);
+		if (searchIt == m_engineMoveSearches.end() || searchIt->second.Hash != engineMove.Hash)
+			return { Board::INVALID_MOVE, false, std::format("The engine move is not from the game's current engine search") };
+		if (maybeGameState->Hash != engineMove.Hash)
+			return { Board::INVALID_MOVE, false, std::format("The engine move is for a position the game is no longer in") };
+
+		searchIt->second.Worker.wait();
+		const Engine::SearchLimits searchLimits = searchIt->second.Limits;
+		const bool usesBudget = searchIt->second.UsesBudget;
+		m_engineMoveSearches.erase(searchIt);
+
+		auto budgetIt = m_engineTimeBudgets.find(gameStateID);
+		if (usesBudget && budgetIt != m_engineTimeBudgets.end())
+		{
+			const auto timeSpent = std::chrono::duration_cast<std::chrono::milliseconds>(engineMove.SearchTime);
+			budgetIt->second.RemainingTime = std::max(budgetIt->second.RemainingTime - timeSpent, std::chrono::milliseconds::zero()) + 
+				budgetIt->second.Increment;
 		}
-		if (colorMovesIt->second.empty())
+
+		const Engine::SearchResult& searchResult = engineMove.Result;
+		if (searchResult.BestMove.IsNull())
 		{
-			/*Utils::Log(Utils::LogType::Error, std::format("MOVE INFO: Previous moves for color empty {}", ToString(color)));*/
-			return std::nullopt;
+			return { Board::INVALID_MOVE, false, std::format("The engine found no legal move for {}", 
+				ToString(maybeGameState->CurrentPlayer)) };
 		}
 
-		/*Utils::Log(Utils::LogType::Error, std::format("CALLING CAL LAST MOVE VAL for color: {} move: {}",
-			ToString(color),
-			maybeGameState!=nullptr? std::to_string(maybeGameState->PreviousMoves.size()) : "NULL"));*/
-			//return std::nullopt;
+		Utils::Log(std::format("[GAME_MANAGER]: Engine move: {} score: {} depth: {} nodes: {}", 
+			Board::ToCoordinateNotation(searchResult.BestMove), searchResult.Score, searchResult.Depth, searchResult.Nodes));
 
-		const MoveInfo& moveInfo = colorMovesIt->second.at(colorMovesIt->second.size() - 1);
-		std::unordered_map<ArmyColor, int> teamPoints = { {ArmyColor::Light, 0}, {ArmyColor::Dark, 0} };
+		const Board::Move& move = searchResult.BestMove;
+		const PieceType promotionType = move.IsPromotion() ? move.GetPromotionType() : PieceType::Queen;
+		PieceMoveResult moveResult = Board::TryMove(*maybeGameState, Board::ToPosition(move.GetFrom()), 
+			Board::ToPosition(move.GetTo()), promotionType);
 
-		Utils::Log(Utils::LogType::Error, std::format("MOVE INFO: try calc last move for: {} value points moveinfo: {} ",
-			ToString(color),
-			moveInfo.ToString()));
+		if (!moveResult.IsValidMove) return moveResult;
 
-		if (Utils::HasFlag(static_cast<unsigned int>(moveInfo.SpecialMoveFlags),
-			static_cast<unsigned int>(SpecialMove::Capture)) && moveInfo.PieceCaptured!=nullptr)
+		//The second move of the line is the reply the engine expects, which it searches once the turn has passed
+		if (m_ponderingGames.contains(gameStateID) && searchResult.PrincipalVariation.size() >= 2)
 		{
-			int pieceValue = GetValueForPiece(moveInfo.PieceCaptured->m_PieceType);
-			Utils::Log("CALC last move team points");
-			teamPoints.at(moveInfo.PieceCaptured->m_Color) -= pieceValue;
-			teamPoints.at(GetOtherTeam(moveInfo.PieceCaptured->m_Color)) += pieceValue;
+			Engine::SearchLimits ponderLimits = searchLimits;
+			ponderLimits.OnProgress = nullptr;
+			ponderLimits.StopSignal = nullptr;
+			if (usesBudget && budgetIt != m_engineTimeBudgets.end()) 
+				ponderLimits.RemainingTime = std::max(budgetIt->second.RemainingTime, std::chrono::milliseconds{ 1 });
+			m_ponderPredictions.insert_or_assign(gameStateID, PonderPrediction{ searchResult.PrincipalVariation[1], ponderLimits });
 		}
 
-		return MoveValueInfo{ teamPoints };
+		InvokeEvent(*maybeGameState, GameEventType::PieceMoved);
+		return moveResult;
 	}
 
-	std::optional<ArmyColor> GameManager::TryAdvanceTurn(const std::string& gameStateID)
+	void GameManager::StopEngineMove(const std::string& gameStateID)
 	{
-		if (!ADVANCE_TURN) return std::nullopt;
+		auto searchIt = m_engineMoveSearches.find(gameStateID);
+		if (searchIt == m_engineMoveSearches.end()) return;
+
+		searchIt->second.StopSignal->store(true, std::memory_order_relaxed);
+		searchIt->second.PonderHandle.Stop();
+		searchIt->second.Worker.wait();
+		m_engineMoveSearches.erase(searchIt);
+	}
 
+	void GameManager::StartCandidateSearch(const std::string& gameStateID, const Engine::SearchLimits& limits, 
+		const int lineCount, const CandidateMovesCallback& callback)
+	{
 		GameState* maybeGameState = TryGetGameStateMutable(gameStateID);
-		if (!IsValidGameState(maybeGameState, std::format("AdvanceTurn(id:{})", gameStateID))) return std::nullopt;
+		if (!IsValidGameState(maybeGameState, std::format("StartCandidateSearch(id:{})", gameStateID))) return;
+
+		StopCandidateSearch(gameStateID);
+		CandidateSearch search = { std::make_unique<GameState>(), std::make_unique<std::atomic<bool>>(false), {} };
+		Engine::CopyPosition(*maybeGameState, *search.Position);
+
+		Engine::SearchLimits lineLimits = limits;
+		ApplyEngineResources(lineLimits);
+		lineLimits.StopSignal = search.StopSignal.get();
+
+		//The position is on the heap so it stays where it is when the search is moved into the map
+		const GameState* position = search.Position.get();
+		Engine::TranspositionTable& table = m_transpositionTable;
+		search.Worker = std::async(std::launch::async, [position, lineLimits, lineCount, &table, callback]() -> void
+			{
+				const CandidateMoves moves = { position->Hash, Engine::SearchMultiPv(*position, lineLimits, lineCount, table) };
+				for (size_t i = 0; i < moves.Lines.size(); i++)
+				{
+					const Engine::SearchResult& line = moves.Lines[i];
+					Utils::Log(std::format("[GAME_MANAGER]: Candidate {}: {} score: {} depth: {} nodes: {} nps: {:.0f}", i + 1,
+						Board::ToCoordinateNotation(line.BestMove), Engine::ToScoreString(line.Score), line.Depth, line.Nodes,
+						Engine::GetNodesPerSecond(line)));
+				}
+				if (callback) callback(moves);
+			});
+		m_candidateSearches.insert_or_assign(gameStateID, std::move(search));
+	}
 
-		std::optional<MoveValueInfo> maybeMoveVals= TryCalculateLastMoveValue(gameStateID, maybeGameState->CurrentPlayer);
-		if (maybeMoveVals.has_value())
+	void GameManager::StopCandidateSearch(const std::string& gameStateID)
+	{
+		auto searchIt = m_candidateSearches.find(gameStateID);
+		if (searchIt == m_candidateSearches.end()) return;
+
+		searchIt->second.StopSignal->store(true, std::memory_order_relaxed);
+		searchIt->second.Worker.wait();
+		m_candidateSearches.erase(searchIt);
+	}
+
+	bool GameManager::TrySetEngineTimeBudget(const std::string& gameStateID, const std::chrono::milliseconds totalTime,
+		const std::chrono::milliseconds increment)
+	{
+		if (!IsValidGameState(TryGetGameStateMutable(gameStateID), std::format("SetEngineTimeBudget(id:{})", gameStateID))) return false;
+		if (totalTime <= std::chrono::milliseconds::zero())
 		{
-			Utils::Log(std::format("CALC: adding points to team dark {} light {}", 
-				std::to_string(maybeMoveVals.value().TeamPointDelta.at(ArmyColor::Dark)), 
-				std::to_string(maybeMoveVals.value().TeamPointDelta.at(ArmyColor::Light))));
+			const std::string error = std::format("[GAME_MANAGER]: Tried to set the engine time budget of game: {} "
+				"to {}ms but it must be more than 0", gameStateID, totalTime.count());
+			Utils::Log(Utils::LogType::Error, error);
+			return false;
+		}
+
+		m_engineTimeBudgets.insert_or_assign(gameStateID, EngineTimeBudget{ totalTime, increment });
+		return true;
+	}
+
+	std::optional<EngineTimeBudget> GameManager::TryGetEngineTimeBudget(const std::string& gameStateID) const
+	{
+		auto budgetIt = m_engineTimeBudgets.find(gameStateID);
+		if (budgetIt == m_engineTimeBudgets.end()) return std::nullopt;
+		return budgetIt->second;
+	}
 
-			maybeGameState->TeamValue[ArmyColor::Light] += maybeMoveVals.value().TeamPointDelta.at(ArmyColor::Light);
-			maybeGameState->TeamValue[ArmyColor::Dark] += maybeMoveVals.value().TeamPointDelta.at(ArmyColor::Dark);
+	bool GameManager::TrySetEnginePondering(const std::string& gameStateID, const bool isEnabled)
+	{
+		if (!IsValidGameState(TryGetGameStateMutable(gameStateID), std::format("SetEnginePondering(id:{})", gameStateID))) return false;
+
+		if (isEnabled)
+		{
+			m_ponderingGames.insert(gameStateID);
+			return true;
 		}
-		
-		/*if (!maybeMoveVals.has_value())
+
+		m_ponderingGames.erase(gameStateID);
+		m_ponderPredictions.erase(gameStateID);
+		StopPondering(gameStateID);
+		return true;
+	}
+
+	bool GameManager::IsEnginePondering(const std::string& gameStateID) const
+	{
+		return m_ponderingGames.contains(gameStateID);
+	}
+
+	void GameManager::StartPondering(const std::string& gameStateID, const GameState& state)
+	{
+		auto predictionIt = m_ponderPredictions.find(gameStateID);
+		if (predictionIt == m_ponderPredictions.end()) return;
+
+		const PonderPrediction prediction = predictionIt->second;
+		m_ponderPredictions.erase(predictionIt);
+		StopPondering(gameStateID);
+
+		//The reply came from a search of this position so it is only illegal if the game was changed since
+		Board::MoveList legalMoves;
+		Board::GenerateLegalMoves(state, legalMoves);
+		if (!legalMoves.Contains(prediction.Reply)) return;
+
+		//Positions are too large for the stack
+		auto ponderPosition = std::make_unique<GameState>();
+		Engine::CopyPosition(state, *ponderPosition);
+		if (!Board::MakeMove(*ponderPosition, prediction.Reply)) return;
+
+		Engine::SearchLimits ponderLimits = prediction.Limits;
+		ApplyEngineResources(ponderLimits);
+		const bool hasLimit = ponderLimits.Depth > 0 || ponderLimits.Nodes > 0 ||
+			ponderLimits.MoveTime.count() > 0 || ponderLimits.RemainingTime.count() > 0;
+
+		Engine::AnalysisHandle handle = Engine::StartPondering(*ponderPosition, ponderLimits, m_transpositionTable);
+		m_ponderSearches.insert_or_assign(gameStateID, PonderSearch{ ponderPosition->Hash, handle, false, {}, !hasLimit });
+		Utils::Log(std::format("[GAME_MANAGER]: Engine of game: {} is pondering on: {}", gameStateID, 
+			Board::ToCoordinateNotation(prediction.Reply)));
+	}
+
+	void GameManager::ResolvePondering(const std::string& gameStateID, const GameState& state)
+	{
+		auto ponderIt = m_ponderSearches.find(gameStateID);
+		if (ponderIt == m_ponderSearches.end()) return;
+
+		PonderSearch& ponder = ponderIt->second;
+		//A move after a hit means the engine's move was played by someone else so the search is of no use either
+		if (ponder.IsHit || state.Hash != ponder.ExpectedHash)
 		{
-			const std::string error = std::format("Tried to change players turn in "
-				"GameManager but the last move values for color: {} were not found",
-				ToString(maybeGameState->CurrentPlayer));
-			Utils::Log(Utils::LogType::Error, error);
-			return std::nullopt;
+			Utils::Log(std::format("[GAME_MANAGER]: Engine of game: {} missed its ponder move", gameStateID));
+			StopPondering(gameStateID);
+			return;
 		}
-		maybeGameState->TeamValue[ColorTheme::Light] += maybeMoveVals.value().TeamPointDelta.at(ColorTheme::Light);
-		maybeGameState->TeamValue[ColorTheme::Dark] += maybeMoveVals.value().TeamPointDelta.at(ColorTheme::Dark);*/
 
-		ArmyColor otherPlayer = GetOtherPlayer(*maybeGameState);
+		ponder.IsHit = true;
+		ponder.HitTime = std::chrono::steady_clock::now();
+		ponder.Handle.PonderHit();
+		if (ponder.StopsOnHit) ponder.Handle.Stop();
+		Utils::Log(std::format("[GAME_MANAGER]: Engine of game: {} hit its ponder move", gameStateID));
+	}
+
+	void GameManager::StopPondering(const std::string& gameStateID)
+	{
+		auto ponderIt = m_ponderSearches.find(gameStateID);
+		if (ponderIt == m_ponderSearches.end()) return;
 
-		maybeGameState->CurrentPlayer = otherPlayer;
+		ponderIt->second.Handle.Stop();
+		ponderIt->second.Handle.Wait();
+		m_ponderSearches.erase(ponderIt);
+	}
+
+	bool GameManager::TrySetEngineHashSize(const size_t megabytes)
+	{
+		StopAllAnalyses();
+		return m_transpositionTable.TryResize(megabytes);
+	}
+
+	void GameManager::ClearEngineHash()
+	{
+		StopAllAnalyses();
+		m_transpositionTable.Clear();
+	}
+
+	bool GameManager::TryLoadEngineNetwork(const std::string& path)
+	{
+		StopAllAnalyses();
+		m_winProbability.Cancel();
+		if (!m_engineNetwork.TryLoad(path)) return false;
+		//Stored scores came from the old evaluation so they would not agree with the new one
+		m_transpositionTable.Clear();
+		m_winProbability.Clear();
+		return true;
+	}
+
+	bool GameManager::TryLoadTablebases(const std::string& directory)
+	{
+		StopAllAnalyses();
+		m_winProbability.Cancel();
+		if (!m_tablebases.TryLoad(directory)) return false;
+
+		Utils::Log(std::format("[GAME_MANAGER]: Loaded {} tablebases from: {}", m_tablebases.GetTableCount(), directory));
+		return true;
+	}
+
+	bool GameManager::TryLoadOpeningBook(const std::string& path)
+	{
+		//Only engine moves on this thread pick from the book so nothing has to be stopped
+		if (!m_openingBook.TryLoad(path)) return false;
+
+		Utils::Log(std::format("[GAME_MANAGER]: Loaded the opening book with {} entries from: {}", m_openingBook.GetEntryCount(), path));
+		return true;
+	}
+
+	void GameManager::ApplyEngineResources(Engine::SearchLimits& limits) const
+	{
+		if (limits.Network == nullptr && m_engineNetwork.IsLoaded()) limits.Network = &m_engineNetwork;
+		if (limits.Tablebases == nullptr && m_tablebases.GetTableCount() > 0) limits.Tablebases = &m_tablebases;
+	}
+
+	Engine::AnalysisHandle GameManager::StartAnalysis(const std::string& gameStateID, const Engine::SearchLimits& limits,
+		const Engine::AnalysisCallback& callback)
+	{
+		GameState* maybeGameState = TryGetGameStateMutable(gameStateID);
+		if (!IsValidGameState(maybeGameState, std::format("StartAnalysis(id:{})", gameStateID))) return {};
+
+		StopAnalysis(gameStateID);
+		Engine::SearchLimits analysisLimits = limits;
+		ApplyEngineResources(analysisLimits);
+
+		Engine::AnalysisHandle handle = Engine::StartAnalysis(*maybeGameState, analysisLimits, m_transpositionTable, callback);
+		m_analyses.insert_or_assign(gameStateID, handle);
+		return handle;
+	}
+
+	void GameManager::StopAnalysis(const std::string& gameStateID)
+	{
+		auto analysisIt = m_analyses.find(gameStateID);
+		if (analysisIt == m_analyses.end()) return;
+
+		//Waiting is short since the search stops at its next limit check, and afterwards nothing else uses the table
+		analysisIt->second.Stop();
+		analysisIt->second.Wait();
+		m_analyses.erase(analysisIt);
+	}
+
+	void GameManager::StopAllAnalyses()
+	{
+		while (!m_analyses.empty()) StopAnalysis(m_analyses.begin()->first);
+		while (!m_ponderSearches.empty()) StopPondering(m_ponderSearches.begin()->first);
+		while (!m_candidateSearches.empty()) StopCandidateSearch(m_candidateSearches.begin()->first);
+		while (!m_engineMoveSearches.empty()) StopEngineMove(m_engineMoveSearches.begin()->first);
+	}
+
+	std::vector<MoveInfo> GameManager::TryGetPossibleMovesForPieceAt(const std::string& gameStateID, const Utils::Point2DInt& pos)
+	{
+		GameState* maybeGameState = TryGetGameStateMutable(gameStateID);
+		//Utils::Log(std::format("Try get possible moves game manager has state: {}", std::to_string(maybeGameState!=nullptr)));
+		if (!IsValidGameState(maybeGameState, std::format("GetPossibleMoves(id:{})", gameStateID)))
+		{
+			return {};
+		}
+		return Board::GetPossibleMovesForPieceAt(*maybeGameState, pos);
+	}
+
+	int GameManager::GetTeamPoints(const GameState& state, const ArmyColor color) const
+	{
+		//The material is kept up to date by every move so this does not need to look at the previous moves
+		return Engine::GetMaterialAdvantage(state, color) / Engine::GetPieceValue(PieceType::Pawn);
+	}
+
+	std::optional<ArmyColor> GameManager::TryAdvanceTurn(const std::string& gameStateID)
+	{
+		if (!ADVANCE_TURN) return std::nullopt;
+
+		GameState* maybeGameState = TryGetGameStateMutable(gameStateID);
+		if (!IsValidGameState(maybeGameState, std::format("AdvanceTurn(id:{})", gameStateID))) return std::nullopt;
+
+		//The move already passed the turn to the other player so only what follows a turn is left to do.
+		//The turn passing to the opponent of the engine is when it starts thinking on their time
+		StartPondering(gameStateID, *maybeGameState);
+		RequestWinProbability(*maybeGameState);
 		InvokeEvent(*maybeGameState, GameEventType::SuccessfulTurn);
 		if (maybeGameState->InCheckmate || Board::GetAvailablePieces(*maybeGameState, maybeGameState->CurrentPlayer) == 0)
 			EndGame(*maybeGameState);
@@ -265,32 +631,43 @@ namespace Core
 		}
 	}
 
-	std::unordered_map<ArmyColor, float> GameManager::CalculateWinPercentage(const GameState& state) const
+	float GameManager::CalculateWinProbability(const GameState& state, const ArmyColor color) const
 	{
-		if (state.TeamValue.at(ArmyColor::Dark) == state.TeamValue.at(ArmyColor::Light)) 
-			return { {ArmyColor::Light, 0.5, }, {ArmyColor::Dark, 0.5} };
-
-		ArmyColor smallerScoreColor = state.TeamValue.at(ArmyColor::Light) < state.TeamValue.at(ArmyColor::Dark) ?
-										ArmyColor::Light : ArmyColor::Dark;
-		ArmyColor greaterScoreColor= GetOtherTeam(smallerScoreColor);
+		std::optional<Engine::WinProbability> searched = m_winProbability.TryGetCached(state.Hash);
+		float lightProbability = 0;
+		if (searched.has_value()) lightProbability = searched->Light;
+		else
+		{
+			const int score = Engine::Evaluate(state);
+			lightProbability = Engine::ToWinProbability(state.CurrentPlayer == ArmyColor::Light ? score : -score);
+		}
+		return color == ArmyColor::Light ? lightProbability : 1 - lightProbability;
+	}
 
-		int smallestScore = state.TeamValue.at(smallerScoreColor);
-		int smallestScoreDelta = 0;
-		if (smallestScore < 0) smallestScoreDelta = std::abs(smallestScore) - smallestScore;
+	void GameManager::AddWinProbabilityCallback(const Engine::WinProbabilityCallback& callback)
+	{
+		m_winProbabilityListeners.push_back(callback);
+	}
 
-		int greaterScore = state.TeamValue.at(greaterScoreColor);
+	void GameManager::StopWinProbability()
+	{
+		m_winProbability.Cancel();
+	}
 
-		std::unordered_map<ArmyColor, float> colorPercent = {};
-		smallestScore += smallestScoreDelta;
-		greaterScore += smallestScoreDelta;
-		colorPercent.emplace(smallerScoreColor, (float)(smallestScore)/(smallestScore + greaterScore));
-		colorPercent.emplace(greaterScoreColor, (float)(greaterScore)/(smallestScore + greaterScore));
-		Utils::Log(Utils::LogType::Error, std::format("calc win percent: l:{} d:{} small: {} greater: {}", 
-			std::to_string(colorPercent.at(ArmyColor::Light)), 
-			std::to_string(colorPercent.at(ArmyColor::Dark)),
-			std::to_string(smallestScore), 
-			std::to_string(greaterScore)));
-		return colorPercent; 
+	void GameManager::RequestWinProbability(const GameState& state)
+	{
+		if (m_winProbabilityListeners.empty()) return;
+
+		Engine::SearchLimits limits = {};
+		limits.Depth = WIN_PROBABILITY_DEPTH;
+		limits.MoveTime = WIN_PROBABILITY_TIME;
+		ApplyEngineResources(limits);
+
+		//The listeners are copied since the callback runs on the worker thread while more could be added
+		m_winProbability.Request(state, limits, [listeners = m_winProbabilityListeners](const Engine::WinProbability& probability) -> void
+			{
+				for (const auto& listener : listeners) listener(probability);
+			});
 	}
 
 	void GameManager::InvokeEvent(const GameState& state, const GameEventType gameEvent)
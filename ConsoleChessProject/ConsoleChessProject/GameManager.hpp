@@ -1,15 +1,30 @@
 #pragma once
 #include <unordered_map>
+#include <unordered_set>
 #include <functional>
 #include <string>
 #include <vector>
 #include <optional>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <atomic>
+#include <future>
 #include "Color.hpp"
 #include "Event.hpp"
 #include "GameState.hpp"
 #include "BoardManager.hpp"
 #include "Point2DInt.hpp"
 #include "PieceMoveResult.hpp"
+#include "Search.hpp"
+#include "TranspositionTable.hpp"
+#include "Nnue.hpp"
+#include "Tablebase.hpp"
+#include "OpeningBook.hpp"
+#include "Analysis.hpp"
+#include "WinProbability.hpp"
+#include "Move.hpp"
+#include "Zobrist.hpp"
 
 namespace Core
 {
@@ -32,11 +47,94 @@ namespace Core
 		StartGame,
 		PieceMoved,
 		SuccessfulTurn,
+		MoveUndone,
 	};
 
-	struct MoveValueInfo
+	/// <summary>
+	/// The clock the engine plays on in a game, so every engine move gets a share of it
+	/// instead of searching for as long as it likes
+	/// </summary>
+	struct EngineTimeBudget
 	{
-		std::unordered_map<ArmyColor, int> TeamPointDelta;
+		std::chrono::milliseconds RemainingTime;
+		std::chrono::milliseconds Increment;
+	};
+
+	/// <summary>
+	/// The reply the engine expects to its last move, kept until the turn passes to the opponent
+	/// </summary>
+	struct PonderPrediction
+	{
+		Board::Move Reply;
+		//The limits of the engine move it comes from (with the clock left after that move)
+		Engine::SearchLimits Limits;
+	};
+
+	/// <summary>
+	/// A search of the position after the predicted reply that runs while the opponent thinks
+	/// </summary>
+	struct PonderSearch
+	{
+		//Hash of the position after the predicted reply so the reply that is actually played can be matched to it
+		Board::ZobristKey ExpectedHash;
+		Engine::AnalysisHandle Handle;
+		//Set once the opponent plays the predicted reply (the search then runs on the engine's own time)
+		bool IsHit;
+		std::chrono::steady_clock::time_point HitTime;
+		//With no depth, node or time limit the search would never end by itself so a hit stops it
+		bool StopsOnHit;
+	};
+		
+	/// <summary>
+	/// The move the engine picked for a game's position
+	/// </summary>
+	struct EngineMove
+	{
+		//Hash of the position the move is for so a move that arrives after the game has changed is not played
+		Board::ZobristKey Hash;
+		Engine::SearchResult Result;
+		//Taken off the engine's clock (after a ponder hit only the time since the hit)
+		std::chrono::duration<double> SearchTime;
+	};
+	using EngineMoveCallback = std::function<void(const EngineMove& move)>;
+
+	/// <summary>
+	/// An engine move being picked on a worker thread, from the book or tablebases, a ponder search or its own search
+	/// </summary>
+	struct EngineMoveSearch
+	{
+		Board::ZobristKey Hash;
+		//The limits with the clock and engine resources applied (the ponder search after the move uses them too)
+		Engine::SearchLimits Limits;
+		bool UsesBudget;
+		//Set after a ponder hit, whose search then gives the move
+		Engine::AnalysisHandle PonderHandle;
+		std::unique_ptr<std::atomic<bool>> StopSignal;
+		std::shared_future<EngineMove> Result;
+		//Declared last so it is destroyed first, which waits for the worker to be done with the signal
+		std::future<void> Worker;
+	};
+
+	/// <summary>
+	/// The best lines of a game's position, best first, from a candidate move search
+	/// </summary>
+	struct CandidateMoves
+	{
+		//Hash of the searched position so lines that arrive after the game has moved on can be told apart
+		Board::ZobristKey Hash;
+		std::vector<Engine::SearchResult> Lines;
+	};
+	using CandidateMovesCallback = std::function<void(const CandidateMoves& moves)>;
+
+	/// <summary>
+	/// A candidate move search running on a worker thread on its own copy of the game's position
+	/// </summary>
+	struct CandidateSearch
+	{
+		std::unique_ptr<GameState> Position;
+		std::unique_ptr<std::atomic<bool>> StopSignal;
+		//Declared last so it is destroyed first, which waits for the worker to be done with the position and signal
+		std::future<void> Worker;
 	};
 		
 	class GameManager
@@ -47,6 +145,29 @@ namespace Core
 		/// </summary>
 		GameStateCollectionType m_allGameStates;
 		std::unordered_map<GameEventType, std::vector<GameEventCallbackType>> m_eventListeners;
+		std::unordered_map<std::string, EngineTimeBudget> m_engineTimeBudgets;
+		std::unordered_set<std::string> m_ponderingGames;
+		std::unordered_map<std::string, PonderPrediction> m_ponderPredictions;
+		//Shared by every game's engine searches (entries of other games age out as new searches store theirs)
+		Engine::TranspositionTable m_transpositionTable;
+		//Engine searches evaluate with this instead of the classical evaluation once it is loaded
+		Engine::NnueNetwork m_engineNetwork;
+		//Engine searches take the score of the endings in these from them and engine moves in them are not searched at all
+		Engine::Tablebase m_tablebases;
+		//Engine moves in the positions of this are picked from it before anything is searched
+		Engine::OpeningBook m_openingBook;
+		//Decides which of the book moves of a position is played
+		std::mt19937_64 m_bookRandom;
+		//The latest analysis of each game. Declared after the table, network and tablebases so the analyses are stopped before those are destroyed
+		std::unordered_map<std::string, Engine::AnalysisHandle> m_analyses;
+		//Same as the analyses: the ponder searches must stop before the table and network are destroyed
+		std::unordered_map<std::string, PonderSearch> m_ponderSearches;
+		//Same as the analyses
+		std::unordered_map<std::string, CandidateSearch> m_candidateSearches;
+		std::unordered_map<std::string, EngineMoveSearch> m_engineMoveSearches;
+		//Its searches may use the network so it is declared after it too
+		Engine::WinProbabilityService m_winProbability;
+		std::vector<Engine::WinProbabilityCallback> m_winProbabilityListeners;
 
 	public:
 		static constexpr bool ADVANCE_TURN = true;
@@ -66,6 +187,20 @@ namespace Core
 		
 		void EndGame(GameState& state);
 		void InvokeEvent(const GameState& state, const GameEventType gameEvent);
+		void StopAllAnalyses();
+		//Gives the limits the network and tablebases when they are loaded and the limits do not have their own
+		void ApplyEngineResources(Engine::SearchLimits& limits) const;
+
+		void StartPondering(const std::string& gameStateID, const GameState& state);
+		/// <summary>
+		/// Matches the move that was just played against the game's ponder search. A hit lets the search continue on
+		/// the engine's time and a miss stops it (what it stored in the table is still used by the next engine search)
+		/// </summary>
+		/// <param name="gameStateID"></param>
+		/// <param name="state"></param>
+		void ResolvePondering(const std::string& gameStateID, const GameState& state);
+		void StopPondering(const std::string& gameStateID);
+		void RequestWinProbability(const GameState& state);
 
 	public:
 		GameManager();
@@ -75,8 +210,8 @@ namespace Core
 		bool IsPositionWithinBounds(const Utils::Point2DInt& pos) const;
 
 		/// <summary>
-		/// Makes the necesssary changes to the game state to advance turn
-		/// and returns the new player's turn
+		/// Makes the necesssary changes to the game state to advance turn after a move 
+		/// (which already gave the turn to the other player) and returns the new player's turn
 		/// </summary>
 		/// <param name="gameStateID"></param>
 		/// <returns></returns>
@@ -85,18 +220,162 @@ namespace Core
 		PieceMoveResult TryMoveForState(const std::string& gameStateID,
 			const Utils::Point2DInt& currentPos, const Utils::Point2DInt& newPos);
 
+		/// <summary>
+		/// Takes back the last move of the game (see Board::TryUndoMove) so it is the turn of the player that made it again.
+		/// The engine's move search, ponder search and prediction are dropped since they were for a position that is no longer in the game
+		/// </summary>
+		/// <param name="gameStateID"></param>
+		/// <returns></returns>
+		PieceMoveResult TryUndoMove(const std::string& gameStateID);
+
+		/// <summary>
+		/// Starts picking the best move of the current player within the limits on a worker thread and returns right away.
+		/// The callback gets the move on the worker thread (so it should only hand it over to the thread that plays it 
+		/// with TryPlayEngineMove) and the returned future is ready with it after that. 
+		/// If the game has an engine time budget and the limits have no time of their own, the search uses the budget's clock.
+		/// After a ponder hit the move comes from the ponder search (which used the limits of the previous engine move).
+		/// A game has one engine move search at a time so starting one stops the one before it
+		/// </summary>
+		/// <param name="gameStateID"></param>
+		/// <param name="limits"></param>
+		/// <param name="callback"></param>
+		/// <returns></returns>
+		std::shared_future<EngineMove> StartEngineMove(const std::string& gameStateID, const Engine::SearchLimits& limits,
+			const EngineMoveCallback& callback);
+		/// <summary>
+		/// Plays the move of the game's engine move search like TryMoveForState (so the turn still needs to be advanced after)
+		/// and takes the time spent off the engine's clock. Fails if the game has changed since the search started
+		/// </summary>
+		/// <param name="gameStateID"></param>
+		/// <param name="move"></param>
+		/// <returns></returns>
+		PieceMoveResult TryPlayEngineMove(const std::string& gameStateID, const EngineMove& move);
+		/// <summary>
+		/// Stops the game's engine move search without playing its move and waits until its callback is done
+		/// </summary>
+		/// <param name="gameStateID"></param>
+		void StopEngineMove(const std::string& gameStateID);
+
+		/// <summary>
+		/// Starts finding the best lines of the current player for up to lineCount different moves (see Engine::SearchMultiPv)
+		/// on a worker thread and returns right away. The callback gets the lines on the worker thread (so it should only hand them
+		/// over to the thread that shows them) with the hash of the searched position, which no longer matches the game once it moves on.
+		/// A game has one candidate search at a time so starting one stops the one before it.
+		/// Nothing is played and the engine time budget is not used
+		/// </summary>
+		/// <param name="gameStateID"></param>
+		/// <param name="limits"></param>
+		/// <param name="lineCount"></param>
+		/// <param name="callback"></param>
+		void StartCandidateSearch(const std::string& gameStateID, const Engine::SearchLimits& limits, 
+			const int lineCount, const CandidateMovesCallback& callback);
+		/// <summary>
+		/// Stops the game's candidate search and waits until its callback is done (for before the listener is destroyed)
+		/// </summary>
+		/// <param name="gameStateID"></param>
+		void StopCandidateSearch(const std::string& gameStateID);
+
+		/// <summary>
+		/// Gives the engine a clock for the game so engine moves have a bounded search time
+		/// </summary>
+		/// <param name="gameStateID"></param>
+		/// <param name="totalTime"></param>
+		/// <param name="increment"></param>
+		/// <returns></returns>
+		bool TrySetEngineTimeBudget(const std::string& gameStateID, const std::chrono::milliseconds totalTime, 
+			const std::chrono::milliseconds increment);
+		std::optional<EngineTimeBudget> TryGetEngineTimeBudget(const std::string& gameStateID) const;
+
+		/// <summary>
+		/// With pondering on, once the turn passes from an engine move to the opponent the engine keeps searching 
+		/// the position after the reply it expects. If that reply is played the next engine move comes from that search
+		/// (right away if it has already used the move's time) and otherwise the search is stopped
+		/// </summary>
+		/// <param name="gameStateID"></param>
+		/// <param name="isEnabled"></param>
+		/// <returns></returns>
+		bool TrySetEnginePondering(const std::string& gameStateID, const bool isEnabled);
+		bool IsEnginePondering(const std::string& gameStateID) const;
+
+		/// <summary>
+		/// Resizes the engine's transposition table (which clears it). Must not be called during an engine move search
+		/// </summary>
+		/// <param name="megabytes"></param>
+		/// <returns></returns>
+		bool TrySetEngineHashSize(const size_t megabytes);
+		void ClearEngineHash();
+
+		/// <summary>
+		/// Loads the network engine moves are evaluated with (see Nnue.hpp for the file layout).
+		/// Must not be called during an engine move search
+		/// </summary>
+		/// <param name="path"></param>
+		/// <returns></returns>
+		bool TryLoadEngineNetwork(const std::string& path);
+
+		/// <summary>
+		/// Maps the endgame tables in the directory (see Tablebase.hpp), which searches then probe and engine moves
+		/// are picked from directly. Must not be called during an engine move search
+		/// </summary>
+		/// <param name="directory"></param>
+		/// <returns></returns>
+		bool TryLoadTablebases(const std::string& directory);
+
+		/// <summary>
+		/// Maps the opening book file (see OpeningBook.hpp). Engine moves in its positions are then one of its moves
+		/// picked by weight instead of a search
+		/// </summary>
+		/// <param name="path"></param>
+		/// <returns></returns>
+		bool TryLoadOpeningBook(const std::string& path);
+
+		/// <summary>
+		/// Starts searching the current position of the game on a worker thread and returns right away. 
+		/// Each completed depth is queued on the handle and the callback is then called on the worker thread
+		/// (so it should only wake up the thread that drains the handle). A game has one analysis at a time
+		/// so starting one stops the analysis of the game before it. 
+		/// Changing the engine hash or network stops every analysis first
+		/// </summary>
+		/// <param name="gameStateID"></param>
+		/// <param name="limits"></param>
+		/// <param name="callback"></param>
+		/// <returns></returns>
+		Engine::AnalysisHandle StartAnalysis(const std::string& gameStateID, const Engine::SearchLimits& limits, 
+			const Engine::AnalysisCallback& callback);
+		void StopAnalysis(const std::string& gameStateID);
+
 		std::vector<MoveInfo> TryGetPossibleMovesForPieceAt(const std::string& gameStateID, const Utils::Point2DInt& pos);
-		std::optional<MoveValueInfo> TryCalculateLastMoveValue(const std::string& gameStateID, const ArmyColor colorMoves);
 		size_t TotalGameStatesCount() const;
 
 		/// <summary>
-		/// Will calculate winning percent as something like 99.9%
+		/// Returns the points (in piece values like 1 for a pawn) the color is ahead in material (negative when behind)
 		/// </summary>
 		/// <param name="state"></param>
 		/// <param name="color"></param>
 		/// <returns></returns>
-		std::unordered_map<ArmyColor, float> CalculateWinPercentage(const GameState& state) const;
+		int GetTeamPoints(const GameState& state, const ArmyColor color) const;
+
+		/// <summary>
+		/// Returns the chance (from 0 to 1) the color wins from the search of the position if one was done,
+		/// and otherwise from its static evaluation. Never waits on a search
+		/// </summary>
+		/// <param name="state"></param>
+		/// <param name="color"></param>
+		/// <returns></returns>
+		float CalculateWinProbability(const GameState& state, const ArmyColor color) const;
 
 		void AddEventCallback(const GameEventType& eventType, const GameEventCallbackType& callback);
+
+		/// <summary>
+		/// After each successful turn a short search estimates the win chances of the new position on a worker thread,
+		/// and the callback gets the result on that thread (so it should only hand it over to the thread that shows it).
+		/// Callbacks added later only get the results of turns after that
+		/// </summary>
+		/// <param name="callback"></param>
+		void AddWinProbabilityCallback(const Engine::WinProbabilityCallback& callback);
+		/// <summary>
+		/// Stops the current win probability search and waits until no callback is running (for before the listeners are destroyed)
+		/// </summary>
+		void StopWinProbability();
 	};
 }
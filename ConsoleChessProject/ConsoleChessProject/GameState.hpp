@@ -4,10 +4,14 @@
 #include <array>
 #include <vector>
 #include <optional>
+#include <cstdint>
 #include "Point2DInt.hpp"
 #include "Piece.hpp"
 #include "Color.hpp"
 #include "Globals.hpp"
+#include "Bitboard.hpp"
+#include "Move.hpp"
+#include "PieceSquareTables.hpp"
 
 enum class SpecialMove : unsigned int
 {
@@ -92,17 +96,57 @@ public:
 	MoveInfo& operator=(const MoveInfo& otherInfo) noexcept;
 };
 
+/// <summary>
+/// Everything MakeMove can not recover from the move itself, so UnmakeMove can restore the position
+/// </summary>
+struct StateInfo
+{
+	Board::Move MovePlayed;
+	Board::PieceCode CapturedCode;
+	Piece* CapturedPiece;
+	//The pawn that was replaced by a promotion (so it is put back on unmake)
+	Piece* PromotedPawn;
+	Board::CastlingRights CastlingRights;
+	Board::Square EnPassantSquare;
+	Board::Bitboard Checkers;
+	std::uint64_t Hash;
+	Board::EvaluationScore Evaluation;
+};
+
+//Games longer than this drop their oldest moves (see Board::TryMove) and searches copy only 
+//the latest moves of a game so their own plies always fit on top of them
+constexpr size_t MAX_STATE_HISTORY = 1024;
+
 using PiecePositionMapType = std::unordered_map<Utils::Point2DInt, Piece*>;
 struct GameState
 {
 	ArmyColor CurrentPlayer = ArmyColor::Light;
-	std::unordered_map<ArmyColor, int> TeamValue = {};
 
 	//TODO: maybe create general all peices list and then have separate for in play and captured
 	std::vector<Piece> AllPieces = {};
+
+	//The main position store that all board queries run on
+	Board::BitboardSet Bitboards = {};
+	//Compatibility view of the in play pieces for map based callers (like the UI). 
+	//It is kept in sync by the board manager whenever a piece is created, moved or captured
 	PiecePositionMapType InPlayPieces = {};
 	std::vector<Piece*> CapturedPieces = {};
 
+	//Rights are only lost (by moving the king or rook) and the en passant square is the square 
+	//a pawn skipped over with a double push on the last move (or NO_SQUARE if there was none)
+	Board::CastlingRights CastlingRights = Board::NO_CASTLING;
+	Board::Square EnPassantSquare = Board::NO_SQUARE;
+	//Pieces giving check to the king of the player to move
+	Board::Bitboard Checkers = Board::EMPTY_BITBOARD;
+	//Zobrist key of the position (see Zobrist.hpp) that MakeMove/UnmakeMove keep up to date
+	std::uint64_t Hash = 0;
+	//Material and piece-square scores (see PieceSquareTables.hpp) that MakeMove/UnmakeMove keep up to date
+	Board::EvaluationScore Evaluation = {};
+
+	//Undo stack for MakeMove/UnmakeMove with one entry per move made
+	std::array<StateInfo, MAX_STATE_HISTORY> StateHistory = {};
+	size_t StateHistoryCount = 0;
+
 	std::unordered_map<ArmyColor, std::vector<MoveInfo>> PreviousMoves = {};
 
 	bool InCheckmate = false;
@@ -13,8 +13,11 @@
 #include "HelperFunctions.hpp"
 #include "StringUtil.hpp"
 
-
+//Logs go to wxWidgets by default. The headless tools (like perft and bench) define CONSOLE_LOGGING in their targets
+//so they log to the console and do not need wxWidgets to build, which is also the fallback where wxWidgets is not available
+#if !defined(CONSOLE_LOGGING) && __has_include(<wx/wx.h>)
 #define LOG_WX_WIDGETS
+#endif
 
 #ifdef LOG_WX_WIDGETS
 #include <wx/wx.h>
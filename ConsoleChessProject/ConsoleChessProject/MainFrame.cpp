@@ -3,6 +3,8 @@
 #include <wx/simplebook.h>
 #include <wx/popupwin.h>
 #include <functional>
+#include <chrono>
+#include <vector>
 #include <format>
 #include <string>
 #include "MainFrame.hpp"
@@ -18,8 +20,23 @@
 #include "DirectionalLayout.hpp"
 #include "ThemeControllerUI.hpp"
 #include "ConfirmPopup.hpp"
+#include "Analysis.hpp"
+#include "Search.hpp"
+#include "MoveGeneration.hpp"
+
+wxDEFINE_EVENT(EVT_ANALYSIS_UPDATE, wxThreadEvent);
+wxDEFINE_EVENT(EVT_TOP_MOVES_UPDATE, wxThreadEvent);
+wxDEFINE_EVENT(EVT_ENGINE_MOVE, wxThreadEvent);
 
 static const std::string GAME_STATE_ID = "main_state";
+//The position is analysed for this long after every turn so the engine does not keep a core busy forever
+static constexpr std::chrono::milliseconds ANALYSIS_TIME{ 10000 };
+//Each top move line only gets a short search so the moves show up soon after they are asked for
+static constexpr int TOP_MOVE_COUNT = 3;
+static constexpr std::chrono::milliseconds TOP_MOVE_LINE_TIME{ 300 };
+//The clock the engine plays on against the player
+static constexpr std::chrono::milliseconds ENGINE_CLOCK_TIME{ 5 * 60 * 1000 };
+static constexpr std::chrono::milliseconds ENGINE_CLOCK_INCREMENT{ 3000 };
 
 static constexpr int TITLE_Y_OFFSET = 50;
 static constexpr int BUTTON_START_Y = 150;
@@ -29,8 +46,20 @@ static constexpr int BUTTON_SPACING = 70;
 
 MainFrame::MainFrame(Core::GameManager& gameManager, const wxString& title)
 	: wxFrame(nullptr, wxID_ANY, title), WindowName(title), m_manager(gameManager), 
-	m_currentState(nullptr), m_popup(this)
+	m_currentState(nullptr), m_popup(this), m_analysisText(nullptr), m_analysis(), m_analysisColor(ArmyColor::Light), 
+	m_engineColor(std::nullopt)
 {
+	Bind(EVT_ANALYSIS_UPDATE, &MainFrame::OnAnalysisUpdate, this);
+	Bind(EVT_TOP_MOVES_UPDATE, &MainFrame::OnTopMovesUpdate, this);
+	Bind(EVT_ENGINE_MOVE, &MainFrame::OnEngineMove, this);
+	m_manager.AddEventCallback(Core::GameEventType::SuccessfulTurn, [this](const GameState& state) -> void 
+		{
+			//The engine starts after the ui is done with the turn so the pieces it disables are not enabled again by it
+			if (m_engineColor.has_value() && state.CurrentPlayer == m_engineColor.value()) CallAfter([this]() -> void { StartEngineTurn(); });
+			else StartAnalysis();
+		});
+	m_manager.AddEventCallback(Core::GameEventType::MoveUndone, [this](const GameState& state) -> void { StartAnalysis(); });
+
 	DrawStatic();
 	DrawMainMenu();
 	DrawGame();
@@ -42,6 +71,15 @@ MainFrame::MainFrame(Core::GameManager& gameManager, const wxString& title)
 		std::to_string(_manager.TotalGameStatesCount())));*/
 }
 
+MainFrame::~MainFrame()
+{
+	//Stopping waits for the analysis, candidate and engine move search threads so they can not queue events to the frame once it is gone
+	m_manager.StopAnalysis(GAME_STATE_ID);
+	m_manager.StopCandidateSearch(GAME_STATE_ID);
+	m_manager.StopEngineMove(GAME_STATE_ID);
+	m_manager.StopWinProbability();
+}
+
 void MainFrame::DrawStatic()
 {
 	this->SetBackgroundColour(wxColour(BACKGROUND_COLOR));
@@ -73,14 +111,19 @@ void MainFrame::DrawMainMenu()
 
 	//mainMenuSizer->Add(newGameButton);
 
+	CButton* engineGameButton = new CButton(mainMenuRoot, "Play Engine");
+	CenterX(engineGameButton);
+	engineGameButton->MoveY(BUTTON_START_Y + BUTTON_SPACING);
+	engineGameButton->Bind(wxEVT_BUTTON, [this](wxCommandEvent& evt) -> void {StartGame(ArmyColor::Dark); });
+
 	CButton* rulesButton = new CButton(mainMenuRoot, "Rules");
 	CenterX(rulesButton);
-	rulesButton->MoveY(BUTTON_START_Y + BUTTON_SPACING);
+	rulesButton->MoveY(BUTTON_START_Y + 2 * BUTTON_SPACING);
 	//mainMenuSizer->Add(rulesButton);
 
 	CButton* settingsButton = new CButton(mainMenuRoot, "Settings");
 	CenterX(settingsButton);
-	settingsButton->MoveY(BUTTON_START_Y + 2 * BUTTON_SPACING);
+	settingsButton->MoveY(BUTTON_START_Y + 3 * BUTTON_SPACING);
 	//mainMenuSizer->Add(mainMenuRoot);
 
 	wxLogMessage("Draw Main Menu");
@@ -134,6 +177,19 @@ void MainFrame::DrawGame()
 		});
 
 	leftLayout->AddChild(quitButton, 0, SPACING_ALL_SIDES, 10);
+
+	CButton* topMovesButton = new CButton(leftLayout, "Top Moves", wxDefaultPosition, wxSize(leftSidePanel->GetSize().x, 30));
+	topMovesButton->AddOnClickAction([this](wxCommandEvent& evt) -> void { ShowTopMoves(); });
+	leftLayout->AddChild(topMovesButton, 0, SPACING_ALL_SIDES, 10);
+
+	CButton* undoButton = new CButton(leftLayout, "Undo Move", wxDefaultPosition, wxSize(leftSidePanel->GetSize().x, 30));
+	undoButton->AddOnClickAction([this](wxCommandEvent& evt) -> void { UndoMove(); });
+	leftLayout->AddChild(undoButton, 0, SPACING_ALL_SIDES, 10);
+
+	m_analysisText = new wxStaticText(leftLayout, wxID_ANY, "", wxDefaultPosition, wxSize(leftSidePanel->GetSize().x, 120));
+	m_analysisText->SetForegroundColour(NORMAL_GRAY);
+	m_analysisText->Wrap(leftSidePanel->GetSize().x);
+	leftLayout->AddChild(m_analysisText, 0, SPACING_ALL_SIDES, 10);
 	/*CreateThemeController(leftSidePanel);*/
 
 	m_cellParent = new wxPanel(gameRoot, wxID_ANY, wxDefaultPosition, cellAreaSize);
@@ -186,7 +242,7 @@ bool MainFrame::TryUpdateBoard()
 	return TryRenderAllPieces(m_manager, *m_currentState);
 }
 
-void MainFrame::StartGame()
+void MainFrame::StartGame(const std::optional<ArmyColor>& engineColor)
 {
 	wxLogMessage("Pointer value ADDRESS GAME MANAGER LATER: %p", &m_manager);
 	Utils::Log(std::format("Start game on main frame. Current game states: {}", std::to_string(m_manager.TotalGameStatesCount())));
@@ -201,6 +257,13 @@ void MainFrame::StartGame()
 	}
 	//std::string str = "State of Game: "+_currentState.value().ToString();
 	//Utils::Log(Utils::LogType::Warning, str);
+	m_engineColor = engineColor;
+	if (m_engineColor.has_value())
+	{
+		m_manager.TrySetEngineTimeBudget(GAME_STATE_ID, ENGINE_CLOCK_TIME, ENGINE_CLOCK_INCREMENT);
+		m_manager.TrySetEnginePondering(GAME_STATE_ID, true);
+	}
+
 	BindCellEventsForGameState(m_manager, GAME_STATE_ID);
 	TogglePage(Page::Game);
 	const std::string message = std::format("A total of pieces START GAME: {}", std::to_string(m_currentState->InPlayPieces.size()));
@@ -211,6 +274,8 @@ void MainFrame::StartGame()
 		Utils::Log(Utils::LogType::Error, err);
 	}
 	UpdateInteractablePieces(m_currentState->CurrentPlayer);
+	if (m_engineColor.has_value() && m_currentState->CurrentPlayer == m_engineColor.value()) StartEngineTurn();
+	else StartAnalysis();
 	
 	
 	//TODO: function listeners adding crashes app!
@@ -227,3 +292,128 @@ void MainFrame::StartGame()
 		});*/
 }
 
+void MainFrame::StartAnalysis()
+{
+	if (m_currentState == nullptr) return;
+
+	Engine::SearchLimits limits;
+	limits.MoveTime = ANALYSIS_TIME;
+	m_analysisColor = m_currentState->CurrentPlayer;
+	//The callback runs on the analysis thread so it only queues an event for the ui thread to drain the handle
+	m_analysis = m_manager.StartAnalysis(GAME_STATE_ID, limits, [this](const Engine::SearchProgress& progress) -> void
+		{
+			wxQueueEvent(this, new wxThreadEvent(EVT_ANALYSIS_UPDATE));
+		});
+}
+
+void MainFrame::ShowTopMoves()
+{
+	if (m_currentState == nullptr) return;
+
+	Engine::SearchLimits limits;
+	limits.MoveTime = TOP_MOVE_LINE_TIME;
+	//The callback runs on the search thread so the moves are queued for the ui thread to show
+	m_manager.StartCandidateSearch(GAME_STATE_ID, limits, TOP_MOVE_COUNT, [this](const Core::CandidateMoves& moves) -> void
+		{
+			wxThreadEvent* evt = new wxThreadEvent(EVT_TOP_MOVES_UPDATE);
+			evt->SetPayload(moves);
+			wxQueueEvent(this, evt);
+		});
+}
+
+void MainFrame::OnTopMovesUpdate(wxThreadEvent& evt)
+{
+	//A move made while the search ran means the lines are for a position that is no longer on the board
+	const Core::CandidateMoves moves = evt.GetPayload<Core::CandidateMoves>();
+	if (m_currentState == nullptr || moves.Hash != m_currentState->Hash) return;
+	ShowCandidateMoves(moves.Lines);
+}
+
+void MainFrame::UndoMove()
+{
+	if (m_currentState == nullptr) return;
+
+	const PieceMoveResult result = m_manager.TryUndoMove(GAME_STATE_ID);
+	if (!result.IsValidMove)
+	{
+		Utils::Log(Utils::LogType::Warning, std::format("Tried to undo a move in main frame but failed! Info: {}", result.Info));
+		return;
+	}
+
+	if (!TryRenderBoardChange(m_manager, *m_currentState, result.AttemptedPositions))
+	{
+		const std::string err = std::format("Tried to render the undone move but failed!");
+		Utils::Log(Utils::LogType::Error, err);
+	}
+	UpdateInteractablePieces(m_currentState->CurrentPlayer);
+
+	//Undoing the player's move would only give the turn to the engine so its move before it is undone too
+	if (m_engineColor.has_value() && m_currentState->CurrentPlayer == m_engineColor.value()) UndoMove();
+}
+
+void MainFrame::StartEngineTurn()
+{
+	if (m_currentState == nullptr || !m_engineColor.has_value()) return;
+	if (m_currentState->CurrentPlayer != m_engineColor.value() || m_currentState->InCheckmate) return;
+
+	//The player can not move and the analysis would only compete with the engine for the cores until the engine has moved
+	DisableAllPieces();
+	m_manager.StopAnalysis(GAME_STATE_ID);
+	//The callback runs on the search thread so the move is queued for the ui thread to play
+	m_manager.StartEngineMove(GAME_STATE_ID, {}, [this](const Core::EngineMove& move) -> void
+		{
+			wxThreadEvent* evt = new wxThreadEvent(EVT_ENGINE_MOVE);
+			evt->SetPayload(move);
+			wxQueueEvent(this, evt);
+		});
+}
+
+void MainFrame::OnEngineMove(wxThreadEvent& evt)
+{
+	//A move undone while the engine searched means the move is for a position that is no longer on the board
+	const Core::EngineMove move = evt.GetPayload<Core::EngineMove>();
+	if (m_currentState == nullptr || move.Hash != m_currentState->Hash) return;
+
+	const PieceMoveResult result = m_manager.TryPlayEngineMove(GAME_STATE_ID, move);
+	if (!result.IsValidMove)
+	{
+		Utils::Log(Utils::LogType::Warning, std::format("Tried to play the engine move in main frame but failed! Info: {}", result.Info));
+		return;
+	}
+
+	//The result only has the positions whose pieces changed so the emptied start is rendered too
+	const Utils::Point2DInt startPos = Board::ToPosition(move.Result.BestMove.GetFrom());
+	const Utils::Point2DInt endPos = Board::ToPosition(move.Result.BestMove.GetTo());
+	std::vector<Utils::Point2DInt> changedPositions = { startPos };
+	changedPositions.insert(changedPositions.end(), result.AttemptedPositions.begin(), result.AttemptedPositions.end());
+	if (!TryRenderBoardChange(m_manager, *m_currentState, changedPositions, { startPos, endPos }))
+	{
+		const std::string err = std::format("Tried to render the engine move but failed!");
+		Utils::Log(Utils::LogType::Error, err);
+	}
+
+	const std::optional<ArmyColor> newColor = m_manager.TryAdvanceTurn(GAME_STATE_ID);
+	if (!newColor.has_value())
+	{
+		Utils::Log(Utils::LogType::Error, std::format("Tried to advance the turn after the engine move in main frame but failed!"));
+		return;
+	}
+	UpdateInteractablePieces(newColor.value());
+}
+
+void MainFrame::OnAnalysisUpdate(wxThreadEvent& evt)
+{
+	//Several updates can be queued before the ui gets to them so only the latest is shown
+	const std::vector<Engine::SearchProgress> updates = m_analysis.DrainProgress();
+	if (updates.empty() || m_analysisText == nullptr) return;
+
+	const Engine::SearchProgress& progress = updates.back();
+	const int lightScore = m_analysisColor == ArmyColor::Light ? progress.Score : -progress.Score;
+	const std::string scoreText = Engine::ToScoreString(lightScore);
+
+	std::string line;
+	for (const auto& move : progress.PrincipalVariation) line += Board::ToCoordinateNotation(move) + " ";
+	m_analysisText->SetLabel(std::format("Depth: {}{}\nScore: {}\n{}", progress.Depth, 
+		progress.IsFinal ? "" : "...", scoreText, line));
+	m_analysisText->Wrap(m_analysisText->GetSize().x);
+}
@@ -6,8 +6,16 @@
 #include "UIGlobals.hpp"
 #include "GameManager.hpp"
 #include "GameState.hpp"
+#include "Analysis.hpp"
 #include "ConfirmPopup.hpp"
 
+//Queued from the analysis thread so the latest engine analysis is shown on the ui thread
+wxDECLARE_EVENT(EVT_ANALYSIS_UPDATE, wxThreadEvent);
+//Queued from the candidate search thread with the top moves (a Core::CandidateMoves payload) to show on the ui thread
+wxDECLARE_EVENT(EVT_TOP_MOVES_UPDATE, wxThreadEvent);
+//Queued from the engine move search thread with its move (a Core::EngineMove payload) to play on the ui thread
+wxDECLARE_EVENT(EVT_ENGINE_MOVE, wxThreadEvent);
+
 class MainFrame : public wxFrame
 {
 private:
@@ -18,6 +26,13 @@ private:
 	Core::GameManager& m_manager;
 	ConfirmPopup m_popup;
 
+	wxStaticText* m_analysisText;
+	Engine::AnalysisHandle m_analysis;
+	//The side to move in the analysed position (scores are shown from light's point of view)
+	ArmyColor m_analysisColor;
+	//The side the engine plays in the current game (if any)
+	std::optional<ArmyColor> m_engineColor;
+
 public:
 
 	enum class Page : int
@@ -37,9 +52,18 @@ private:
 	void TogglePage(const Page& page);
 	bool TryUpdateBoard();
 
-	void StartGame();
+	void StartGame(const std::optional<ArmyColor>& engineColor = std::nullopt);
+
+	void StartAnalysis();
+	void ShowTopMoves();
+	void UndoMove();
+	void StartEngineTurn();
+	void OnEngineMove(wxThreadEvent& evt);
+	void OnAnalysisUpdate(wxThreadEvent& evt);
+	void OnTopMovesUpdate(wxThreadEvent& evt);
 
 public:
 	MainFrame(Core::GameManager& gameManager, const wxString& title);
+	~MainFrame();
 };
 
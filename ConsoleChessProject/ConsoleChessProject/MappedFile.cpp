@@ -0,0 +1,73 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "MappedFile.hpp"
+
+namespace Utils
+{
+	MappedFile::MappedFile(const std::string& path) : m_data(nullptr), m_size(0), m_fileHandle(nullptr), m_mappingHandle(nullptr)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return;
+		m_fileHandle = file;
+
+		LARGE_INTEGER fileSize = {};
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return;
+		m_mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mappingHandle == nullptr) return;
+
+		m_data = static_cast<const std::uint8_t*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (m_data != nullptr) m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		const int descriptor = open(path.c_str(), O_RDONLY);
+		if (descriptor < 0) return;
+
+		struct stat fileInfo = {};
+		if (fstat(descriptor, &fileInfo) == 0 && fileInfo.st_size > 0)
+		{
+			void* mapped = mmap(nullptr, static_cast<size_t>(fileInfo.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+			if (mapped != MAP_FAILED)
+			{
+				m_data = static_cast<const std::uint8_t*>(mapped);
+				m_size = static_cast<size_t>(fileInfo.st_size);
+			}
+		}
+		//The mapping stays valid without the descriptor
+		close(descriptor);
+#endif
+	}
+
+	MappedFile::~MappedFile()
+	{
+#ifdef _WIN32
+		if (m_data != nullptr) UnmapViewOfFile(m_data);
+		if (m_mappingHandle != nullptr) CloseHandle(m_mappingHandle);
+		if (m_fileHandle != nullptr) CloseHandle(m_fileHandle);
+#else
+		if (m_data != nullptr) munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+	}
+
+	bool MappedFile::IsMapped() const
+	{
+		return m_data != nullptr;
+	}
+
+	const std::uint8_t* MappedFile::GetData() const
+	{
+		return m_data;
+	}
+
+	size_t MappedFile::GetSize() const
+	{
+		return m_size;
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Utils
+{
+	/// <summary>
+	/// A read only view of a whole file mapped into memory, so its pages are only loaded from disk once they are read
+	/// and the operating system shares them between every process that maps the same file
+	/// </summary>
+	class MappedFile
+	{
+	private:
+		const std::uint8_t* m_data;
+		size_t m_size;
+		//The file and mapping handles on Windows (the descriptor can be closed right away everywhere else)
+		void* m_fileHandle;
+		void* m_mappingHandle;
+
+	public:
+		/// <summary>
+		/// Maps the file, leaving it unmapped (see IsMapped) if it can not be opened or is empty
+		/// </summary>
+		/// <param name="path"></param>
+		explicit MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool IsMapped() const;
+		const std::uint8_t* GetData() const;
+		size_t GetSize() const;
+	};
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include "Bitboard.hpp"
+#include "Piece.hpp"
+
+namespace Board
+{
+	//Flags follow the common 4 bit layout where bit 2 marks captures
+	//and bit 3 marks promotions (with the low 2 bits being the promoted piece)
+	enum class MoveFlag : std::uint8_t
+	{
+		Quiet = 0,
+		DoublePawnPush = 1,
+		KingSideCastle = 2,
+		QueenSideCastle = 3,
+		Capture = 4,
+		EnPassant = 5,
+		KnightPromotion = 8,
+		BishopPromotion = 9,
+		RookPromotion = 10,
+		QueenPromotion = 11,
+		KnightPromotionCapture = 12,
+		BishopPromotionCapture = 13,
+		RookPromotionCapture = 14,
+		QueenPromotionCapture = 15,
+	};
+
+	constexpr std::uint8_t MOVE_FLAG_CAPTURE_BIT = 1 << 2;
+	constexpr std::uint8_t MOVE_FLAG_PROMOTION_BIT = 1 << 3;
+
+	/// <summary>
+	/// A move packed into 16 bits (6 bits from square, 6 bits to square and 4 bits of flags).
+	/// It is used for generation, search and history and is only expanded into a MoveInfo
+	/// (with its piece references and notation) when the UI or notation needs one
+	/// </summary>
+	class Move
+	{
+	private:
+		std::uint16_t m_data;
+
+		static constexpr int SQUARE_BITS = 6;
+		static constexpr std::uint16_t SQUARE_MASK = (1 << SQUARE_BITS) - 1;
+
+	public:
+		constexpr Move() : m_data(0) {}
+		constexpr Move(const Square from, const Square to, const MoveFlag flag)
+			: m_data(static_cast<std::uint16_t>(from | (to << SQUARE_BITS) | (static_cast<int>(flag) << (2 * SQUARE_BITS)))) {}
+		//Rebuilds a move from GetData (like when it was packed into a transposition table entry)
+		explicit constexpr Move(const std::uint16_t data) : m_data(data) {}
+
+		constexpr Square GetFrom() const { return m_data & SQUARE_MASK; }
+		constexpr Square GetTo() const { return (m_data >> SQUARE_BITS) & SQUARE_MASK; }
+		constexpr MoveFlag GetFlag() const { return static_cast<MoveFlag>(m_data >> (2 * SQUARE_BITS)); }
+		constexpr std::uint16_t GetData() const { return m_data; }
+
+		//A move from and to the same square can never be generated so the zero value marks no move
+		constexpr bool IsNull() const { return m_data == 0; }
+		constexpr bool IsCapture() const { return static_cast<std::uint8_t>(GetFlag()) & MOVE_FLAG_CAPTURE_BIT; }
+		constexpr bool IsPromotion() const { return static_cast<std::uint8_t>(GetFlag()) & MOVE_FLAG_PROMOTION_BIT; }
+		constexpr bool IsCastle() const { return GetFlag() == MoveFlag::KingSideCastle || GetFlag() == MoveFlag::QueenSideCastle; }
+
+		//Note: only valid for promotions
+		constexpr PieceType GetPromotionType() const
+		{
+			return static_cast<PieceType>(ToIndex(PieceType::Knight) + (static_cast<std::uint8_t>(GetFlag()) & 0b11));
+		}
+
+		constexpr bool operator==(const Move& other) const = default;
+	};
+	static_assert(sizeof(Move) == 2 && std::is_trivially_copyable_v<Move>, "Move must stay a 16 bit trivially copyable type");
+	constexpr Move NULL_MOVE = {};
+}
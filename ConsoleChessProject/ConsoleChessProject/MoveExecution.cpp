@@ -0,0 +1,128 @@
+#include <format>
+#include "MoveExecution.hpp"
+#include "MoveGeneration.hpp"
+#include "GameState.hpp"
+#include "Bitboard.hpp"
+#include "Zobrist.hpp"
+#include "PieceSquareTables.hpp"
+#include "HelperFunctions.hpp"
+#include "Globals.hpp"
+
+namespace Board
+{
+	static inline Square GetEnPassantCaptureSquare(const ArmyColor color, const Square to)
+	{
+		return color == ArmyColor::Light ? to - BOARD_DIMENSION : to + BOARD_DIMENSION;
+	}
+
+	bool MakeMove(GameState& state, const Move& move)
+	{
+		if (state.StateHistoryCount >= MAX_STATE_HISTORY)
+		{
+			std::string error = std::format("Tried to make move: {} but the state history "
+				"is full ({} moves)", ToCoordinateNotation(move), std::to_string(MAX_STATE_HISTORY));
+			Utils::Log(Utils::LogType::Error, error);
+			return false;
+		}
+
+		StateInfo& info = state.StateHistory[state.StateHistoryCount++];
+		info.MovePlayed = move;
+		info.CapturedCode = NO_PIECE;
+		info.CapturedPiece = nullptr;
+		info.PromotedPawn = nullptr;
+		info.CastlingRights = state.CastlingRights;
+		info.EnPassantSquare = state.EnPassantSquare;
+		info.Checkers = state.Checkers;
+		info.Hash = state.Hash;
+		info.Evaluation = state.Evaluation;
+
+		BitboardSet& board = state.Bitboards;
+		const Square from = move.GetFrom();
+		const Square to = move.GetTo();
+		const ArmyColor color = state.CurrentPlayer;
+
+		const PieceCode movedCode = board.PieceCodes[from];
+		//Rights and en passant are xored out here and the new ones xored back in once the move is done
+		ZobristKey hash = state.Hash ^ GetCastlingKey(state.CastlingRights) ^ GetEnPassantKey(state.EnPassantSquare);
+		EvaluationScore& evaluation = state.Evaluation;
+
+		if (move.IsCapture())
+		{
+			const Square capturedSquare = move.GetFlag() == MoveFlag::EnPassant ? GetEnPassantCaptureSquare(color, to) : to;
+			info.CapturedCode = board.PieceCodes[capturedSquare];
+			info.CapturedPiece = board.RemovePiece(capturedSquare);
+			hash ^= GetPieceKey(info.CapturedCode, capturedSquare);
+			RemovePieceScore(evaluation, info.CapturedCode, capturedSquare);
+		}
+		board.MovePiece(from, to);
+		hash ^= GetPieceKey(movedCode, from) ^ GetPieceKey(movedCode, to);
+		MovePieceScore(evaluation, movedCode, from, to);
+
+		if (move.IsPromotion())
+		{
+			//The promoted piece does not exist in the game so it points at the shared piece for that type
+			const PieceCode promotedCode = ToPieceCode(color, move.GetPromotionType());
+			info.PromotedPawn = board.RemovePiece(to);
+			Piece* promotedPiece = const_cast<Piece*>(&GetPromotionPiece(color, move.GetPromotionType()));
+			board.AddPiece(to, promotedCode, promotedPiece);
+			hash ^= GetPieceKey(movedCode, to) ^ GetPieceKey(promotedCode, to);
+			RemovePieceScore(evaluation, movedCode, to);
+			AddPieceScore(evaluation, promotedCode, to);
+		}
+		else if (move.IsCastle())
+		{
+			const Square rookFrom = move.GetFlag() == MoveFlag::KingSideCastle ? to + 1 : to - 2;
+			const Square rookTo = move.GetFlag() == MoveFlag::KingSideCastle ? to - 1 : to + 1;
+			const PieceCode rookCode = ToPieceCode(color, PieceType::Rook);
+			board.MovePiece(rookFrom, rookTo);
+			hash ^= GetPieceKey(rookCode, rookFrom) ^ GetPieceKey(rookCode, rookTo);
+			MovePieceScore(evaluation, rookCode, rookFrom, rookTo);
+		}
+
+		state.CastlingRights = GetCastlingRightsAfterMove(state.CastlingRights, from, to);
+		state.EnPassantSquare = move.GetFlag() == MoveFlag::DoublePawnPush ? (from + to) / 2 : NO_SQUARE;
+		state.CurrentPlayer = GetOppositeColor(color);
+		state.Hash = hash ^ GetCastlingKey(state.CastlingRights) ^ GetEnPassantKey(state.EnPassantSquare) ^ ZOBRIST_KEYS.DarkToMove;
+		state.Checkers = CalculateCheckers(board, state.CurrentPlayer);
+		return true;
+	}
+
+	bool UnmakeMove(GameState& state)
+	{
+		if (state.StateHistoryCount == 0)
+		{
+			Utils::Log(Utils::LogType::Error, "Tried to unmake a move but there are no moves in the state history");
+			return false;
+		}
+
+		const StateInfo& info = state.StateHistory[--state.StateHistoryCount];
+		BitboardSet& board = state.Bitboards;
+		const Move move = info.MovePlayed;
+		const Square from = move.GetFrom();
+		const Square to = move.GetTo();
+		const ArmyColor color = GetOppositeColor(state.CurrentPlayer);
+
+		if (move.IsPromotion())
+		{
+			board.RemovePiece(to);
+			board.AddPiece(to, ToPieceCode(color, PieceType::Pawn), info.PromotedPawn);
+		}
+		else if (move.GetFlag() == MoveFlag::KingSideCastle) board.MovePiece(to - 1, to + 1);
+		else if (move.GetFlag() == MoveFlag::QueenSideCastle) board.MovePiece(to + 1, to - 2);
+		board.MovePiece(to, from);
+
+		if (info.CapturedCode != NO_PIECE)
+		{
+			const Square capturedSquare = move.GetFlag() == MoveFlag::EnPassant ? GetEnPassantCaptureSquare(color, to) : to;
+			board.AddPiece(capturedSquare, info.CapturedCode, info.CapturedPiece);
+		}
+
+		state.CastlingRights = info.CastlingRights;
+		state.EnPassantSquare = info.EnPassantSquare;
+		state.Checkers = info.Checkers;
+		state.Hash = info.Hash;
+		state.Evaluation = info.Evaluation;
+		state.CurrentPlayer = color;
+		return true;
+	}
+}
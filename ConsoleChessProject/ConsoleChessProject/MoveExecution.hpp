@@ -0,0 +1,24 @@
+#pragma once
+#include "GameState.hpp"
+#include "Move.hpp"
+
+namespace Board
+{
+	/// <summary>
+	/// Plays the move on the bitboards of the state and switches the current player, pushing
+	/// what is needed to undo it onto the state history. This is O(1) and never allocates.
+	/// Note: the in play map, captured pieces, previous moves and piece states are not touched
+	/// (moves played for the game go through TryMove). Returns false if the history is full
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="move"></param>
+	/// <returns></returns>
+	bool MakeMove(GameState& state, const Move& move);
+
+	/// <summary>
+	/// Takes back the last move made with MakeMove. Returns false if there is no move to undo
+	/// </summary>
+	/// <param name="state"></param>
+	/// <returns></returns>
+	bool UnmakeMove(GameState& state);
+}
@@ -0,0 +1,502 @@
+#include <array>
+#include <cctype>
+#include <string>
+#include <vector>
+#include "MoveGeneration.hpp"
+#include "Attacks.hpp"
+#include "Bitboard.hpp"
+#include "GameState.hpp"
+#include "Piece.hpp"
+#include "Color.hpp"
+#include "Globals.hpp"
+
+namespace Board
+{
+	enum class GenerationType
+	{
+		All,
+		Captures,
+		Quiets,
+	};
+
+	constexpr Bitboard RANK_1 = 0xFFull;
+	constexpr Bitboard RANK_3 = RANK_1 << (2 * BOARD_DIMENSION);
+	constexpr Bitboard RANK_6 = RANK_1 << (5 * BOARD_DIMENSION);
+	constexpr Bitboard RANK_8 = RANK_1 << (7 * BOARD_DIMENSION);
+
+	struct CastleSquares
+	{
+		CastlingRights KingSideRight;
+		CastlingRights QueenSideRight;
+		Square KingStart;
+		Square KingSideRookStart;
+		Square QueenSideRookStart;
+	};
+
+	//Standard chess start squares for the king and rooks of each color (indexed by color)
+	static constexpr std::array<CastleSquares, TEAMS_COUNT> CASTLE_SQUARES = { {
+		{ LIGHT_KING_SIDE_CASTLE, LIGHT_QUEEN_SIDE_CASTLE, ToSquare(7, 4), ToSquare(7, 7), ToSquare(7, 0) },
+		{ DARK_KING_SIDE_CASTLE, DARK_QUEEN_SIDE_CASTLE, ToSquare(0, 4), ToSquare(0, 7), ToSquare(0, 0) } } };
+
+	//Rights that are kept when a piece moves from or to each square
+	static constexpr std::array<CastlingRights, SQUARE_COUNT> CreateCastlingRightsMasks()
+	{
+		std::array<CastlingRights, SQUARE_COUNT> masks = {};
+		masks.fill(ALL_CASTLING);
+		for (const auto& squares : CASTLE_SQUARES)
+		{
+			masks[squares.KingStart] &= ~(squares.KingSideRight | squares.QueenSideRight);
+			masks[squares.KingSideRookStart] &= ~squares.KingSideRight;
+			masks[squares.QueenSideRookStart] &= ~squares.QueenSideRight;
+		}
+		return masks;
+	}
+	static constexpr std::array<CastlingRights, SQUARE_COUNT> CASTLING_RIGHTS_MASKS = CreateCastlingRightsMasks();
+
+	CastlingRights GetCastlingRightsAfterMove(const CastlingRights rights, const Square from, const Square to)
+	{
+		return rights & CASTLING_RIGHTS_MASKS[from] & CASTLING_RIGHTS_MASKS[to];
+	}
+
+	CastlingRights CalculateCastlingRights(const BitboardSet& board)
+	{
+		CastlingRights rights = NO_CASTLING;
+		for (const auto& color : { ArmyColor::Light, ArmyColor::Dark })
+		{
+			const CastleSquares& squares = CASTLE_SQUARES[ToIndex(color)];
+			if (board.PieceCodes[squares.KingStart] != ToPieceCode(color, PieceType::King)) continue;
+
+			const PieceCode rookCode = ToPieceCode(color, PieceType::Rook);
+			if (board.PieceCodes[squares.KingSideRookStart] == rookCode) rights |= squares.KingSideRight;
+			if (board.PieceCodes[squares.QueenSideRookStart] == rookCode) rights |= squares.QueenSideRight;
+		}
+		return rights;
+	}
+
+	static inline Square GetForwardOffset(const ArmyColor color)
+	{
+		return color == ArmyColor::Light ? BOARD_DIMENSION : -BOARD_DIMENSION;
+	}
+
+	static inline Bitboard ShiftForward(const Bitboard bitboard, const ArmyColor color)
+	{
+		return color == ArmyColor::Light ? bitboard << BOARD_DIMENSION : bitboard >> BOARD_DIMENSION;
+	}
+
+	bool IsSquareAttacked(const GameState& state, const Square square, const ArmyColor byColor)
+	{
+		return GetAttackersTo(state.Bitboards, square, byColor, state.Bitboards.Occupancy) != EMPTY_BITBOARD;
+	}
+
+	Bitboard CalculateCheckers(const BitboardSet& board, const ArmyColor kingColor)
+	{
+		Bitboard checkers = EMPTY_BITBOARD;
+		Bitboard kings = board.GetPieces(kingColor, PieceType::King);
+		while (kings)
+		{
+			checkers |= GetAttackersTo(board, PopLeastSignificantSquare(kings), GetOppositeColor(kingColor), board.Occupancy);
+		}
+		return checkers;
+	}
+
+	static void ApplyMoveToBitboards(BitboardSet& board, const Move& move)
+	{
+		const Square from = move.GetFrom();
+		const Square to = move.GetTo();
+		const ArmyColor color = GetColorFromCode(board.PieceCodes[from]);
+
+		if (move.GetFlag() == MoveFlag::EnPassant) board.RemovePiece(to - GetForwardOffset(color));
+		else if (move.IsCapture()) board.RemovePiece(to);
+		board.MovePiece(from, to);
+
+		if (move.IsPromotion())
+		{
+			Piece* pawn = board.RemovePiece(to);
+			board.AddPiece(to, ToPieceCode(color, move.GetPromotionType()), pawn);
+		}
+		else if (move.GetFlag() == MoveFlag::KingSideCastle) board.MovePiece(to + 1, to - 1);
+		else if (move.GetFlag() == MoveFlag::QueenSideCastle) board.MovePiece(to - 2, to + 1);
+	}
+
+	/// <summary>
+	/// Plays the move on a copy of the bitboards and returns true if no king of the mover is attacked after it.
+	/// This is only used for en passant (which can uncover a check along the rank of both pawns) 
+	/// and for custom layouts that do not have exactly one king per color
+	/// </summary>
+	static bool IsLegal(const BitboardSet& board, const ArmyColor color, const Move& move)
+	{
+		BitboardSet boardAfterMove = board;
+		ApplyMoveToBitboards(boardAfterMove, move);
+
+		const ArmyColor opponent = GetOppositeColor(color);
+		Bitboard kings = boardAfterMove.GetPieces(color, PieceType::King);
+		while (kings)
+		{
+			const Square kingSquare = PopLeastSignificantSquare(kings);
+			if (GetAttackersTo(boardAfterMove, kingSquare, opponent, boardAfterMove.Occupancy)) return false;
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// The checks and pins on the king of a color, calculated once per generation so that moves
+	/// are only emitted when they are legal instead of being played and tested one by one
+	/// </summary>
+	struct LegalityInfo
+	{
+		Square KingSquare;
+		Bitboard Checkers;
+		//Squares a non king move has to land on (capturing or blocking a single checker).
+		//This is every square when not in check and no square in double check
+		Bitboard CheckMask;
+		//Pieces that can only move along the line between their king and the slider pinning them
+		Bitboard Pinned;
+		//Set when the color does not have exactly one king so every move is played and tested instead
+		bool NeedsFullTest;
+	};
+
+	static LegalityInfo CalculateLegalityInfo(const BitboardSet& board, const ArmyColor color)
+	{
+		LegalityInfo info = { NO_SQUARE, EMPTY_BITBOARD, ~EMPTY_BITBOARD, EMPTY_BITBOARD, false };
+		const Bitboard kings = board.GetPieces(color, PieceType::King);
+		if (PopCount(kings) != 1)
+		{
+			info.NeedsFullTest = true;
+			return info;
+		}
+
+		const ArmyColor opponent = GetOppositeColor(color);
+		const auto& enemyPieces = board.Pieces[ToIndex(opponent)];
+		const Square king = GetLeastSignificantSquare(kings);
+		info.KingSquare = king;
+		info.Checkers = GetAttackersTo(board, king, opponent, board.Occupancy);
+
+		if (PopCount(info.Checkers) == 1) info.CheckMask = info.Checkers | GetBetween(king, GetLeastSignificantSquare(info.Checkers));
+		else if (info.Checkers) info.CheckMask = EMPTY_BITBOARD;
+
+		//Enemy sliders that see the king through our own pieces (their rays only stop at enemy pieces)
+		const Bitboard enemyQueens = enemyPieces[ToIndex(PieceType::Queen)];
+		const Bitboard enemyOccupancy = board.ColorOccupancy[ToIndex(opponent)];
+		Bitboard snipers = (GetRookAttacks(king, enemyOccupancy) & (enemyPieces[ToIndex(PieceType::Rook)] | enemyQueens)) |
+						   (GetBishopAttacks(king, enemyOccupancy) & (enemyPieces[ToIndex(PieceType::Bishop)] | enemyQueens));
+		while (snipers)
+		{
+			const Bitboard blockers = GetBetween(king, PopLeastSignificantSquare(snipers)) & board.Occupancy;
+			if (PopCount(blockers) == 1) info.Pinned |= blockers & board.ColorOccupancy[ToIndex(color)];
+		}
+		return info;
+	}
+
+	static inline bool IsAllowedByChecksAndPins(const LegalityInfo& info, const Square from, const Square to)
+	{
+		if (!(info.CheckMask & ToBitboard(to))) return false;
+		return !(info.Pinned & ToBitboard(from)) || (GetLine(info.KingSquare, from) & ToBitboard(to));
+	}
+
+	static void AddPromotions(MoveList& moves, const Square from, const Square to, const bool isCapture)
+	{
+		const std::uint8_t captureBit = isCapture ? MOVE_FLAG_CAPTURE_BIT : 0;
+		for (const auto& flag : { MoveFlag::QueenPromotion, MoveFlag::KnightPromotion, MoveFlag::RookPromotion, MoveFlag::BishopPromotion })
+		{
+			moves.Add(from, to, static_cast<MoveFlag>(static_cast<std::uint8_t>(flag) | captureBit));
+		}
+	}
+
+	template<GenerationType Type>
+	static void GeneratePawnMoves(const GameState& state, const ArmyColor color, const Bitboard fromMask, 
+		const LegalityInfo& info, MoveList& moves)
+	{
+		const BitboardSet& board = state.Bitboards;
+		const Square forward = GetForwardOffset(color);
+		const Bitboard promotionRank = color == ArmyColor::Light ? RANK_8 : RANK_1;
+		const Bitboard pawns = board.GetPieces(color, PieceType::Pawn) & fromMask;
+
+		const Bitboard empty = ~board.Occupancy;
+		const Bitboard singlePushes = ShiftForward(pawns, color) & empty;
+		if constexpr (Type != GenerationType::Captures)
+		{
+			//Pawns that landed on the 3rd rank (from their own side) started on their 2nd rank
+			const Bitboard doublePushes = ShiftForward(singlePushes & (color == ArmyColor::Light ? RANK_3 : RANK_6), color) & empty;
+
+			Bitboard pushes = singlePushes & ~promotionRank & info.CheckMask;
+			while (pushes)
+			{
+				const Square to = PopLeastSignificantSquare(pushes);
+				if (IsAllowedByChecksAndPins(info, to - forward, to)) moves.Add(to - forward, to, MoveFlag::Quiet);
+			}
+
+			pushes = doublePushes & info.CheckMask;
+			while (pushes)
+			{
+				const Square to = PopLeastSignificantSquare(pushes);
+				if (IsAllowedByChecksAndPins(info, to - 2 * forward, to)) moves.Add(to - 2 * forward, to, MoveFlag::DoublePawnPush);
+			}
+		}
+
+		//Promotions change the material like captures do so they are generated with them
+		if constexpr (Type != GenerationType::Quiets)
+		{
+			Bitboard pushes = singlePushes & promotionRank & info.CheckMask;
+			while (pushes)
+			{
+				const Square to = PopLeastSignificantSquare(pushes);
+				if (IsAllowedByChecksAndPins(info, to - forward, to)) AddPromotions(moves, to - forward, to, false);
+			}
+
+			const Bitboard enemies = board.ColorOccupancy[ToIndex(GetOppositeColor(color))];
+			Bitboard attackers = pawns;
+			while (attackers)
+			{
+				const Square from = PopLeastSignificantSquare(attackers);
+				Bitboard captures = GetPawnAttacks(color, from) & enemies & info.CheckMask;
+				while (captures)
+				{
+					const Square to = PopLeastSignificantSquare(captures);
+					if (!IsAllowedByChecksAndPins(info, from, to)) continue;
+
+					if (ToBitboard(to) & promotionRank) AddPromotions(moves, from, to, true);
+					else moves.Add(from, to, MoveFlag::Capture);
+				}
+			}
+
+			//The en passant square is behind the pawn that double pushed so only the other color can capture on it.
+			//It removes two pieces from the same rank so it is the one move that is still played and tested
+			const int enPassantRank = color == ArmyColor::Light ? 5 : 2;
+			if (state.EnPassantSquare != NO_SQUARE && GetRank(state.EnPassantSquare) == enPassantRank)
+			{
+				Bitboard enPassantAttackers = GetPawnAttacks(GetOppositeColor(color), state.EnPassantSquare) & pawns;
+				while (enPassantAttackers)
+				{
+					const Move move(PopLeastSignificantSquare(enPassantAttackers), state.EnPassantSquare, MoveFlag::EnPassant);
+					if (info.NeedsFullTest || IsLegal(board, color, move)) moves.Add(move);
+				}
+			}
+		}
+	}
+
+	static void GenerateCastlingMoves(const GameState& state, const ArmyColor color, const Bitboard fromMask, 
+		const LegalityInfo& info, MoveList& moves)
+	{
+		const BitboardSet& board = state.Bitboards;
+		const ArmyColor opponent = GetOppositeColor(color);
+		const CastleSquares& squares = CASTLE_SQUARES[ToIndex(color)];
+		if (!(state.CastlingRights & (squares.KingSideRight | squares.QueenSideRight))) return;
+		if (!(fromMask & ToBitboard(squares.KingStart))) return;
+		if (info.Checkers || GetAttackersTo(board, squares.KingStart, opponent, board.Occupancy)) return;
+
+		//The squares between king and rook must be empty and the king can not pass through or land on an attacked square
+		const Square king = squares.KingStart;
+		if ((state.CastlingRights & squares.KingSideRight) &&
+			!(board.Occupancy & (ToBitboard(king + 1) | ToBitboard(king + 2))) &&
+			!GetAttackersTo(board, king + 1, opponent, board.Occupancy) &&
+			!GetAttackersTo(board, king + 2, opponent, board.Occupancy))
+		{
+			moves.Add(king, king + 2, MoveFlag::KingSideCastle);
+		}
+
+		if ((state.CastlingRights & squares.QueenSideRight) &&
+			!(board.Occupancy & (ToBitboard(king - 1) | ToBitboard(king - 2) | ToBitboard(king - 3))) &&
+			!GetAttackersTo(board, king - 1, opponent, board.Occupancy) &&
+			!GetAttackersTo(board, king - 2, opponent, board.Occupancy))
+		{
+			moves.Add(king, king - 2, MoveFlag::QueenSideCastle);
+		}
+	}
+
+	static Bitboard GetPieceAttacks(const PieceType type, const Square square, const Bitboard occupancy)
+	{
+		switch (type)
+		{
+		case PieceType::Knight:
+			return GetKnightAttacks(square);
+		case PieceType::Bishop:
+			return GetBishopAttacks(square, occupancy);
+		case PieceType::Rook:
+			return GetRookAttacks(square, occupancy);
+		case PieceType::Queen:
+			return GetQueenAttacks(square, occupancy);
+		case PieceType::King:
+			return GetKingAttacks(square);
+		default:
+			return EMPTY_BITBOARD;
+		}
+	}
+
+	template<GenerationType Type>
+	static void GenerateMoves(const GameState& state, const ArmyColor color, const Bitboard fromMask, 
+		const LegalityInfo& info, MoveList& moves)
+	{
+		const BitboardSet& board = state.Bitboards;
+		const ArmyColor opponent = GetOppositeColor(color);
+		const Bitboard enemies = board.ColorOccupancy[ToIndex(opponent)];
+
+		Bitboard targetMask = ~board.ColorOccupancy[ToIndex(color)];
+		if constexpr (Type == GenerationType::Captures) targetMask = enemies;
+		else if constexpr (Type == GenerationType::Quiets) targetMask = ~board.Occupancy;
+
+		//In double check only the king can move
+		if (info.CheckMask)
+		{
+			GeneratePawnMoves<Type>(state, color, fromMask, info, moves);
+			for (const auto& type : { PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen })
+			{
+				Bitboard pieces = board.GetPieces(color, type) & fromMask;
+				while (pieces)
+				{
+					const Square from = PopLeastSignificantSquare(pieces);
+					Bitboard targets = GetPieceAttacks(type, from, board.Occupancy) & targetMask & info.CheckMask;
+					if (info.Pinned & ToBitboard(from)) targets &= GetLine(info.KingSquare, from);
+					while (targets)
+					{
+						const Square to = PopLeastSignificantSquare(targets);
+						moves.Add(from, to, (enemies & ToBitboard(to)) ? MoveFlag::Capture : MoveFlag::Quiet);
+					}
+				}
+			}
+		}
+
+		Bitboard kings = board.GetPieces(color, PieceType::King) & fromMask;
+		while (kings)
+		{
+			const Square from = PopLeastSignificantSquare(kings);
+			//The king is taken off the board when testing its destinations so sliders see through to the squares behind it
+			const Bitboard occupancyWithoutKing = board.Occupancy ^ ToBitboard(from);
+			Bitboard targets = GetKingAttacks(from) & targetMask;
+			while (targets)
+			{
+				const Square to = PopLeastSignificantSquare(targets);
+				if (!info.NeedsFullTest && GetAttackersTo(board, to, opponent, occupancyWithoutKing)) continue;
+				moves.Add(from, to, (enemies & ToBitboard(to)) ? MoveFlag::Capture : MoveFlag::Quiet);
+			}
+		}
+
+		if constexpr (Type != GenerationType::Captures) GenerateCastlingMoves(state, color, fromMask, info, moves);
+	}
+
+	template<GenerationType Type>
+	static void GenerateLegal(const GameState& state, const ArmyColor color, const Bitboard fromMask, MoveList& moves)
+	{
+		moves.Clear();
+		const LegalityInfo info = CalculateLegalityInfo(state.Bitboards, color);
+		if (!info.NeedsFullTest)
+		{
+			GenerateMoves<Type>(state, color, fromMask, info, moves);
+			return;
+		}
+
+		MoveList pseudoLegalMoves;
+		GenerateMoves<Type>(state, color, fromMask, info, pseudoLegalMoves);
+		for (const auto& move : pseudoLegalMoves)
+		{
+			if (IsLegal(state.Bitboards, color, move)) moves.Add(move);
+		}
+	}
+
+	void GenerateLegalMoves(const GameState& state, MoveList& moves)
+	{
+		GenerateLegal<GenerationType::All>(state, state.CurrentPlayer, ~EMPTY_BITBOARD, moves);
+	}
+
+	void GenerateLegalMovesForPieceAt(const GameState& state, const Square square, MoveList& moves)
+	{
+		moves.Clear();
+		const PieceCode code = state.Bitboards.PieceCodes[square];
+		if (code == NO_PIECE) return;
+		GenerateLegal<GenerationType::All>(state, GetColorFromCode(code), ToBitboard(square), moves);
+	}
+
+	bool HasLegalMove(const GameState& state, const ArmyColor color)
+	{
+		MoveList moves;
+		GenerateLegal<GenerationType::All>(state, color, ~EMPTY_BITBOARD, moves);
+		return !moves.IsEmpty();
+	}
+
+	void GenerateLegalCaptures(const GameState& state, MoveList& moves)
+	{
+		GenerateLegal<GenerationType::Captures>(state, state.CurrentPlayer, ~EMPTY_BITBOARD, moves);
+	}
+
+	void GenerateLegalQuietMoves(const GameState& state, MoveList& moves)
+	{
+		GenerateLegal<GenerationType::Quiets>(state, state.CurrentPlayer, ~EMPTY_BITBOARD, moves);
+	}
+
+	static std::array<Piece, TEAMS_COUNT * PIECE_TYPE_COUNT> CreatePromotionPieces()
+	{
+		std::array<Piece, TEAMS_COUNT * PIECE_TYPE_COUNT> pieces = {
+			Piece(ArmyColor::Light, PieceType::Pawn), Piece(ArmyColor::Light, PieceType::Knight),
+			Piece(ArmyColor::Light, PieceType::Bishop), Piece(ArmyColor::Light, PieceType::Rook),
+			Piece(ArmyColor::Light, PieceType::Queen), Piece(ArmyColor::Light, PieceType::King),
+			Piece(ArmyColor::Dark, PieceType::Pawn), Piece(ArmyColor::Dark, PieceType::Knight),
+			Piece(ArmyColor::Dark, PieceType::Bishop), Piece(ArmyColor::Dark, PieceType::Rook),
+			Piece(ArmyColor::Dark, PieceType::Queen), Piece(ArmyColor::Dark, PieceType::King) };
+		return pieces;
+	}
+
+	const Piece& GetPromotionPiece(const ArmyColor color, const PieceType type)
+	{
+		//Not const since board squares hold mutable piece pointers and promoted pieces in a search point here
+		static std::array<Piece, TEAMS_COUNT * PIECE_TYPE_COUNT> PROMOTION_PIECES = CreatePromotionPieces();
+		return PROMOTION_PIECES[ToPieceCode(color, type)];
+	}
+
+	MoveInfo ToMoveInfo(const GameState& state, const Move& move)
+	{
+		const Square from = move.GetFrom();
+		const Square to = move.GetTo();
+		const Piece& movedPiece = *state.Bitboards.PiecePointers[from];
+		std::vector<MovePiecePositionData> piecesMoved = { MovePiecePositionData(movedPiece, ToPosition(from), ToPosition(to)) };
+
+		SpecialMove flags = SpecialMove::None;
+		const Piece* capturedPiece = nullptr;
+		const Piece* promotionPiece = nullptr;
+		if (move.GetFlag() == MoveFlag::EnPassant)
+		{
+			capturedPiece = state.Bitboards.PiecePointers[to - GetForwardOffset(movedPiece.m_Color)];
+		}
+		else if (move.IsCapture()) capturedPiece = state.Bitboards.PiecePointers[to];
+		if (capturedPiece != nullptr) flags = SpecialMove::Capture;
+
+		if (move.IsPromotion())
+		{
+			flags = static_cast<SpecialMove>(static_cast<unsigned int>(flags) | static_cast<unsigned int>(SpecialMove::Promotion));
+			promotionPiece = &GetPromotionPiece(movedPiece.m_Color, move.GetPromotionType());
+		}
+		//Castling also moves the rook which is stored as the second moved piece
+		else if (move.GetFlag() == MoveFlag::KingSideCastle)
+		{
+			flags = SpecialMove::KingSideCastle;
+			piecesMoved.emplace_back(*state.Bitboards.PiecePointers[to + 1], ToPosition(to + 1), ToPosition(to - 1));
+		}
+		else if (move.GetFlag() == MoveFlag::QueenSideCastle)
+		{
+			flags = SpecialMove::QueenSideCastle;
+			piecesMoved.emplace_back(*state.Bitboards.PiecePointers[to - 2], ToPosition(to - 2), ToPosition(to + 1));
+		}
+
+		return MoveInfo(piecesMoved, ToCoordinateNotation(move), flags, promotionPiece, capturedPiece, false, false);
+	}
+
+	bool MoveList::Contains(const Move& move) const
+	{
+		for (const auto& listMove : *this)
+		{
+			if (listMove == move) return true;
+		}
+		return false;
+	}
+
+	std::string ToCoordinateNotation(const Move& move)
+	{
+		std::string notation;
+		for (const Square square : { move.GetFrom(), move.GetTo() })
+		{
+			notation += static_cast<char>('a' + GetFile(square));
+			notation += static_cast<char>('1' + GetRank(square));
+		}
+		if (move.IsPromotion())
+			notation += static_cast<char>(std::tolower(GetNotationSymbolForPiece(move.GetPromotionType())));
+		return notation;
+	}
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include "GameState.hpp"
+#include "Move.hpp"
+#include "Bitboard.hpp"
+#include "Piece.hpp"
+#include "Color.hpp"
+
+namespace Board
+{
+	//No legal chess position has more than 218 moves so this never overflows
+	constexpr size_t MAX_MOVES = 256;
+
+	/// <summary>
+	/// Fixed capacity move list meant to be created on the stack so that
+	/// generating moves never allocates
+	/// </summary>
+	class MoveList
+	{
+	private:
+		std::array<Move, MAX_MOVES> m_moves;
+		size_t m_size;
+
+	public:
+		MoveList() : m_size(0) {}
+
+		inline void Add(const Square from, const Square to, const MoveFlag flag)
+		{
+			m_moves[m_size++] = Move(from, to, flag);
+		}
+		inline void Add(const Move& move) { m_moves[m_size++] = move; }
+		inline void Clear() { m_size = 0; }
+
+		inline size_t Size() const { return m_size; }
+		inline bool IsEmpty() const { return m_size == 0; }
+		bool Contains(const Move& move) const;
+
+		inline Move& operator[](const size_t index) { return m_moves[index]; }
+		inline const Move& operator[](const size_t index) const { return m_moves[index]; }
+
+		inline Move* begin() { return m_moves.data(); }
+		inline Move* end() { return m_moves.data() + m_size; }
+		inline const Move* begin() const { return m_moves.data(); }
+		inline const Move* end() const { return m_moves.data() + m_size; }
+	};
+
+	/// <summary>
+	/// Returns the castling rights that are left after a piece moves from one square to another.
+	/// Moving the king or a rook off its start square (or capturing a rook on it) removes that right
+	/// </summary>
+	/// <param name="rights"></param>
+	/// <param name="from"></param>
+	/// <param name="to"></param>
+	/// <returns></returns>
+	CastlingRights GetCastlingRightsAfterMove(const CastlingRights rights, const Square from, const Square to);
+
+	/// <summary>
+	/// Returns the castling rights for the pieces that are currently on their standard start squares
+	/// </summary>
+	/// <param name="board"></param>
+	/// <returns></returns>
+	CastlingRights CalculateCastlingRights(const BitboardSet& board);
+
+	/// <summary>
+	/// Returns true if any piece of the color attacks the square
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="square"></param>
+	/// <param name="byColor"></param>
+	/// <returns></returns>
+	bool IsSquareAttacked(const GameState& state, const Square square, const ArmyColor byColor);
+
+	/// <summary>
+	/// Returns the pieces giving check to the king (or kings) of the color
+	/// </summary>
+	/// <param name="board"></param>
+	/// <param name="kingColor"></param>
+	/// <returns></returns>
+	Bitboard CalculateCheckers(const BitboardSet& board, const ArmyColor kingColor);
+
+	/// <summary>
+	/// Returns true if the color has at least one legal move (so no legal move while in check is checkmate)
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="color"></param>
+	/// <returns></returns>
+	bool HasLegalMove(const GameState& state, const ArmyColor color);
+
+	/// <summary>
+	/// Fills the list with every legal move for the current player of the state
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="moves"></param>
+	void GenerateLegalMoves(const GameState& state, MoveList& moves);
+
+	/// <summary>
+	/// Fills the list with the legal moves of the piece at the square (for whichever color the piece is)
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="square"></param>
+	/// <param name="moves"></param>
+	void GenerateLegalMovesForPieceAt(const GameState& state, const Square square, MoveList& moves);
+
+	/// <summary>
+	/// Fills the list with only the legal captures and promotions (including en passant and quiet promotions)
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="moves"></param>
+	void GenerateLegalCaptures(const GameState& state, MoveList& moves);
+
+	/// <summary>
+	/// Fills the list with only the legal moves that are not captures or promotions (including castling).
+	/// Together with GenerateLegalCaptures this is every legal move
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="moves"></param>
+	void GenerateLegalQuietMoves(const GameState& state, MoveList& moves);
+
+	/// <summary>
+	/// Expands the move into a MoveInfo with references to the pieces in the state it is played from.
+	/// Note: the move must come from the state since the moved and captured pieces are read from it
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="move"></param>
+	/// <returns></returns>
+	MoveInfo ToMoveInfo(const GameState& state, const Move& move);
+
+	/// <summary>
+	/// Returns a piece that is not on any board for a promotion to the color and type,
+	/// so move infos can point to the piece a pawn promotes to before it exists
+	/// </summary>
+	/// <param name="color"></param>
+	/// <param name="type"></param>
+	/// <returns></returns>
+	const Piece& GetPromotionPiece(const ArmyColor color, const PieceType type);
+
+	/// <summary>
+	/// Returns the move in coordinate notation like e2e4 or e7e8q
+	/// </summary>
+	/// <param name="move"></param>
+	/// <returns></returns>
+	std::string ToCoordinateNotation(const Move& move);
+}
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include "MoveOrdering.hpp"
+#include "Evaluation.hpp"
+#include "GameState.hpp"
+#include "Bitboard.hpp"
+
+namespace Engine
+{
+	static constexpr int HASH_MOVE_SCORE = 1 << 30;
+	//Captures and promotions go above every quiet move (and below the hash move)
+	static constexpr int CAPTURE_BASE_SCORE = 1 << 24;
+	static constexpr int FIRST_KILLER_SCORE = 1 << 22;
+	static constexpr int SECOND_KILLER_SCORE = FIRST_KILLER_SCORE - 1;
+	static constexpr int COUNTERMOVE_SCORE = FIRST_KILLER_SCORE - 2;
+	//Victims count for more than attackers so every capture of a bigger piece is tried before any of a smaller one
+	static constexpr int VICTIM_VALUE_WEIGHT = 16;
+
+	void MoveOrderingTables::Clear()
+	{
+		for (auto& plyKillers : Killers) plyKillers.fill(Board::NULL_MOVE);
+		for (auto& colorHistory : History)
+		{
+			for (auto& fromHistory : colorHistory) fromHistory.fill(0);
+		}
+		for (auto& pieceCountermoves : Countermoves) pieceCountermoves.fill(Board::NULL_MOVE);
+	}
+
+	//The previous move is read from the undo stack and the piece that made it is the one now on its destination
+	static bool TryGetPreviousMovePiece(const GameState& position, Board::PieceCode& piece, Board::Square& square)
+	{
+		if (position.StateHistoryCount == 0) return false;
+
+		square = position.StateHistory[position.StateHistoryCount - 1].MovePlayed.GetTo();
+		piece = position.Bitboards.PieceCodes[square];
+		return piece != Board::NO_PIECE;
+	}
+
+	//History gravity: the bonus shrinks as the score nears the maximum so scores can never run away
+	static void ApplyHistoryBonus(int& historyScore, const int bonus)
+	{
+		historyScore += bonus - historyScore * std::abs(bonus) / MAX_HISTORY_SCORE;
+	}
+
+	void MoveOrderingTables::UpdateQuietCutoff(const GameState& position, const int ply, const int depth, 
+		const Board::Move& cutoffMove, const Board::Move* searchedQuiets, const size_t searchedQuietCount)
+	{
+		auto& plyKillers = Killers[ply];
+		if (plyKillers[0] != cutoffMove)
+		{
+			plyKillers[1] = plyKillers[0];
+			plyKillers[0] = cutoffMove;
+		}
+
+		Board::PieceCode previousPiece = Board::NO_PIECE;
+		Board::Square previousSquare = Board::NO_SQUARE;
+		if (TryGetPreviousMovePiece(position, previousPiece, previousSquare)) Countermoves[previousPiece][previousSquare] = cutoffMove;
+
+		const int bonus = std::min(depth * depth, MAX_HISTORY_SCORE);
+		auto& colorHistory = History[Board::ToIndex(position.CurrentPlayer)];
+		ApplyHistoryBonus(colorHistory[cutoffMove.GetFrom()][cutoffMove.GetTo()], bonus);
+		for (size_t i = 0; i < searchedQuietCount; i++)
+		{
+			const Board::Move& quiet = searchedQuiets[i];
+			if (quiet != cutoffMove) ApplyHistoryBonus(colorHistory[quiet.GetFrom()][quiet.GetTo()], -bonus);
+		}
+	}
+
+	int GetCaptureValue(const GameState& position, const Board::Move& move)
+	{
+		if (!move.IsCapture()) return 0;
+		//En passant is the one capture whose victim is not on the destination (and it is always a pawn)
+		if (move.GetFlag() == Board::MoveFlag::EnPassant) return GetPieceValue(PieceType::Pawn);
+		return GetPieceValue(Board::GetTypeFromCode(position.Bitboards.PieceCodes[move.GetTo()]));
+	}
+
+	int GetCaptureScore(const GameState& position, const Board::Move& move)
+	{
+		int score = 0;
+		if (move.IsCapture())
+		{
+			const PieceType attacker = Board::GetTypeFromCode(position.Bitboards.PieceCodes[move.GetFrom()]);
+			score += GetCaptureValue(position, move) * VICTIM_VALUE_WEIGHT - GetPieceValue(attacker);
+		}
+		if (move.IsPromotion()) score += (GetPieceValue(move.GetPromotionType()) - GetPieceValue(PieceType::Pawn)) * VICTIM_VALUE_WEIGHT;
+		return score;
+	}
+
+	MovePicker::MovePicker(const GameState& position, Board::MoveList& moves, const Board::Move& hashMove,
+		const MoveOrderingTables& tables, const int ply)
+		: m_moves(moves), m_scores(), m_nextIndex(0)
+	{
+		const auto& plyKillers = tables.Killers[ply];
+		Board::PieceCode previousPiece = Board::NO_PIECE;
+		Board::Square previousSquare = Board::NO_SQUARE;
+		const Board::Move countermove = TryGetPreviousMovePiece(position, previousPiece, previousSquare) ? 
+			tables.Countermoves[previousPiece][previousSquare] : Board::NULL_MOVE;
+		const auto& colorHistory = tables.History[Board::ToIndex(position.CurrentPlayer)];
+
+		for (size_t i = 0; i < moves.Size(); i++)
+		{
+			const Board::Move& move = moves[i];
+			if (move == hashMove) m_scores[i] = HASH_MOVE_SCORE;
+			else if (move.IsCapture() || move.IsPromotion()) m_scores[i] = CAPTURE_BASE_SCORE + GetCaptureScore(position, move);
+			else if (move == plyKillers[0]) m_scores[i] = FIRST_KILLER_SCORE;
+			else if (move == plyKillers[1]) m_scores[i] = SECOND_KILLER_SCORE;
+			else if (move == countermove) m_scores[i] = COUNTERMOVE_SCORE;
+			else m_scores[i] = colorHistory[move.GetFrom()][move.GetTo()];
+		}
+	}
+
+	bool MovePicker::TryGetNextMove(Board::Move& move)
+	{
+		if (m_nextIndex >= m_moves.Size()) return false;
+
+		//Selection sort one move at a time since most nodes cut off after the first few moves
+		size_t bestIndex = m_nextIndex;
+		for (size_t i = m_nextIndex + 1; i < m_moves.Size(); i++)
+		{
+			if (m_scores[i] > m_scores[bestIndex]) bestIndex = i;
+		}
+		std::swap(m_moves[m_nextIndex], m_moves[bestIndex]);
+		std::swap(m_scores[m_nextIndex], m_scores[bestIndex]);
+
+		move = m_moves[m_nextIndex++];
+		return true;
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "GameState.hpp"
+#include "Move.hpp"
+#include "MoveGeneration.hpp"
+#include "Bitboard.hpp"
+#include "Search.hpp"
+
+namespace Engine
+{
+	constexpr int KILLER_MOVES_PER_PLY = 2;
+	//History scores are kept within this so they always stay below the killer and capture scores
+	constexpr int MAX_HISTORY_SCORE = 16384;
+
+	/// <summary>
+	/// What earlier parts of the search learned about quiet moves. Each search thread has its own tables
+	/// </summary>
+	struct MoveOrderingTables
+	{
+		//Quiet moves that caused a cutoff at the ply (in another branch)
+		std::array<std::array<Board::Move, KILLER_MOVES_PER_PLY>, MAX_PLY> Killers;
+		//Butterfly history indexed by color, from square and to square
+		std::array<std::array<std::array<int, Board::SQUARE_COUNT>, Board::SQUARE_COUNT>, TEAMS_COUNT> History;
+		//The quiet move that last refuted a move, indexed by the piece that moved and where it moved to
+		std::array<std::array<Board::Move, Board::SQUARE_COUNT>, Board::NO_PIECE> Countermoves;
+
+		void Clear();
+
+		/// <summary>
+		/// Rewards the quiet move that caused a cutoff (as a killer, countermove and in the history)
+		/// and lowers the history of the quiet moves searched before it
+		/// </summary>
+		void UpdateQuietCutoff(const GameState& position, const int ply, const int depth, const Board::Move& cutoffMove, 
+			const Board::Move* searchedQuiets, const size_t searchedQuietCount);
+	};
+
+	/// <summary>
+	/// Hands out the moves of a list from the most to least promising: the hash move, captures by
+	/// most valuable victim and least valuable attacker, killers, the countermove and then quiets by history.
+	/// Moves are scored once and picked one at a time so a cutoff skips sorting the rest
+	/// </summary>
+	class MovePicker
+	{
+	private:
+		Board::MoveList& m_moves;
+		std::array<int, Board::MAX_MOVES> m_scores;
+		size_t m_nextIndex;
+
+	public:
+		MovePicker(const GameState& position, Board::MoveList& moves, const Board::Move& hashMove, 
+			const MoveOrderingTables& tables, const int ply);
+
+		bool TryGetNextMove(Board::Move& move);
+	};
+
+	/// <summary>
+	/// Returns the most valuable victim - least valuable attacker score of a capture (or the value gained by a promotion)
+	/// </summary>
+	/// <param name="position"></param>
+	/// <param name="move"></param>
+	/// <returns></returns>
+	int GetCaptureScore(const GameState& position, const Board::Move& move);
+
+	/// <summary>
+	/// Returns the value of the piece the move captures (0 if it is not a capture)
+	/// </summary>
+	/// <param name="position"></param>
+	/// <param name="move"></param>
+	/// <returns></returns>
+	int GetCaptureValue(const GameState& position, const Board::Move& move);
+}
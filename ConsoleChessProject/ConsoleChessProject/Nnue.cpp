@@ -0,0 +1,402 @@
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <format>
+#include <memory>
+#include <new>
+#include <string>
+#include "Nnue.hpp"
+#include "GameState.hpp"
+#include "Bitboard.hpp"
+#include "HelperFunctions.hpp"
+#include "Globals.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define HAS_X64_INTRINSICS
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(HAS_X64_INTRINSICS) && !defined(_MSC_VER)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+namespace Engine
+{
+	using WeightRow = std::array<std::int16_t, NNUE_HIDDEN_SIZE>;
+
+	struct NnueNetwork::Weights
+	{
+		alignas(64) WeightRow FeatureBiases;
+		alignas(64) std::array<WeightRow, NNUE_FEATURE_COUNT> FeatureWeights;
+		//The side to move's half comes first
+		alignas(64) std::array<WeightRow, TEAMS_COUNT> OutputWeights;
+		std::int32_t OutputBias;
+	};
+
+	//A move adds at most 2 features and removes at most 3 (the piece, a captured piece and a castling rook)
+	//but a refresh adds a feature for every piece so the lists are sized for a full board
+	static constexpr int MAX_CHANGED_FEATURES = Board::SQUARE_COUNT;
+
+	//output = input + every added row - every removed row
+	using ApplyChangesKernel = void(*)(const std::int16_t* input, std::int16_t* output, const std::int16_t* const* added,
+		const int addedCount, const std::int16_t* const* removed, const int removedCount);
+	//Returns the clipped hidden values of both sides multiplied by their output weights
+	using ForwardKernel = std::int32_t(*)(const std::int16_t* us, const std::int16_t* them, const std::int16_t* weights);
+
+	static void ApplyChangesScalar(const std::int16_t* input, std::int16_t* output, const std::int16_t* const* added,
+		const int addedCount, const std::int16_t* const* removed, const int removedCount)
+	{
+		for (int i = 0; i < NNUE_HIDDEN_SIZE; i++)
+		{
+			std::int16_t value = input[i];
+			for (int row = 0; row < addedCount; row++) value += added[row][i];
+			for (int row = 0; row < removedCount; row++) value -= removed[row][i];
+			output[i] = value;
+		}
+	}
+
+	static std::int32_t ForwardScalar(const std::int16_t* us, const std::int16_t* them, const std::int16_t* weights)
+	{
+		std::int32_t sum = 0;
+		for (int i = 0; i < NNUE_HIDDEN_SIZE; i++)
+		{
+			const int usValue = us[i] < 0 ? 0 : (us[i] > NNUE_ACTIVATION_MAX ? NNUE_ACTIVATION_MAX : us[i]);
+			const int themValue = them[i] < 0 ? 0 : (them[i] > NNUE_ACTIVATION_MAX ? NNUE_ACTIVATION_MAX : them[i]);
+			sum += usValue * weights[i] + themValue * weights[NNUE_HIDDEN_SIZE + i];
+		}
+		return sum;
+	}
+
+#ifdef HAS_X64_INTRINSICS
+	//SSE2 is part of every x64 cpu so it needs no target or cpu check
+	static constexpr int SSE2_LANES = 8;
+	static constexpr int AVX2_LANES = 16;
+
+	static void ApplyChangesSse2(const std::int16_t* input, std::int16_t* output, const std::int16_t* const* added,
+		const int addedCount, const std::int16_t* const* removed, const int removedCount)
+	{
+		for (int i = 0; i < NNUE_HIDDEN_SIZE; i += SSE2_LANES)
+		{
+			__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+			for (int row = 0; row < addedCount; row++)
+				value = _mm_add_epi16(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(added[row] + i)));
+			for (int row = 0; row < removedCount; row++)
+				value = _mm_sub_epi16(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(removed[row] + i)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), value);
+		}
+	}
+
+	static std::int32_t ForwardSse2(const std::int16_t* us, const std::int16_t* them, const std::int16_t* weights)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i activationMax = _mm_set1_epi16(NNUE_ACTIVATION_MAX);
+		__m128i sum = _mm_setzero_si128();
+		for (int i = 0; i < NNUE_HIDDEN_SIZE; i += SSE2_LANES)
+		{
+			const __m128i usValue = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(us + i)), zero), activationMax);
+			const __m128i themValue = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(them + i)), zero), activationMax);
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(usValue, _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i))));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(themValue,
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + NNUE_HIDDEN_SIZE + i))));
+		}
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(sum);
+	}
+
+	AVX2_TARGET static void ApplyChangesAvx2(const std::int16_t* input, std::int16_t* output, const std::int16_t* const* added,
+		const int addedCount, const std::int16_t* const* removed, const int removedCount)
+	{
+		for (int i = 0; i < NNUE_HIDDEN_SIZE; i += AVX2_LANES)
+		{
+			__m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+			for (int row = 0; row < addedCount; row++)
+				value = _mm256_add_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(added[row] + i)));
+			for (int row = 0; row < removedCount; row++)
+				value = _mm256_sub_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(removed[row] + i)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), value);
+		}
+	}
+
+	AVX2_TARGET static std::int32_t ForwardAvx2(const std::int16_t* us, const std::int16_t* them, const std::int16_t* weights)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i activationMax = _mm256_set1_epi16(NNUE_ACTIVATION_MAX);
+		__m256i sum = _mm256_setzero_si256();
+		for (int i = 0; i < NNUE_HIDDEN_SIZE; i += AVX2_LANES)
+		{
+			const __m256i usValue = _mm256_min_epi16(_mm256_max_epi16(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(us + i)), zero), activationMax);
+			const __m256i themValue = _mm256_min_epi16(_mm256_max_epi16(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(them + i)), zero), activationMax);
+			sum = _mm256_add_epi32(sum, _mm256_madd_epi16(usValue, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i))));
+			sum = _mm256_add_epi32(sum, _mm256_madd_epi16(themValue,
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + NNUE_HIDDEN_SIZE + i))));
+		}
+		__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+		half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(half);
+	}
+#endif
+
+	/// <summary>
+	/// AVX2 also needs the operating system to save the 256 bit registers on context switches,
+	/// which the gcc/clang builtin checks and which is checked with xgetbv on msvc
+	/// </summary>
+	/// <returns></returns>
+	static bool HasAvx2()
+	{
+#if defined(HAS_X64_INTRINSICS) && defined(_MSC_VER)
+		int registers[4] = {};
+		__cpuid(registers, 0);
+		if (registers[0] < 7) return false;
+
+		constexpr int OSXSAVE_BIT = 1 << 27;
+		constexpr int AVX_BIT = 1 << 28;
+		__cpuid(registers, 1);
+		if ((registers[2] & OSXSAVE_BIT) == 0 || (registers[2] & AVX_BIT) == 0) return false;
+		//The xmm and ymm register states must both be enabled
+		if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+		constexpr int AVX2_BIT = 1 << 5;
+		__cpuidex(registers, 7, 0);
+		return (registers[1] & AVX2_BIT) != 0;
+#elif defined(HAS_X64_INTRINSICS)
+		//The kernels are picked during static initialization which can run before the builtin is set up
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#else
+		return false;
+#endif
+	}
+
+	struct NnueKernels
+	{
+		SimdLevel Level;
+		ApplyChangesKernel ApplyChanges;
+		ForwardKernel Forward;
+	};
+
+	static NnueKernels CreateKernels(const SimdLevel level)
+	{
+#ifdef HAS_X64_INTRINSICS
+		if (level == SimdLevel::Avx2) return { level, ApplyChangesAvx2, ForwardAvx2 };
+		if (level == SimdLevel::Sse2) return { level, ApplyChangesSse2, ForwardSse2 };
+#endif
+		return { SimdLevel::Scalar, ApplyChangesScalar, ForwardScalar };
+	}
+
+	static SimdLevel GetBestSimdLevel()
+	{
+		if (IsSimdLevelSupported(SimdLevel::Avx2)) return SimdLevel::Avx2;
+		if (IsSimdLevelSupported(SimdLevel::Sse2)) return SimdLevel::Sse2;
+		return SimdLevel::Scalar;
+	}
+
+	static NnueKernels kernels = CreateKernels(GetBestSimdLevel());
+
+	std::string ToString(const SimdLevel level)
+	{
+		if (level == SimdLevel::Avx2) return "AVX2";
+		if (level == SimdLevel::Sse2) return "SSE2";
+		return "Scalar";
+	}
+
+	bool IsSimdLevelSupported(const SimdLevel level)
+	{
+#ifdef HAS_X64_INTRINSICS
+		if (level == SimdLevel::Avx2) return HasAvx2();
+		return true;
+#else
+		return level == SimdLevel::Scalar;
+#endif
+	}
+
+	SimdLevel GetNnueSimdLevel()
+	{
+		return kernels.Level;
+	}
+
+	bool TrySetNnueSimdLevel(const SimdLevel level)
+	{
+		if (!IsSimdLevelSupported(level))
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to set the network kernels to {} "
+				"but the cpu does not support them", ToString(level)));
+			return false;
+		}
+		kernels = CreateKernels(level);
+		return true;
+	}
+
+	//Positions without exactly one king of the color (like custom boards) use the first king or the first square
+	static Board::Square GetKingSquare(const Board::BitboardSet& board, const ArmyColor color)
+	{
+		const Board::Bitboard kings = board.GetPieces(color, PieceType::King);
+		return kings ? Board::GetLeastSignificantSquare(kings) : 0;
+	}
+
+	static int GetFeatureIndex(const ArmyColor perspective, const Board::Square kingSquare,
+		const Board::PieceCode code, const Board::Square square)
+	{
+		//Dark sees the board flipped vertically so both sides have their own pieces at the bottom
+		const int flip = perspective == ArmyColor::Light ? 0 : Board::SQUARE_COUNT - BOARD_DIMENSION;
+		const int pieceKind = (Board::GetColorFromCode(code) == perspective ? 0 : NNUE_PIECE_KINDS / 2) +
+			Board::ToIndex(Board::GetTypeFromCode(code));
+		return ((kingSquare ^ flip) * NNUE_PIECE_KINDS + pieceKind) * Board::SQUARE_COUNT + (square ^ flip);
+	}
+
+	NnueNetwork::NnueNetwork() : m_weights(nullptr) {}
+	NnueNetwork::~NnueNetwork() = default;
+
+	template<typename T>
+	static bool TryRead(std::ifstream& file, T* destination, const size_t count)
+	{
+		file.read(reinterpret_cast<char*>(destination), static_cast<std::streamsize>(sizeof(T) * count));
+		return static_cast<size_t>(file.gcount()) == sizeof(T) * count;
+	}
+
+	bool NnueNetwork::TryLoad(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open())
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to load the network at: {} but the file could not be opened", path));
+			return false;
+		}
+
+		std::array<std::uint32_t, 4> header = {};
+		if (!TryRead(file, header.data(), header.size()) || header[0] != NNUE_FILE_MAGIC || header[1] != NNUE_FILE_VERSION ||
+			header[2] != NNUE_FEATURE_COUNT || header[3] != NNUE_HIDDEN_SIZE)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to load the network at: {} but it is not a version {} "
+				"HalfKP network with {} hidden values", path, NNUE_FILE_VERSION, NNUE_HIDDEN_SIZE));
+			return false;
+		}
+
+		std::unique_ptr<Weights> weights(new (std::nothrow) Weights);
+		if (weights == nullptr)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to load the network at: {} "
+				"but the memory for the weights could not be allocated", path));
+			return false;
+		}
+
+		const bool hasReadWeights = TryRead(file, weights->FeatureBiases.data(), NNUE_HIDDEN_SIZE) &&
+			TryRead(file, weights->FeatureWeights.data(), NNUE_FEATURE_COUNT) &&
+			TryRead(file, weights->OutputWeights.data(), TEAMS_COUNT) && TryRead(file, &weights->OutputBias, 1);
+		//Anything after the weights means the file was made for another layout
+		if (!hasReadWeights || file.peek() != std::ifstream::traits_type::eof())
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to load the network at: {} "
+				"but the file does not have the size of the network", path));
+			return false;
+		}
+
+		m_weights = std::move(weights);
+		return true;
+	}
+
+	bool NnueNetwork::IsLoaded() const
+	{
+		return m_weights != nullptr;
+	}
+
+	void NnueNetwork::RefreshPerspective(const GameState& position, const ArmyColor perspective, NnueAccumulator& accumulator) const
+	{
+		const Board::BitboardSet& board = position.Bitboards;
+		const Board::Square kingSquare = GetKingSquare(board, perspective);
+		std::array<const std::int16_t*, MAX_CHANGED_FEATURES> added;
+		int addedCount = 0;
+
+		Board::Bitboard pieces = board.Occupancy & ~(board.GetPieces(ArmyColor::Light, PieceType::King) |
+													board.GetPieces(ArmyColor::Dark, PieceType::King));
+		while (pieces)
+		{
+			const Board::Square square = Board::PopLeastSignificantSquare(pieces);
+			added[addedCount++] = m_weights->FeatureWeights[GetFeatureIndex(perspective, kingSquare, board.PieceCodes[square], square)].data();
+		}
+		kernels.ApplyChanges(m_weights->FeatureBiases.data(), accumulator.Values[Board::ToIndex(perspective)].data(),
+			added.data(), addedCount, nullptr, 0);
+	}
+
+	void NnueNetwork::RefreshAccumulator(const GameState& position, NnueAccumulator& accumulator) const
+	{
+		RefreshPerspective(position, ArmyColor::Light, accumulator);
+		RefreshPerspective(position, ArmyColor::Dark, accumulator);
+	}
+
+	void NnueNetwork::UpdateAccumulator(const GameState& positionAfterMove, const NnueAccumulator& previous, NnueAccumulator& next) const
+	{
+		const StateInfo& info = positionAfterMove.StateHistory[positionAfterMove.StateHistoryCount - 1];
+		const Board::BitboardSet& board = positionAfterMove.Bitboards;
+		const Board::Move move = info.MovePlayed;
+		const Board::Square from = move.GetFrom();
+		const Board::Square to = move.GetTo();
+		const ArmyColor mover = GetOppositeColor(positionAfterMove.CurrentPlayer);
+
+		//The piece on the destination is the promoted piece for promotions while a pawn left the start square
+		const Board::PieceCode placedCode = board.PieceCodes[to];
+		const Board::PieceCode movedCode = move.IsPromotion() ? Board::ToPieceCode(mover, PieceType::Pawn) : placedCode;
+		const bool isKingMove = Board::GetTypeFromCode(movedCode) == PieceType::King;
+
+		for (const auto& perspective : { ArmyColor::Light, ArmyColor::Dark })
+		{
+			//Every feature depends on the king square so a king move changes all of them for its side
+			if (isKingMove && perspective == mover)
+			{
+				RefreshPerspective(positionAfterMove, perspective, next);
+				continue;
+			}
+
+			const Board::Square kingSquare = GetKingSquare(board, perspective);
+			const auto getRow = [&](const Board::PieceCode code, const Board::Square square) -> const std::int16_t*
+				{
+					return m_weights->FeatureWeights[GetFeatureIndex(perspective, kingSquare, code, square)].data();
+				};
+
+			std::array<const std::int16_t*, MAX_CHANGED_FEATURES> added;
+			std::array<const std::int16_t*, MAX_CHANGED_FEATURES> removed;
+			int addedCount = 0;
+			int removedCount = 0;
+			//Kings are not features so their own moves only matter through the king square
+			if (!isKingMove)
+			{
+				removed[removedCount++] = getRow(movedCode, from);
+				added[addedCount++] = getRow(placedCode, to);
+			}
+			if (info.CapturedCode != Board::NO_PIECE)
+			{
+				const Board::Square capturedSquare = move.GetFlag() != Board::MoveFlag::EnPassant ? to :
+					(mover == ArmyColor::Light ? to - BOARD_DIMENSION : to + BOARD_DIMENSION);
+				removed[removedCount++] = getRow(info.CapturedCode, capturedSquare);
+			}
+			if (move.IsCastle())
+			{
+				const Board::Square rookFrom = move.GetFlag() == Board::MoveFlag::KingSideCastle ? to + 1 : to - 2;
+				const Board::Square rookTo = move.GetFlag() == Board::MoveFlag::KingSideCastle ? to - 1 : to + 1;
+				const Board::PieceCode rookCode = Board::ToPieceCode(mover, PieceType::Rook);
+				removed[removedCount++] = getRow(rookCode, rookFrom);
+				added[addedCount++] = getRow(rookCode, rookTo);
+			}
+
+			const int index = Board::ToIndex(perspective);
+			kernels.ApplyChanges(previous.Values[index].data(), next.Values[index].data(),
+				added.data(), addedCount, removed.data(), removedCount);
+		}
+	}
+
+	int NnueNetwork::Evaluate(const NnueAccumulator& accumulator, const ArmyColor sideToMove) const
+	{
+		const std::int32_t output = kernels.Forward(accumulator.Values[Board::ToIndex(sideToMove)].data(),
+			accumulator.Values[Board::ToIndex(GetOppositeColor(sideToMove))].data(), m_weights->OutputWeights[0].data());
+		return static_cast<int>((static_cast<std::int64_t>(output) + m_weights->OutputBias) * NNUE_OUTPUT_SCALE /
+			(NNUE_ACTIVATION_MAX * NNUE_OUTPUT_WEIGHT_SCALE));
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "GameState.hpp"
+#include "Bitboard.hpp"
+#include "Color.hpp"
+#include "Globals.hpp"
+
+namespace Engine
+{
+	//HalfKP features: every non-king piece (5 types of each color) on every square, for every square of the king
+	//of the side the features are seen from. Both sides see the board with their own pieces at the bottom
+	constexpr int NNUE_PIECE_KINDS = 10;
+	constexpr int NNUE_FEATURE_COUNT = Board::SQUARE_COUNT * NNUE_PIECE_KINDS * Board::SQUARE_COUNT;
+	constexpr int NNUE_HIDDEN_SIZE = 256;
+
+	//Hidden values are clipped to [0, NNUE_ACTIVATION_MAX] and the output is divided by the activation
+	//and output weight scales the network was quantized with and multiplied back to centipawns
+	constexpr int NNUE_ACTIVATION_MAX = 255;
+	constexpr int NNUE_OUTPUT_WEIGHT_SCALE = 64;
+	constexpr int NNUE_OUTPUT_SCALE = 400;
+
+	constexpr std::uint32_t NNUE_FILE_MAGIC = 0x45554E4E;
+	constexpr std::uint32_t NNUE_FILE_VERSION = 1;
+
+	/// <summary>
+	/// The vector instructions the network kernels run with. The best one the cpu supports is picked at startup
+	/// </summary>
+	enum class SimdLevel
+	{
+		Scalar,
+		Sse2,
+		Avx2,
+	};
+
+	std::string ToString(const SimdLevel level);
+
+	/// <summary>
+	/// The first layer output (before clipping) from the point of view of each color,
+	/// which only changes by a few weight rows when a move is made
+	/// </summary>
+	struct alignas(64) NnueAccumulator
+	{
+		std::array<std::array<std::int16_t, NNUE_HIDDEN_SIZE>, TEAMS_COUNT> Values;
+	};
+
+	/// <summary>
+	/// Efficiently updatable neural network evaluation (HalfKP -> 2x256 -> 1) that runs on the cpu.
+	/// The search keeps one accumulator per ply and updates it from the one before with the pieces the move changed,
+	/// so evaluating a node is only the small output layer.
+	/// The file is little endian: magic, version, feature count and hidden size (uint32 each), then the int16 feature
+	/// biases [hidden], int16 feature weights [features][hidden], int16 output weights [2][hidden] and an int32 output bias
+	/// </summary>
+	class NnueNetwork
+	{
+	private:
+		struct Weights;
+		std::unique_ptr<Weights> m_weights;
+
+		void RefreshPerspective(const GameState& position, const ArmyColor perspective, NnueAccumulator& accumulator) const;
+
+	public:
+		NnueNetwork();
+		~NnueNetwork();
+
+		/// <summary>
+		/// Loads the network from the binary file. The current network is kept if the file is not valid.
+		/// Must not be called during a search that uses the network
+		/// </summary>
+		/// <param name="path"></param>
+		/// <returns></returns>
+		bool TryLoad(const std::string& path);
+		bool IsLoaded() const;
+
+		/// <summary>
+		/// Calculates the accumulator of the position from scratch
+		/// </summary>
+		/// <param name="position"></param>
+		/// <param name="accumulator"></param>
+		void RefreshAccumulator(const GameState& position, NnueAccumulator& accumulator) const;
+
+		/// <summary>
+		/// Calculates the accumulator of the position from the accumulator of the position before its last move
+		/// (read from the state history). Only the side whose king moved is calculated from scratch
+		/// </summary>
+		/// <param name="positionAfterMove"></param>
+		/// <param name="previous"></param>
+		/// <param name="next"></param>
+		void UpdateAccumulator(const GameState& positionAfterMove, const NnueAccumulator& previous, NnueAccumulator& next) const;
+
+		/// <summary>
+		/// Returns the score in centipawns from the point of view of the side to move
+		/// </summary>
+		/// <param name="accumulator"></param>
+		/// <param name="sideToMove"></param>
+		/// <returns></returns>
+		int Evaluate(const NnueAccumulator& accumulator, const ArmyColor sideToMove) const;
+	};
+
+	bool IsSimdLevelSupported(const SimdLevel level);
+	SimdLevel GetNnueSimdLevel();
+
+	/// <summary>
+	/// Switches the kernels every network uses (for benchmarking the levels against each other).
+	/// Must not be called during a search
+	/// </summary>
+	/// <param name="level"></param>
+	/// <returns></returns>
+	bool TrySetNnueSimdLevel(const SimdLevel level);
+}
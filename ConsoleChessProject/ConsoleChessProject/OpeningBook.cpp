@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+#include "OpeningBook.hpp"
+#include "Search.hpp"
+#include "Pgn.hpp"
+#include "MoveGeneration.hpp"
+#include "MoveExecution.hpp"
+#include "BoardManager.hpp"
+#include "HelperFunctions.hpp"
+
+namespace Engine
+{
+	struct OpeningBookFileHeader
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint64_t EntryCount;
+	};
+	static_assert(sizeof(OpeningBookFileHeader) == 16, "The opening book file header must not have padding");
+
+	//"CCBK"
+	static constexpr std::uint32_t OPENING_BOOK_MAGIC = 0x4B424343;
+	static constexpr std::uint32_t OPENING_BOOK_VERSION = 1;
+
+	static constexpr std::uint32_t WIN_BOOK_WEIGHT = 2;
+	static constexpr std::uint32_t DRAW_BOOK_WEIGHT = 1;
+	//The moves read are merged once there are this many so the memory used grows with the different moves and not the games
+	static constexpr size_t BOOK_MERGE_THRESHOLD = 1 << 22;
+
+	static bool IsEntryBefore(const OpeningBookEntry& entry, const Board::ZobristKey hash)
+	{
+		return entry.Hash < hash;
+	}
+
+	OpeningBook::OpeningBook() : m_file(nullptr), m_entries(nullptr), m_entryCount(0) {}
+
+	OpeningBook::~OpeningBook() = default;
+
+	bool OpeningBook::TryLoad(const std::string& path)
+	{
+		auto file = std::make_unique<Utils::MappedFile>(path);
+		if (!file->IsMapped())
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to load the opening book at: {} but it could not be mapped", path));
+			return false;
+		}
+
+		OpeningBookFileHeader header = {};
+		if (file->GetSize() >= sizeof(header)) std::memcpy(&header, file->GetData(), sizeof(header));
+		const bool isValid = header.Magic == OPENING_BOOK_MAGIC && header.Version == OPENING_BOOK_VERSION &&
+			file->GetSize() == sizeof(header) + header.EntryCount * sizeof(OpeningBookEntry);
+		if (!isValid)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to load the opening book at: {} but it is not a version {} book",
+				path, OPENING_BOOK_VERSION));
+			return false;
+		}
+
+		//The header keeps the entries 8 byte aligned since mappings start on a page
+		m_entries = reinterpret_cast<const OpeningBookEntry*>(file->GetData() + sizeof(header));
+		m_entryCount = static_cast<size_t>(header.EntryCount);
+		m_file = std::move(file);
+		return true;
+	}
+
+	void OpeningBook::Unload()
+	{
+		m_entries = nullptr;
+		m_entryCount = 0;
+		m_file.reset();
+	}
+
+	bool OpeningBook::IsLoaded() const
+	{
+		return m_file != nullptr;
+	}
+
+	size_t OpeningBook::GetEntryCount() const
+	{
+		return m_entryCount;
+	}
+
+	std::span<const OpeningBookEntry> OpeningBook::FindEntries(const Board::ZobristKey hash) const
+	{
+		if (m_entries == nullptr) return {};
+
+		const OpeningBookEntry* end = m_entries + m_entryCount;
+		const OpeningBookEntry* first = std::lower_bound(m_entries, end, hash, IsEntryBefore);
+		const OpeningBookEntry* last = first;
+		while (last != end && last->Hash == hash) last++;
+		return { first, last };
+	}
+
+	Board::Move OpeningBook::PickMove(const GameState& state, const std::uint64_t randomNumber) const
+	{
+		const std::span<const OpeningBookEntry> entries = FindEntries(state.Hash);
+		if (entries.empty()) return Board::NULL_MOVE;
+
+		//A different position with the same hash would have moves that are not legal here
+		Board::MoveList legalMoves;
+		Board::GenerateLegalMoves(state, legalMoves);
+		std::uint64_t totalWeight = 0;
+		for (const auto& entry : entries)
+		{
+			if (legalMoves.Contains(Board::Move(entry.Move))) totalWeight += entry.Weight;
+		}
+		if (totalWeight == 0) return Board::NULL_MOVE;
+
+		std::uint64_t target = randomNumber % totalWeight;
+		for (const auto& entry : entries)
+		{
+			const Board::Move move(entry.Move);
+			if (!legalMoves.Contains(move)) continue;
+			if (target < entry.Weight) return move;
+			target -= entry.Weight;
+		}
+		return Board::NULL_MOVE;
+	}
+
+	//Weights are summed in 32 bits while building and only scaled down to fit the file at the end
+	struct BookMoveCount
+	{
+		Board::ZobristKey Hash;
+		std::uint16_t Move;
+		std::uint32_t Weight;
+	};
+
+	static void MergeMoveCounts(std::vector<BookMoveCount>& counts)
+	{
+		std::sort(counts.begin(), counts.end(), [](const BookMoveCount& first, const BookMoveCount& second) -> bool
+			{
+				return first.Hash != second.Hash ? first.Hash < second.Hash : first.Move < second.Move;
+			});
+
+		size_t mergedCount = 0;
+		for (const auto& count : counts)
+		{
+			if (mergedCount > 0 && counts[mergedCount - 1].Hash == count.Hash && counts[mergedCount - 1].Move == count.Move)
+			{
+				std::uint32_t& weight = counts[mergedCount - 1].Weight;
+				weight = static_cast<std::uint32_t>(std::min<std::uint64_t>(std::uint64_t{ weight } + count.Weight,
+					std::numeric_limits<std::uint32_t>::max()));
+				continue;
+			}
+			counts[mergedCount++] = count;
+		}
+		counts.resize(mergedCount);
+	}
+
+	static std::uint32_t GetGameWeight(const std::string& result, const ArmyColor mover)
+	{
+		if (result == Board::PGN_LIGHT_WIN_RESULT) return mover == ArmyColor::Light ? WIN_BOOK_WEIGHT : 0;
+		if (result == Board::PGN_DARK_WIN_RESULT) return mover == ArmyColor::Dark ? WIN_BOOK_WEIGHT : 0;
+		return DRAW_BOOK_WEIGHT;
+	}
+
+	/// <summary>
+	/// Turns the merged counts into entries, leaving out moves with no weight and scaling each position's weights
+	/// down together when its biggest one does not fit in 16 bits
+	/// </summary>
+	static std::vector<OpeningBookEntry> CreateEntries(const std::vector<BookMoveCount>& counts, std::uint64_t& positionCount)
+	{
+		std::vector<OpeningBookEntry> entries;
+		positionCount = 0;
+		size_t positionStart = 0;
+		while (positionStart < counts.size())
+		{
+			size_t positionEnd = positionStart;
+			std::uint32_t maxWeight = 0;
+			while (positionEnd < counts.size() && counts[positionEnd].Hash == counts[positionStart].Hash)
+			{
+				maxWeight = std::max(maxWeight, counts[positionEnd].Weight);
+				positionEnd++;
+			}
+
+			const std::uint32_t divisor = maxWeight / (std::numeric_limits<std::uint16_t>::max() + 1) + 1;
+			const size_t entryCountBefore = entries.size();
+			for (size_t i = positionStart; i < positionEnd; i++)
+			{
+				if (counts[i].Weight == 0) continue;
+				const std::uint32_t weight = std::max<std::uint32_t>(counts[i].Weight / divisor, 1);
+				entries.push_back({ counts[i].Hash, counts[i].Move, static_cast<std::uint16_t>(weight), 0 });
+			}
+			if (entries.size() > entryCountBefore) positionCount++;
+			positionStart = positionEnd;
+		}
+		return entries;
+	}
+
+	static bool TryWriteBook(const std::string& path, const std::vector<OpeningBookEntry>& entries)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to write the opening book at: {} but the file could not be opened", path));
+			return false;
+		}
+
+		const OpeningBookFileHeader header = { OPENING_BOOK_MAGIC, OPENING_BOOK_VERSION, entries.size() };
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(OpeningBookEntry)));
+		if (!file)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to write the opening book at: {} but writing failed", path));
+			return false;
+		}
+		return true;
+	}
+
+	bool TryBuildOpeningBook(const std::vector<std::string>& pgnPaths, const std::string& bookPath, const int maxPly,
+		OpeningBookBuildReport& report)
+	{
+		report = {};
+		if (maxPly < 1)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to build an opening book to ply {} but it must be at least 1", maxPly));
+			return false;
+		}
+
+		const auto startTime = std::chrono::steady_clock::now();
+		//Positions are too large for the stack. Games from the standard start copy it instead of parsing the FEN again
+		auto startPosition = std::make_unique<GameState>();
+		auto position = std::make_unique<GameState>();
+		if (!Board::TryLoadFen(*startPosition, Board::START_POSITION_FEN)) return false;
+
+		std::vector<BookMoveCount> counts;
+		Board::PgnGame game;
+		for (const auto& pgnPath : pgnPaths)
+		{
+			std::ifstream pgnFile(pgnPath);
+			if (!pgnFile.is_open())
+			{
+				Utils::Log(Utils::LogType::Error, std::format("Tried to read the games at: {} but the file could not be opened", pgnPath));
+				return false;
+			}
+
+			Board::PgnReader reader(pgnFile);
+			while (reader.TryReadGame(game))
+			{
+				report.GameCount++;
+				bool hasStart = true;
+				if (Board::TryGetPgnTag(game, "FEN").has_value()) hasStart = Board::TryLoadPgnStartPosition(*position, game);
+				else CopyPosition(*startPosition, *position);
+
+				size_t movesAdded = 0;
+				const size_t plyCount = std::min(game.Moves.size(), static_cast<size_t>(maxPly));
+				for (size_t ply = 0; hasStart && ply < plyCount; ply++)
+				{
+					Board::Move move;
+					//The rest of a game with a move that can not be read is skipped since the positions after it are unknown
+					if (!Board::TryParseSanMove(*position, game.Moves[ply], move)) break;
+
+					counts.push_back({ position->Hash, move.GetData(), GetGameWeight(game.Result, position->CurrentPlayer) });
+					movesAdded++;
+					if (!Board::MakeMove(*position, move)) break;
+				}
+
+				if (movesAdded == 0) report.SkippedGameCount++;
+				if (counts.size() >= BOOK_MERGE_THRESHOLD) MergeMoveCounts(counts);
+			}
+		}
+
+		MergeMoveCounts(counts);
+		const std::vector<OpeningBookEntry> entries = CreateEntries(counts, report.PositionCount);
+		report.EntryCount = entries.size();
+		report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		return TryWriteBook(bookPath, entries);
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "GameState.hpp"
+#include "Move.hpp"
+#include "Zobrist.hpp"
+#include "MappedFile.hpp"
+
+namespace Engine
+{
+	//Positions deeper than this many plies into a game are not added to a book unless asked for
+	constexpr int DEFAULT_BOOK_MAX_PLY = 24;
+	constexpr const char* OPENING_BOOK_FILE_EXTENSION = ".ccbk";
+
+	/// <summary>
+	/// One move of a book position. Entries are sorted by hash and then move so all moves of a position are next to each other
+	/// </summary>
+	struct OpeningBookEntry
+	{
+		Board::ZobristKey Hash;
+		//Board::Move::GetData of the move
+		std::uint16_t Move;
+		//How likely the move is picked compared to the other moves of the position
+		std::uint16_t Weight;
+		std::uint32_t Reserved;
+	};
+	static_assert(sizeof(OpeningBookEntry) == 16, "Opening book entries must not have padding");
+
+	struct OpeningBookBuildReport
+	{
+		std::uint64_t GameCount;
+		//Games that were not used at all since their start position or first move could not be read
+		std::uint64_t SkippedGameCount;
+		std::uint64_t PositionCount;
+		std::uint64_t EntryCount;
+		double Seconds;
+	};
+
+	/// <summary>
+	/// Moves to play without searching in known opening positions, read from a file that is mapped into memory.
+	/// Looking up a position is a binary search over the mapped entries so it never allocates or parses anything.
+	/// The file is little endian: magic, version (uint32 each) and entry count (uint64), then the sorted entries
+	/// </summary>
+	class OpeningBook
+	{
+	private:
+		std::unique_ptr<Utils::MappedFile> m_file;
+		const OpeningBookEntry* m_entries;
+		size_t m_entryCount;
+
+	public:
+		OpeningBook();
+		~OpeningBook();
+
+		OpeningBook(const OpeningBook&) = delete;
+		OpeningBook& operator=(const OpeningBook&) = delete;
+
+		/// <summary>
+		/// Maps the book file, replacing the book loaded before. The current book is kept if the file is not valid.
+		/// Must not be called while another thread picks moves from the book
+		/// </summary>
+		/// <param name="path"></param>
+		/// <returns></returns>
+		bool TryLoad(const std::string& path);
+		void Unload();
+		bool IsLoaded() const;
+		size_t GetEntryCount() const;
+
+		/// <summary>
+		/// Returns the entries of the position (empty when it is not in the book)
+		/// </summary>
+		/// <param name="hash"></param>
+		/// <returns></returns>
+		std::span<const OpeningBookEntry> FindEntries(const Board::ZobristKey hash) const;
+
+		/// <summary>
+		/// Picks one of the legal book moves of the position with a chance in proportion to its weight, with the
+		/// random number (any 64 bit value) deciding which. NULL_MOVE when the position has no legal book move
+		/// </summary>
+		/// <param name="state"></param>
+		/// <param name="randomNumber"></param>
+		/// <returns></returns>
+		Board::Move PickMove(const GameState& state, const std::uint64_t randomNumber) const;
+	};
+
+	/// <summary>
+	/// Replays the main line of every game in the PGN files up to the ply and writes the moves that were played
+	/// from each position into a book file. Each game adds 2 to the weight of its winner's moves, 1 to both sides' moves
+	/// when it is drawn or has no result and nothing to the loser's, so moves that only ever lost are left out.
+	/// The files are streamed so they can be any size
+	/// </summary>
+	/// <param name="pgnPaths"></param>
+	/// <param name="bookPath"></param>
+	/// <param name="maxPly"></param>
+	/// <param name="report"></param>
+	/// <returns></returns>
+	bool TryBuildOpeningBook(const std::vector<std::string>& pgnPaths, const std::string& bookPath, const int maxPly,
+		OpeningBookBuildReport& report);
+}
@@ -0,0 +1,94 @@
+#include <chrono>
+#include <format>
+#include <vector>
+#include "Perft.hpp"
+#include "MoveGeneration.hpp"
+#include "MoveExecution.hpp"
+#include "HelperFunctions.hpp"
+
+namespace Board
+{
+	static const std::vector<PerftReferencePosition> PERFT_REFERENCE_POSITIONS =
+	{
+		{ "Initial", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+			{ 20, 400, 8902, 197281, 4865609, 119060324 } },
+		{ "Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+			{ 48, 2039, 97862, 4085603, 193690690, 0 } },
+		{ "Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+			{ 14, 191, 2812, 43238, 674624, 11030083 } },
+		{ "Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+			{ 6, 264, 9467, 422333, 15833292, 0 } },
+		{ "Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+			{ 44, 1486, 62379, 2103487, 89941194, 0 } },
+		{ "Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+			{ 46, 2079, 89890, 3894594, 164075551, 0 } },
+	};
+
+	const std::vector<PerftReferencePosition>& GetPerftReferencePositions()
+	{
+		return PERFT_REFERENCE_POSITIONS;
+	}
+
+	static std::uint64_t PerftRecursive(GameState& state, const int depth)
+	{
+		MoveList moves;
+		GenerateLegalMoves(state, moves);
+		//Leaves are counted straight from the generated list (bulk counting) since every move is legal
+		if (depth == 1) return moves.Size();
+
+		std::uint64_t nodes = 0;
+		for (const auto& move : moves)
+		{
+			MakeMove(state, move);
+			nodes += PerftRecursive(state, depth - 1);
+			UnmakeMove(state);
+		}
+		return nodes;
+	}
+
+	static bool IsValidPerftDepth(const GameState& state, const int depth)
+	{
+		if (depth >= 1 && state.StateHistoryCount + depth <= MAX_STATE_HISTORY) return true;
+
+		Utils::Log(Utils::LogType::Error, std::format("Tried to run perft to depth: {} but it must be at least 1 "
+			"and fit in the state history ({} of {} used)", depth, state.StateHistoryCount, MAX_STATE_HISTORY));
+		return false;
+	}
+
+	std::uint64_t Perft(GameState& state, const int depth)
+	{
+		if (!IsValidPerftDepth(state, depth)) return 0;
+		return PerftRecursive(state, depth);
+	}
+
+	PerftResult RunPerft(GameState& state, const int depth, const bool divide)
+	{
+		PerftResult result = { 0, 0, 0, {} };
+		if (!IsValidPerftDepth(state, depth)) return result;
+
+		const auto startTime = std::chrono::steady_clock::now();
+		if (!divide) result.Nodes = PerftRecursive(state, depth);
+		else
+		{
+			MoveList rootMoves;
+			GenerateLegalMoves(state, rootMoves);
+			result.Divide.reserve(rootMoves.Size());
+			for (const auto& move : rootMoves)
+			{
+				std::uint64_t nodes = 1;
+				if (depth > 1)
+				{
+					MakeMove(state, move);
+					nodes = PerftRecursive(state, depth - 1);
+					UnmakeMove(state);
+				}
+				result.Divide.push_back({ move, nodes });
+				result.Nodes += nodes;
+			}
+		}
+
+		result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		result.NodesPerSecond = result.Seconds > 0 ? static_cast<std::uint64_t>(result.Nodes / result.Seconds) : 0;
+		return result;
+	}
+}
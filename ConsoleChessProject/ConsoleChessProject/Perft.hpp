@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "GameState.hpp"
+#include "Move.hpp"
+
+namespace Board
+{
+	struct PerftDivideEntry
+	{
+		Move RootMove;
+		std::uint64_t Nodes;
+	};
+
+	struct PerftResult
+	{
+		std::uint64_t Nodes;
+		double Seconds;
+		std::uint64_t NodesPerSecond;
+		//Only filled by divide runs, with one entry per legal root move
+		std::vector<PerftDivideEntry> Divide;
+	};
+
+	//Enough depths for every reference count we check against
+	constexpr size_t MAX_REFERENCE_PERFT_DEPTH = 6;
+
+	struct PerftReferencePosition
+	{
+		std::string Name;
+		std::string Fen;
+		//Expected leaf nodes where index 0 is depth 1 (0 means the count is not listed)
+		std::array<std::uint64_t, MAX_REFERENCE_PERFT_DEPTH> ExpectedNodes;
+	};
+
+	/// <summary>
+	/// The standard perft positions with their published node counts. Together they cover
+	/// castling, en passant, promotions, discovered checks and pins
+	/// </summary>
+	const std::vector<PerftReferencePosition>& GetPerftReferencePositions();
+
+	/// <summary>
+	/// Counts the leaf nodes of the legal move tree from the state to the depth using MakeMove/UnmakeMove.
+	/// The state is restored before returning. Returns 0 if the depth does not fit in the state history
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="depth"></param>
+	/// <returns></returns>
+	std::uint64_t Perft(GameState& state, const int depth);
+
+	/// <summary>
+	/// Runs perft and times it. With divide the nodes under each root move are also returned
+	/// so a wrong total can be narrowed down to the move that generates it
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="depth"></param>
+	/// <param name="divide"></param>
+	/// <returns></returns>
+	PerftResult RunPerft(GameState& state, const int depth, const bool divide);
+}
@@ -0,0 +1,202 @@
+#include <iostream>
+#include <string>
+#include <memory>
+#include <format>
+#include <vector>
+#include <cstdint>
+#include "GameState.hpp"
+#include "BoardManager.hpp"
+#include "MoveGeneration.hpp"
+#include "MoveExecution.hpp"
+#include "Zobrist.hpp"
+#include "PieceSquareTables.hpp"
+#include "Nnue.hpp"
+#include "Perft.hpp"
+
+//Headless entry point for counting move generation nodes (built as its own console target with CONSOLE_LOGGING defined):
+//	perft <depth> [fen]		nodes and nodes per second (the default board when no fen is given)
+//	divide <depth> [fen]	nodes under each root move
+//	suite [maxDepth]		every reference position checked against its published counts
+//	verify [depth] [network]	every node of the reference positions' trees checked for the incremental hash, evaluation
+//								and network accumulators (when a network is given) matching the ones calculated from scratch
+
+static constexpr int DEFAULT_SUITE_DEPTH = 5;
+static constexpr int DEFAULT_VERIFY_DEPTH = 3;
+
+//Nodes whose incremental values did not match the ones calculated from scratch
+struct VerifyCounts
+{
+	std::uint64_t Nodes;
+	std::uint64_t HashMismatches;
+	std::uint64_t EvaluationMismatches;
+	std::uint64_t AccumulatorMismatches;
+};
+
+static void PrintUsage()
+{
+	std::cout << "Usage:\n"
+		<< "  perft <depth> [fen]\n"
+		<< "  divide <depth> [fen]\n"
+		<< "  suite [maxDepth]\n"
+		<< "  verify [depth] [network]" << std::endl;
+}
+
+static bool TrySetupState(GameState& state, const std::string& fen)
+{
+	if (fen.empty())
+	{
+		Board::CreateDefaultBoard(state);
+		return true;
+	}
+	return Board::TryLoadFen(state, fen);
+}
+
+static std::string GetRemainingArgs(const int argc, char* argv[], const int startIndex)
+{
+	std::string args;
+	for (int i = startIndex; i < argc; i++)
+	{
+		if (!args.empty()) args += ' ';
+		args += argv[i];
+	}
+	return args;
+}
+
+static void PrintResult(const Board::PerftResult& result)
+{
+	for (const auto& entry : result.Divide)
+	{
+		std::cout << std::format("{}: {}", Board::ToCoordinateNotation(entry.RootMove), entry.Nodes) << std::endl;
+	}
+	std::cout << std::format("Nodes: {} Time: {:.3f}s NPS: {}", result.Nodes, result.Seconds, result.NodesPerSecond) << std::endl;
+}
+
+static int RunSuite(const int maxDepth)
+{
+	//The game state holds the whole undo stack so it lives on the heap
+	auto state = std::make_unique<GameState>();
+	int failedCount = 0;
+	std::uint64_t totalNodes = 0;
+	double totalSeconds = 0;
+
+	for (const auto& position : Board::GetPerftReferencePositions())
+	{
+		if (!Board::TryLoadFen(*state, position.Fen)) return 1;
+		for (int depth = 1; depth <= maxDepth && depth <= static_cast<int>(Board::MAX_REFERENCE_PERFT_DEPTH); depth++)
+		{
+			const std::uint64_t expected = position.ExpectedNodes[depth - 1];
+			if (expected == 0) continue;
+
+			const Board::PerftResult result = Board::RunPerft(*state, depth, false);
+			const bool passed = result.Nodes == expected;
+			if (!passed) failedCount++;
+			totalNodes += result.Nodes;
+			totalSeconds += result.Seconds;
+
+			std::cout << std::format("[{}] {} depth {}: {} (expected {}) {:.3f}s {} nps", passed ? "PASS" : "FAIL",
+				position.Name, depth, result.Nodes, expected, result.Seconds, result.NodesPerSecond) << std::endl;
+		}
+	}
+
+	const std::uint64_t totalNodesPerSecond = totalSeconds > 0 ? static_cast<std::uint64_t>(totalNodes / totalSeconds) : 0;
+	std::cout << std::format("Total nodes: {} Time: {:.3f}s NPS: {} Failed: {}", 
+		totalNodes, totalSeconds, totalNodesPerSecond, failedCount) << std::endl;
+	return failedCount == 0 ? 0 : 1;
+}
+
+static bool IsSameEvaluation(const Board::EvaluationScore& a, const Board::EvaluationScore& b)
+{
+	return a.Material == b.Material && a.Score.Middlegame == b.Score.Middlegame && 
+		a.Score.Endgame == b.Score.Endgame && a.Phase == b.Phase;
+}
+
+//The accumulators hold one entry per ply so each child is updated from its parent like in the search (nullptr without a network)
+static void VerifyRecursive(GameState& state, const int depth, const Engine::NnueNetwork* network, 
+	Engine::NnueAccumulator* accumulators, VerifyCounts& counts)
+{
+	counts.Nodes++;
+	if (state.Hash != Board::CalculateHash(state)) counts.HashMismatches++;
+	if (!IsSameEvaluation(state.Evaluation, Board::CalculateEvaluationScore(state.Bitboards))) counts.EvaluationMismatches++;
+	if (network != nullptr)
+	{
+		Engine::NnueAccumulator refreshed;
+		network->RefreshAccumulator(state, refreshed);
+		if (refreshed.Values != accumulators[0].Values) counts.AccumulatorMismatches++;
+	}
+	if (depth == 0) return;
+
+	const std::uint64_t hashBefore = state.Hash;
+	const Board::EvaluationScore evaluationBefore = state.Evaluation;
+	Board::MoveList moves;
+	Board::GenerateLegalMoves(state, moves);
+	for (const auto& move : moves)
+	{
+		Board::MakeMove(state, move);
+		if (network != nullptr) network->UpdateAccumulator(state, accumulators[0], accumulators[1]);
+		VerifyRecursive(state, depth - 1, network, accumulators + 1, counts);
+		Board::UnmakeMove(state);
+
+		//Unmaking has to give back exactly what was there before the move
+		if (state.Hash != hashBefore) counts.HashMismatches++;
+		if (!IsSameEvaluation(state.Evaluation, evaluationBefore)) counts.EvaluationMismatches++;
+	}
+}
+
+static int RunVerify(const int depth, const std::string& networkPath)
+{
+	if (depth < 0 || depth > static_cast<int>(MAX_STATE_HISTORY))
+	{
+		std::cout << std::format("Tried to verify to depth: {} but it must be from 0 to {}", depth, MAX_STATE_HISTORY) << std::endl;
+		return 1;
+	}
+
+	Engine::NnueNetwork network;
+	if (!networkPath.empty() && !network.TryLoad(networkPath)) return 1;
+	const Engine::NnueNetwork* usedNetwork = networkPath.empty() ? nullptr : &network;
+	std::vector<Engine::NnueAccumulator> accumulators(depth + 1);
+
+	auto state = std::make_unique<GameState>();
+	int failedCount = 0;
+	for (const auto& position : Board::GetPerftReferencePositions())
+	{
+		if (!Board::TryLoadFen(*state, position.Fen)) return 1;
+		if (usedNetwork != nullptr) usedNetwork->RefreshAccumulator(*state, accumulators[0]);
+
+		VerifyCounts counts = { 0, 0, 0, 0 };
+		VerifyRecursive(*state, depth, usedNetwork, accumulators.data(), counts);
+		const bool passed = counts.HashMismatches == 0 && counts.EvaluationMismatches == 0 && counts.AccumulatorMismatches == 0;
+		if (!passed) failedCount++;
+
+		std::cout << std::format("[{}] {} depth {}: {} nodes, hash mismatches: {} evaluation mismatches: {} accumulator mismatches: {}", 
+			passed ? "PASS" : "FAIL", position.Name, depth, counts.Nodes, counts.HashMismatches, counts.EvaluationMismatches, 
+			usedNetwork != nullptr ? std::to_string(counts.AccumulatorMismatches) : "not checked") << std::endl;
+	}
+
+	std::cout << std::format("Failed: {}", failedCount) << std::endl;
+	return failedCount == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::string command = argc > 1 ? argv[1] : "suite";
+	if (command == "suite")
+	{
+		return RunSuite(argc > 2 ? std::stoi(argv[2]) : DEFAULT_SUITE_DEPTH);
+	}
+	if (command == "verify")
+	{
+		return RunVerify(argc > 2 ? std::stoi(argv[2]) : DEFAULT_VERIFY_DEPTH, argc > 3 ? argv[3] : "");
+	}
+
+	if ((command != "perft" && command != "divide") || argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	auto state = std::make_unique<GameState>();
+	if (!TrySetupState(*state, GetRemainingArgs(argc, argv, 3))) return 1;
+
+	PrintResult(Board::RunPerft(*state, std::stoi(argv[2]), command == "divide"));
+	return 0;
+}
@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include "Pgn.hpp"
+#include "BoardManager.hpp"
+#include "MoveGeneration.hpp"
+#include "MoveExecution.hpp"
+#include "Bitboard.hpp"
+#include "Piece.hpp"
+#include "HelperFunctions.hpp"
+
+namespace Board
+{
+	static bool IsTokenEnd(const int character)
+	{
+		return character == std::char_traits<char>::eof() || std::isspace(character) || character == '{' || character == '}' ||
+			character == '(' || character == ')' || character == '[' || character == ']' || character == ';';
+	}
+
+	static bool IsResultToken(const std::string& token)
+	{
+		return token == PGN_LIGHT_WIN_RESULT || token == PGN_DARK_WIN_RESULT || token == PGN_DRAW_RESULT || token == PGN_UNKNOWN_RESULT;
+	}
+
+	PgnReader::PgnReader(std::istream& stream) : m_stream(stream), m_gameCount(0) {}
+
+	void PgnReader::SkipUntil(const char end)
+	{
+		int character = m_stream.get();
+		while (character != std::char_traits<char>::eof() && character != end) character = m_stream.get();
+	}
+
+	void PgnReader::SkipVariation()
+	{
+		//Variations can hold variations and comments of their own (and comments can have parentheses)
+		int depth = 0;
+		int character = m_stream.get();
+		while (character != std::char_traits<char>::eof())
+		{
+			if (character == '{') SkipUntil('}');
+			else if (character == ';') SkipUntil('\n');
+			else if (character == '(') depth++;
+			else if (character == ')' && --depth == 0) return;
+			character = m_stream.get();
+		}
+	}
+
+	bool PgnReader::TryReadTag(PgnGame& game)
+	{
+		//[Name "Value"] where the value can have escaped quotes and backslashes
+		m_stream.get();
+		std::string name;
+		while (m_stream.peek() != std::char_traits<char>::eof() && !std::isspace(m_stream.peek()) && m_stream.peek() != ']')
+		{
+			name += static_cast<char>(m_stream.get());
+		}
+
+		std::string value;
+		int character = m_stream.get();
+		while (character != std::char_traits<char>::eof() && character != '"' && character != ']') character = m_stream.get();
+		if (character == '"')
+		{
+			character = m_stream.get();
+			while (character != std::char_traits<char>::eof() && character != '"')
+			{
+				if (character == '\\') character = m_stream.get();
+				if (character != std::char_traits<char>::eof()) value += static_cast<char>(character);
+				character = m_stream.get();
+			}
+			SkipUntil(']');
+		}
+
+		if (name.empty()) return false;
+		game.Tags.emplace_back(name, value);
+		return true;
+	}
+
+	std::string PgnReader::ReadToken()
+	{
+		std::string token;
+		while (!IsTokenEnd(m_stream.peek())) token += static_cast<char>(m_stream.get());
+		return token;
+	}
+
+	bool PgnReader::TryReadGame(PgnGame& game)
+	{
+		game.Tags.clear();
+		game.Moves.clear();
+		game.Result = PGN_UNKNOWN_RESULT;
+		bool hasContent = false;
+
+		while (true)
+		{
+			const int character = m_stream.peek();
+			if (character == std::char_traits<char>::eof()) break;
+			if (std::isspace(character))
+			{
+				m_stream.get();
+				continue;
+			}
+
+			if (character == '[')
+			{
+				//Tags after moves belong to the next game so the game before ended without a result
+				if (!game.Moves.empty()) break;
+				if (TryReadTag(game)) hasContent = true;
+				continue;
+			}
+			if (character == '{')
+			{
+				SkipUntil('}');
+				continue;
+			}
+			if (character == ';' || character == '%')
+			{
+				SkipUntil('\n');
+				continue;
+			}
+			if (character == '(')
+			{
+				SkipVariation();
+				continue;
+			}
+
+			std::string token = ReadToken();
+			if (token.empty())
+			{
+				//A stray closing bracket or parenthesis
+				m_stream.get();
+				continue;
+			}
+			if (IsResultToken(token))
+			{
+				game.Result = token;
+				hasContent = true;
+				break;
+			}
+			//Numeric annotation glyphs like $1
+			if (token[0] == '$') continue;
+
+			//Move numbers like 12. and 12... can be written right before the move with no space (0-0 is castling though)
+			size_t moveStart = token.find_first_not_of("0123456789");
+			if (moveStart != std::string::npos && moveStart > 0 && token[moveStart] == '.') moveStart = token.find_first_not_of('.', moveStart);
+			else if (moveStart != std::string::npos) moveStart = 0;
+			if (moveStart == std::string::npos) continue;
+			game.Moves.push_back(token.substr(moveStart));
+			hasContent = true;
+		}
+
+		if (hasContent) m_gameCount++;
+		return hasContent;
+	}
+
+	size_t PgnReader::GetGameCount() const
+	{
+		return m_gameCount;
+	}
+
+	std::optional<std::string> TryGetPgnTag(const PgnGame& game, const std::string& name)
+	{
+		for (const auto& tag : game.Tags)
+		{
+			if (tag.first == name) return tag.second;
+		}
+		return std::nullopt;
+	}
+
+	bool TryLoadPgnStartPosition(GameState& state, const PgnGame& game)
+	{
+		const std::optional<std::string> fen = TryGetPgnTag(game, "FEN");
+		return TryLoadFen(state, fen.has_value() ? fen.value() : START_POSITION_FEN);
+	}
+
+	static bool TryParseSquare(const char fileChar, const char rankChar, Square& square)
+	{
+		if (fileChar < 'a' || fileChar > 'h' || rankChar < '1' || rankChar > '8') return false;
+		square = (rankChar - '1') * BOARD_DIMENSION + (fileChar - 'a');
+		return true;
+	}
+
+	bool TryParseSanMove(const GameState& state, const std::string& notation, Move& move)
+	{
+		std::string san = notation;
+		while (!san.empty() && (san.back() == NOTATION_CHECK_CHAR || san.back() == NOTATION_CHECKMATE_CHAR ||
+			san.back() == '!' || san.back() == '?'))
+		{
+			san.pop_back();
+		}
+
+		MoveList legalMoves;
+		GenerateLegalMoves(state, legalMoves);
+
+		std::string castle = san;
+		std::replace(castle.begin(), castle.end(), '0', 'O');
+		if (castle == NOTATION_KINGSIDE_CASTLE || castle == NOTATION_QUEENSIDE_CASTLE)
+		{
+			const MoveFlag castleFlag = castle == NOTATION_KINGSIDE_CASTLE ? MoveFlag::KingSideCastle : MoveFlag::QueenSideCastle;
+			for (const auto& legalMove : legalMoves)
+			{
+				if (legalMove.GetFlag() != castleFlag) continue;
+				move = legalMove;
+				return true;
+			}
+			Utils::Log(Utils::LogType::Error, std::format("Tried to parse the move: {} but castling that way is not legal", notation));
+			return false;
+		}
+
+		PieceType pieceType = PieceType::Pawn;
+		size_t detailsStart = 0;
+		if (!san.empty() && std::isupper(static_cast<unsigned char>(san[0])))
+		{
+			const std::optional<PieceType> symbolType = TryGetPieceFromNotationSymbol(san[0]);
+			if (!symbolType.has_value() || symbolType.value() == PieceType::Pawn)
+			{
+				Utils::Log(Utils::LogType::Error, std::format("Tried to parse the move: {} but it has no piece {}", notation, san[0]));
+				return false;
+			}
+			pieceType = symbolType.value();
+			detailsStart = 1;
+		}
+
+		//Promotions are usually written e8=Q but some files leave out the equals sign
+		std::optional<PieceType> promotionType = std::nullopt;
+		const size_t promotionIndex = san.find(NOTATION_PROMOTION_CHAR);
+		const bool hasBarePromotion = pieceType == PieceType::Pawn && san.size() >= 3 && std::isupper(static_cast<unsigned char>(san.back()));
+		if (promotionIndex != std::string::npos || hasBarePromotion)
+		{
+			const size_t symbolIndex = promotionIndex != std::string::npos ? promotionIndex + 1 : san.size() - 1;
+			if (symbolIndex < san.size()) promotionType = TryGetPieceFromNotationSymbol(san[symbolIndex]);
+			if (!promotionType.has_value())
+			{
+				Utils::Log(Utils::LogType::Error, std::format("Tried to parse the move: {} but its promotion piece is not valid", notation));
+				return false;
+			}
+			san.erase(promotionIndex != std::string::npos ? promotionIndex : san.size() - 1);
+		}
+
+		Square to = NO_SQUARE;
+		if (san.size() < detailsStart + 2 || !TryParseSquare(san[san.size() - 2], san.back(), to))
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to parse the move: {} but it has no destination square", notation));
+			return false;
+		}
+
+		//Whatever is between the piece and the destination tells apart pieces that can both go there
+		int fromFile = -1;
+		int fromRank = -1;
+		for (size_t i = detailsStart; i < san.size() - 2; i++)
+		{
+			const char detail = san[i];
+			if (detail >= 'a' && detail <= 'h') fromFile = detail - 'a';
+			else if (detail >= '1' && detail <= '8') fromRank = detail - '1';
+			else if (detail != NOTATION_CAPTURE_CHAR && detail != '-')
+			{
+				Utils::Log(Utils::LogType::Error, std::format("Tried to parse the move: {} but it has the unexpected character {}",
+					notation, detail));
+				return false;
+			}
+		}
+
+		size_t matchCount = 0;
+		for (const auto& legalMove : legalMoves)
+		{
+			const Square from = legalMove.GetFrom();
+			if (legalMove.GetTo() != to || legalMove.IsCastle()) continue;
+			if (GetTypeFromCode(state.Bitboards.PieceCodes[from]) != pieceType) continue;
+			if ((fromFile >= 0 && GetFile(from) != fromFile) || (fromRank >= 0 && GetRank(from) != fromRank)) continue;
+			if (legalMove.IsPromotion() != promotionType.has_value()) continue;
+			if (legalMove.IsPromotion() && legalMove.GetPromotionType() != promotionType.value()) continue;
+
+			move = legalMove;
+			matchCount++;
+		}
+
+		if (matchCount == 1) return true;
+		Utils::Log(Utils::LogType::Error, std::format("Tried to parse the move: {} for {} but {} legal moves match it",
+			notation, ToString(state.CurrentPlayer), matchCount));
+		return false;
+	}
+
+	static std::string ToSquareString(const Square square)
+	{
+		return { static_cast<char>('a' + GetFile(square)), static_cast<char>('1' + GetRank(square)) };
+	}
+
+	std::string ToSanNotation(GameState& state, const Move& move)
+	{
+		const Square from = move.GetFrom();
+		const PieceType pieceType = GetTypeFromCode(state.Bitboards.PieceCodes[from]);
+		std::string san;
+		if (move.GetFlag() == MoveFlag::KingSideCastle) san = NOTATION_KINGSIDE_CASTLE;
+		else if (move.GetFlag() == MoveFlag::QueenSideCastle) san = NOTATION_QUEENSIDE_CASTLE;
+		else if (pieceType == PieceType::Pawn)
+		{
+			if (move.IsCapture()) san = { static_cast<char>('a' + GetFile(from)), NOTATION_CAPTURE_CHAR };
+			san += ToSquareString(move.GetTo());
+			if (move.IsPromotion()) san += { NOTATION_PROMOTION_CHAR, GetNotationSymbolForPiece(move.GetPromotionType()) };
+		}
+		else
+		{
+			MoveList legalMoves;
+			GenerateLegalMoves(state, legalMoves);
+			bool isAmbiguous = false;
+			bool sharesFile = false;
+			bool sharesRank = false;
+			for (const auto& legalMove : legalMoves)
+			{
+				const Square otherFrom = legalMove.GetFrom();
+				if (legalMove.GetTo() != move.GetTo() || otherFrom == from || legalMove.IsCastle()) continue;
+				if (GetTypeFromCode(state.Bitboards.PieceCodes[otherFrom]) != pieceType) continue;
+
+				isAmbiguous = true;
+				sharesFile |= GetFile(otherFrom) == GetFile(from);
+				sharesRank |= GetRank(otherFrom) == GetRank(from);
+			}
+
+			san = GetNotationSymbolForPiece(pieceType);
+			//The file is enough unless another piece is on it too, then the rank unless that is shared as well
+			if (isAmbiguous && (!sharesFile || sharesRank)) san += static_cast<char>('a' + GetFile(from));
+			if (isAmbiguous && sharesFile) san += static_cast<char>('1' + GetRank(from));
+			if (move.IsCapture()) san += NOTATION_CAPTURE_CHAR;
+			san += ToSquareString(move.GetTo());
+		}
+
+		if (!MakeMove(state, move)) return san;
+		if (state.Checkers != EMPTY_BITBOARD)
+		{
+			MoveList replies;
+			GenerateLegalMoves(state, replies);
+			san += replies.IsEmpty() ? NOTATION_CHECKMATE_CHAR : NOTATION_CHECK_CHAR;
+		}
+		UnmakeMove(state);
+		return san;
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <istream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "GameState.hpp"
+#include "Move.hpp"
+
+namespace Board
+{
+	const std::string PGN_LIGHT_WIN_RESULT = "1-0";
+	const std::string PGN_DARK_WIN_RESULT = "0-1";
+	const std::string PGN_DRAW_RESULT = "1/2-1/2";
+	const std::string PGN_UNKNOWN_RESULT = "*";
+
+	/// <summary>
+	/// One game of a PGN file with only its main line (comments, variations and annotation glyphs are dropped)
+	/// </summary>
+	struct PgnGame
+	{
+		//Name and value of each tag pair in the order they were read
+		std::vector<std::pair<std::string, std::string>> Tags;
+		//The moves in standard algebraic notation like Nf3, exd5 or e8=Q
+		std::vector<std::string> Moves;
+		//One of the PGN result tokens (PGN_UNKNOWN_RESULT when the game did not end with one)
+		std::string Result;
+	};
+
+	/// <summary>
+	/// Reads the games of a PGN stream one at a time so files of any size never have to be loaded whole
+	/// </summary>
+	class PgnReader
+	{
+	private:
+		std::istream& m_stream;
+		size_t m_gameCount;
+
+		void SkipUntil(const char end);
+		void SkipVariation();
+		bool TryReadTag(PgnGame& game);
+		std::string ReadToken();
+
+	public:
+		explicit PgnReader(std::istream& stream);
+
+		/// <summary>
+		/// Reads the next game into the game. Returns false when the stream has no more games
+		/// </summary>
+		/// <param name="game"></param>
+		/// <returns></returns>
+		bool TryReadGame(PgnGame& game);
+		//Games read so far
+		size_t GetGameCount() const;
+	};
+
+	std::optional<std::string> TryGetPgnTag(const PgnGame& game, const std::string& name);
+
+	/// <summary>
+	/// Sets up the position the game starts from, which is its FEN tag when it has one and the standard start otherwise
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="game"></param>
+	/// <returns></returns>
+	bool TryLoadPgnStartPosition(GameState& state, const PgnGame& game);
+
+	/// <summary>
+	/// Finds the legal move of the current player that the move in standard algebraic notation describes.
+	/// Check, mate and annotation marks at the end are ignored and castling may be written with zeros.
+	/// Returns false if no legal move matches or more than one does
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="notation"></param>
+	/// <param name="move"></param>
+	/// <returns></returns>
+	bool TryParseSanMove(const GameState& state, const std::string& notation, Move& move);
+
+	/// <summary>
+	/// Writes the legal move in standard algebraic notation with only as much of the start square as tells it apart
+	/// and a check or mate mark. The move is made and taken back on the state to find those, so it ends up unchanged
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="move"></param>
+	/// <returns></returns>
+	std::string ToSanNotation(GameState& state, const Move& move);
+}
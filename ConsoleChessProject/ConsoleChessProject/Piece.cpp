@@ -52,27 +52,20 @@ PieceTypeInfo& PieceTypeInfo::operator=(const PieceTypeInfo& info)
 	return *this;
 }
 
+//Note: move dirs are static per color and type so pieces do not store them
+//and constructing a piece does not need to expand them
 Piece::Piece()
-	: m_Color(ArmyColor::Light), m_PieceType(PieceType::Pawn), m_moveDirs(GetMoveDirsForPiece(m_Color, m_PieceType)),
-	m_captureDirs(GetCaptureMovesForPiece(m_Color, m_PieceType)), m_state(Piece::State::Undefined), m_State(m_state) {}
+	: m_Color(ArmyColor::Light), m_PieceType(PieceType::Pawn), m_state(Piece::State::Undefined), m_State(m_state) {}
 
 Piece::Piece(const ArmyColor color, const PieceType piece)
-	: m_Color(color), m_PieceType(piece), m_moveDirs(GetMoveDirsForPiece(m_Color, piece)),
-	m_captureDirs(GetCaptureMovesForPiece(m_Color, piece)), m_state(Piece::State::Undefined), m_State(m_state) {}
+	: m_Color(color), m_PieceType(piece), m_state(Piece::State::Undefined), m_State(m_state) {}
 
 Piece::Piece(const Piece& copy) 
-	: m_Color(copy.m_Color), m_PieceType(copy.m_PieceType), m_moveDirs(GetMoveDirsForPiece(m_Color, copy.m_PieceType)),
-	m_captureDirs(GetCaptureMovesForPiece(m_Color, copy.m_PieceType)), m_state(Piece::State::Undefined), m_State(m_state) {}
+	: m_Color(copy.m_Color), m_PieceType(copy.m_PieceType), m_state(Piece::State::Undefined), m_State(m_state) {}
 
 bool Piece::operator==(const Piece& piece) const
 {
-	return m_Color == piece.m_Color && m_PieceType == piece.m_PieceType && m_moveDirs == piece.m_moveDirs &&
-		m_captureDirs == piece.m_captureDirs && m_State == piece.m_State;
-}
-
-bool Piece::HasDifferentCaptureMove()
-{
-	return m_captureDirs.size() > 0;
+	return m_Color == piece.m_Color && m_PieceType == piece.m_PieceType && m_State == piece.m_State;
 }
 
 bool HasPieceTypeDefined(const PieceType type)
@@ -111,16 +104,8 @@ bool CanPieceMoveOverPieces(const PieceType type)
 	return PIECE_INFO.at(type).CanMoveOverPieces;
 }
 
-const std::vector<Utils::Vector2D> GetMoveDirsForPiece(const ArmyColor color, const PieceType type)
+static std::vector<Utils::Vector2D> ExpandMoveDirs(const ArmyColor color, const std::vector<Utils::Vector2D>& dirs)
 {
-	bool hasType = HasPieceTypeDefined(type);
-	if (!hasType)
-	{
-		std::string err = std::format("Tried to get move dirs for a piece of type {} "
-			"but type has no defined info", ToString(type));
-		Utils::Log(Utils::LogType::Error, err);
-		return {};
-	}
 	std::vector<Utils::Vector2D> allMoveDirs;
 	auto maybeMultiplierIt = COLOR_MOVE_CAPTURE_MULTUPLIERS.find(color);
 	Utils::Vector2D moveMultiplier = (maybeMultiplierIt != COLOR_MOVE_CAPTURE_MULTUPLIERS.end())? 
@@ -129,7 +114,7 @@ const std::vector<Utils::Vector2D> GetMoveDirsForPiece(const ArmyColor color, co
 	//NOTE: endX must be one past limit to ensure at least one input for elements that 
 	//are not infinity or neg infinity
 	int currentX = 0, endX = 0, currentY = 0, endY = 0;
-	for (const auto& moveDir : PIECE_INFO.at(type).MoveDirs)
+	for (const auto& moveDir : dirs)
 	{
 		if (std::isinf(moveDir.m_X) && std::isinf(moveDir.m_Y))
 		{
@@ -141,9 +126,6 @@ const std::vector<Utils::Vector2D> GetMoveDirsForPiece(const ArmyColor color, co
 			while (std::abs(currentX) < std::abs(endX) && std::abs(currentY) < std::abs(endY))
 			{
 				allMoveDirs.emplace_back(currentX* moveMultiplier.m_X, currentY* moveMultiplier.m_Y);
-				auto vec = Utils::Vector2D(currentX, currentY);
-				Utils::Log(std::format("ADDING INF X: {} Y: {} POS: {}", std::to_string(Utils::IsPosInifinity(moveDir.m_X)),
-					std::to_string(Utils::IsPosInifinity(moveDir.m_Y)),  vec.ToString(Utils::Vector2D::VectorForm::Component)));
 				currentX += endX > 0 ? 1 : -1;
 				currentY += endY > 0 ? 1 : -1;
 			}
@@ -175,48 +157,55 @@ const std::vector<Utils::Vector2D> GetMoveDirsForPiece(const ArmyColor color, co
 			allMoveDirs.emplace_back(moveDir.m_X * moveMultiplier.m_X, moveDir.m_Y * moveMultiplier.m_Y);
 		}
 	}
+	return allMoveDirs;
+}
 
-	std::string allVecsStr;
-	int count = 0;
-	for (const auto& element : allMoveDirs)
+using MoveDirsCacheType = std::unordered_map<PieceTypeInfo, std::vector<Utils::Vector2D>>;
+
+//Builds the expanded move and capture dirs for every color and type once 
+//since they never change, so lookups do not rebuild (and reallocate) them
+static MoveDirsCacheType CreateMoveDirsCache(const bool captureDirs)
+{
+	MoveDirsCacheType cache;
+	for (const auto& color : { ArmyColor::Light, ArmyColor::Dark })
 	{
-		allVecsStr += element.ToString(Utils::Vector2D::VectorForm::Component);
-		if (count == 8)
+		for (const auto& type : ALL_PIECE_TYPES)
 		{
-			//Utils::Log(std::format("All Move dirs for piece {} is {}", ToString(type), allVecsStr));
-			allVecsStr = "";
-			count = 0;
+			const PieceStaticInfo& infoForType = PIECE_INFO.at(type);
+			const std::vector<Utils::Vector2D>& dirs = (captureDirs && !infoForType.CaptureDirs.empty()) ? 
+														infoForType.CaptureDirs : infoForType.MoveDirs;
+			cache.emplace(PieceTypeInfo{ color, type }, ExpandMoveDirs(color, dirs));
 		}
-		else count++;
 	}
-	
-	return allMoveDirs;
+	return cache;
 }
 
-const std::vector<Utils::Vector2D> GetCaptureMovesForPiece(const ArmyColor color, const PieceType type)
+static const std::vector<Utils::Vector2D>& GetCachedDirs(const ArmyColor color, const PieceType type, const bool captureDirs)
 {
-	bool hasType = HasPieceTypeDefined(type);
-	if (!hasType)
+	static const MoveDirsCacheType MOVE_DIRS = CreateMoveDirsCache(false);
+	static const MoveDirsCacheType CAPTURE_DIRS = CreateMoveDirsCache(true);
+	static const std::vector<Utils::Vector2D> NO_DIRS = {};
+
+	const MoveDirsCacheType& cache = captureDirs ? CAPTURE_DIRS : MOVE_DIRS;
+	auto dirsIt = cache.find(PieceTypeInfo{ color, type });
+	if (dirsIt == cache.end())
 	{
-		std::string err = std::format("Tried to get capture moves for a piece of type {} "
-			"but type has no defined info", ToString(type));
+		std::string err = std::format("Tried to get {} dirs for a piece of type {} "
+			"but type has no defined info", captureDirs ? "capture" : "move", ToString(type));
 		Utils::Log(Utils::LogType::Error, err);
-		return {};
+		return NO_DIRS;
 	}
+	return dirsIt->second;
+}
 
-	const PieceStaticInfo& infoForType = PIECE_INFO.at(type);
-	std::vector<Utils::Vector2D> captureMoves = infoForType.CaptureDirs.empty() ? infoForType.MoveDirs : infoForType.CaptureDirs;
+const std::vector<Utils::Vector2D>& GetMoveDirsForPiece(const ArmyColor color, const PieceType type)
+{
+	return GetCachedDirs(color, type, false);
+}
 
-	auto maybeMultiplierIt = COLOR_MOVE_CAPTURE_MULTUPLIERS.find(color);
-	if (maybeMultiplierIt != COLOR_MOVE_CAPTURE_MULTUPLIERS.end())
-	{
-		for (int i = 0; i < captureMoves.size(); i++)
-		{
-			captureMoves[i] = Utils::Vector2D(captureMoves[i].m_X* maybeMultiplierIt->second.m_X, 
-											  captureMoves[i].m_Y * maybeMultiplierIt->second.m_Y);
-		}
-	}
-	return captureMoves;
+const std::vector<Utils::Vector2D>& GetCaptureMovesForPiece(const ArmyColor color, const PieceType type)
+{
+	return GetCachedDirs(color, type, true);
 }
 
 char GetNotationSymbolForPiece(const PieceType type)
@@ -72,14 +72,9 @@ public:
 		Captured,
 	};
 private:
-	const std::vector<Utils::Vector2D>& m_moveDirs;
-	const std::vector<Utils::Vector2D>& m_captureDirs;
-
 	const std::string m_displayString;
 	State m_state;
 
-	bool HasDifferentCaptureMove();
-
 public:
 	const ArmyColor m_Color;
 	const PieceType m_PieceType;
@@ -97,8 +92,11 @@ public:
 
 double GetValueForPiece(const PieceType piece);
 bool CanPieceMoveOverPieces(const PieceType piece);
-const std::vector<Utils::Vector2D> GetMoveDirsForPiece(const ArmyColor color, const PieceType piece);
-const std::vector<Utils::Vector2D> GetCaptureMovesForPiece(const ArmyColor color, const PieceType piece);
+
+//Note: the move and capture dirs are expanded once per color and type and cached
+//so the returned references are valid for the lifetime of the program
+const std::vector<Utils::Vector2D>& GetMoveDirsForPiece(const ArmyColor color, const PieceType piece);
+const std::vector<Utils::Vector2D>& GetCaptureMovesForPiece(const ArmyColor color, const PieceType piece);
 char GetNotationSymbolForPiece(const PieceType piece);
 const std::optional<PieceType> TryGetPieceFromNotationSymbol(const char& notation);
 
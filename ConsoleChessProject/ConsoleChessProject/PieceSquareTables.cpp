@@ -0,0 +1,17 @@
+#include "PieceSquareTables.hpp"
+#include "Bitboard.hpp"
+
+namespace Board
+{
+	EvaluationScore CalculateEvaluationScore(const BitboardSet& board)
+	{
+		EvaluationScore evaluation = {};
+		Bitboard occupied = board.Occupancy;
+		while (occupied)
+		{
+			const Square square = PopLeastSignificantSquare(occupied);
+			AddPieceScore(evaluation, board.PieceCodes[square], square);
+		}
+		return evaluation;
+	}
+}
@@ -0,0 +1,512 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <memory>
+#include <format>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Search.hpp"
+#include "Evaluation.hpp"
+#include "Nnue.hpp"
+#include "Tablebase.hpp"
+#include "TimeManager.hpp"
+#include "TranspositionTable.hpp"
+#include "MoveOrdering.hpp"
+#include "GameState.hpp"
+#include "MoveGeneration.hpp"
+#include "MoveExecution.hpp"
+#include "HelperFunctions.hpp"
+
+namespace Engine
+{
+	//Limits are checked every 1024 nodes which is well under a millisecond
+	static constexpr std::uint64_t STOP_CHECK_INTERVAL_MASK = 1023;
+	//A capture is skipped in quiescence when even winning the victim and this much more can not reach alpha
+	static constexpr int DELTA_PRUNING_MARGIN = 200;
+	//Only the latest game moves are copied so a search (and the ponder move before it) still fits in the history on top of them
+	static constexpr size_t MAX_COPIED_STATE_HISTORY = MAX_STATE_HISTORY - 2 * MAX_PLY;
+
+	//State every search thread reads, with the transposition table being the only thing the threads share results through
+	struct SharedSearchState
+	{
+		const SearchLimits* Limits = nullptr;
+		const TimeManager* Timer = nullptr;
+		TranspositionTable* Table = nullptr;
+		//Set by the main thread when it is done so the helper threads stop too
+		std::atomic<bool> StopHelpers = false;
+		//Nodes of all threads (each thread adds its count whenever it checks the limits)
+		std::atomic<std::uint64_t> TotalNodes = 0;
+		//Root moves the search skips (the first moves of the lines earlier multi-PV passes found)
+		Board::MoveList ExcludedRootMoves;
+	};
+
+	struct SearchContext
+	{
+		GameState Position;
+		SharedSearchState* Shared = nullptr;
+		//0 is the main thread whose iterations make the result and the others are Lazy SMP helpers
+		int ThreadIndex = 0;
+		std::uint64_t Nodes = 0;
+		std::uint64_t ReportedNodes = 0;
+		//Nodes that failed high and how many of them did so on the first move searched
+		std::uint64_t CutoffNodes = 0;
+		std::uint64_t FirstMoveCutoffs = 0;
+		std::uint64_t TablebaseHits = 0;
+		MoveOrderingTables OrderingTables;
+		//Set once a limit is hit so every node unwinds without searching further
+		bool Stopped = false;
+		//The first iteration of the main thread always completes so there is a move to play
+		bool CanStop = false;
+
+		//The network accumulator of each ply (only used when the search evaluates with a network)
+		std::array<NnueAccumulator, MAX_PLY + 1> Accumulators;
+
+		//Triangular principal variation table where row N holds the best line found from ply N
+		std::array<std::array<Board::Move, MAX_PLY>, MAX_PLY> PrincipalVariations = {};
+		std::array<int, MAX_PLY> PrincipalVariationLengths = {};
+	};
+
+	void CopyPosition(const GameState& source, GameState& target)
+	{
+		target.CurrentPlayer = source.CurrentPlayer;
+		target.Bitboards = source.Bitboards;
+		target.CastlingRights = source.CastlingRights;
+		target.EnPassantSquare = source.EnPassantSquare;
+		target.Checkers = source.Checkers;
+		target.Hash = source.Hash;
+		target.Evaluation = source.Evaluation;
+
+		const size_t copiedCount = std::min(source.StateHistoryCount, MAX_COPIED_STATE_HISTORY);
+		std::copy_n(source.StateHistory.begin() + (source.StateHistoryCount - copiedCount), copiedCount, target.StateHistory.begin());
+		target.StateHistoryCount = copiedCount;
+	}
+
+	//No position before a capture, promotion, double pawn push or castle can come up again after it
+	static bool IsIrreversible(const StateInfo& info)
+	{
+		const Board::Move move = info.MovePlayed;
+		return info.CapturedCode != Board::NO_PIECE || move.IsPromotion() || move.IsCastle() ||
+			move.GetFlag() == Board::MoveFlag::DoublePawnPush;
+	}
+
+	/// <summary>
+	/// Whether the position came up before in the game or search with the same player to move. One repetition is scored
+	/// as a draw (instead of waiting for the third) since the player that is happy with it can always repeat it again
+	/// </summary>
+	/// <param name="position"></param>
+	/// <returns></returns>
+	static bool IsRepetition(const GameState& position)
+	{
+		const size_t count = position.StateHistoryCount;
+		for (size_t pliesBack = 1; pliesBack <= count; pliesBack++)
+		{
+			//Each entry holds the position before its move was played
+			const StateInfo& info = position.StateHistory[count - pliesBack];
+			if (IsIrreversible(info)) return false;
+			if (pliesBack % 2 == 0 && info.Hash == position.Hash) return true;
+		}
+		return false;
+	}
+
+	static int EvaluatePosition(const SearchContext& context, const int ply)
+	{
+		const NnueNetwork* network = context.Shared->Limits->Network;
+		if (network == nullptr) return Evaluate(context.Position);
+		return network->Evaluate(context.Accumulators[ply], context.Position.CurrentPlayer);
+	}
+
+	//Plays the move on the search position and brings the accumulator of the next ply up to date with it
+	static void MakeSearchMove(SearchContext& context, const int ply, const Board::Move& move)
+	{
+		Board::MakeMove(context.Position, move);
+		const NnueNetwork* network = context.Shared->Limits->Network;
+		if (network != nullptr) network->UpdateAccumulator(context.Position, context.Accumulators[ply], context.Accumulators[ply + 1]);
+	}
+
+	static bool CanUseStoredScore(const TranspositionEntry& entry, const int depth, const int alpha, const int beta)
+	{
+		if (entry.Depth < depth) return false;
+		return entry.BoundType == Bound::Exact || (entry.BoundType == Bound::Lower && entry.Score >= beta) ||
+			(entry.BoundType == Bound::Upper && entry.Score <= alpha);
+	}
+
+	static bool IsPondering(const SearchLimits& limits)
+	{
+		return limits.PonderSignal != nullptr && limits.PonderSignal->load(std::memory_order_relaxed);
+	}
+
+	static bool ShouldStop(SearchContext& context)
+	{
+		SharedSearchState& shared = *context.Shared;
+		const std::uint64_t totalNodes = shared.TotalNodes.fetch_add(context.Nodes - context.ReportedNodes, std::memory_order_relaxed) + 
+			context.Nodes - context.ReportedNodes;
+		context.ReportedNodes = context.Nodes;
+
+		if (context.ThreadIndex > 0 && shared.StopHelpers.load(std::memory_order_relaxed)) return true;
+		if (!context.CanStop) return false;
+
+		const SearchLimits& limits = *shared.Limits;
+		if (limits.StopSignal != nullptr && limits.StopSignal->load(std::memory_order_relaxed)) return true;
+		if (limits.Nodes > 0 && totalNodes >= limits.Nodes) return true;
+		if (IsPondering(limits)) return false;
+		//After a ponder hit the iteration in progress was started on the opponent's time, so once the soft deadline
+		//has passed the last completed depth is already more than the move would have had
+		if (limits.PonderSignal != nullptr && shared.Timer->IsSoftDeadlineReached()) return true;
+		return shared.Timer->IsHardDeadlineReached();
+	}
+
+	static void UpdatePrincipalVariation(SearchContext& context, const int ply, const Board::Move& move)
+	{
+		auto& line = context.PrincipalVariations[ply];
+		line[0] = move;
+		const int childLength = ply + 1 < MAX_PLY ? context.PrincipalVariationLengths[ply + 1] : 0;
+		for (int i = 0; i < childLength; i++) line[i + 1] = context.PrincipalVariations[ply + 1][i];
+		context.PrincipalVariationLengths[ply] = childLength + 1;
+	}
+
+	/// <summary>
+	/// Searches only captures and promotions until the position is quiet so the static evaluation is never taken
+	/// in the middle of an exchange. The player to move can stand pat (take the evaluation) instead of capturing,
+	/// except when in check at the first quiescence ply where every evasion is searched so mates are still seen
+	/// </summary>
+	static int Quiescence(SearchContext& context, const int ply, int alpha, const int beta, const bool isFirstPly)
+	{
+		if ((context.Nodes & STOP_CHECK_INTERVAL_MASK) == 0 && ShouldStop(context)) context.Stopped = true;
+		if (context.Stopped) return 0;
+
+		context.Nodes++;
+		context.PrincipalVariationLengths[ply] = 0;
+
+		GameState& position = context.Position;
+		if (ply >= MAX_PLY - 1) return EvaluatePosition(context, ply);
+
+		Board::MoveList moves;
+		const bool searchesEvasions = isFirstPly && position.Checkers;
+		int bestScore = -INFINITE_SCORE;
+		int standPat = -INFINITE_SCORE;
+		if (searchesEvasions)
+		{
+			Board::GenerateLegalMoves(position, moves);
+			if (moves.IsEmpty()) return -MATE_SCORE + ply;
+		}
+		else
+		{
+			standPat = EvaluatePosition(context, ply);
+			if (standPat >= beta) return standPat;
+			//Not even winning a queen would be enough so no capture can raise alpha
+			if (standPat + GetPieceValue(PieceType::Queen) + DELTA_PRUNING_MARGIN <= alpha) return standPat;
+
+			bestScore = standPat;
+			if (standPat > alpha) alpha = standPat;
+			Board::GenerateLegalCaptures(position, moves);
+		}
+
+		MovePicker picker(position, moves, Board::NULL_MOVE, context.OrderingTables, ply);
+		Board::Move move;
+		while (picker.TryGetNextMove(move))
+		{
+			if (!searchesEvasions && !move.IsPromotion() && 
+				standPat + GetCaptureValue(position, move) + DELTA_PRUNING_MARGIN <= alpha) continue;
+
+			MakeSearchMove(context, ply, move);
+			const int score = -Quiescence(context, ply + 1, -beta, -alpha, false);
+			Board::UnmakeMove(position);
+
+			if (score <= bestScore) continue;
+			bestScore = score;
+			if (score <= alpha) continue;
+
+			alpha = score;
+			UpdatePrincipalVariation(context, ply, move);
+			if (alpha >= beta) break;
+		}
+		return bestScore;
+	}
+
+	static bool TryProbeTablebases(SearchContext& context, const int ply, int& score)
+	{
+		const Tablebase* tablebases = context.Shared->Limits->Tablebases;
+		const GameState& position = context.Position;
+		if (tablebases == nullptr || Board::PopCount(position.Bitboards.Occupancy) > MAX_TABLEBASE_PIECES) return false;
+
+		const std::optional<TablebaseResult> result = tablebases->Probe(position);
+		if (!result.has_value()) return false;
+
+		context.TablebaseHits++;
+		score = ToSearchScore(result.value(), ply);
+		return true;
+	}
+
+	static int Negamax(SearchContext& context, const int depth, const int ply, int alpha, const int beta)
+	{
+		//Checked before the depth so the last move of the search can repeat a position too
+		if (ply > 0 && IsRepetition(context.Position))
+		{
+			context.PrincipalVariationLengths[ply] = 0;
+			return 0;
+		}
+
+		//The score is exact so the position is not searched any further (the root still searches so it has a move)
+		int tablebaseScore = 0;
+		if (ply > 0 && TryProbeTablebases(context, ply, tablebaseScore)) return tablebaseScore;
+		if (depth <= 0) return Quiescence(context, ply, alpha, beta, true);
+
+		if ((context.Nodes & STOP_CHECK_INTERVAL_MASK) == 0 && ShouldStop(context)) context.Stopped = true;
+		//The score does not matter since the iteration that was stopped is thrown away
+		if (context.Stopped) return 0;
+
+		context.Nodes++;
+		context.PrincipalVariationLengths[ply] = 0;
+
+		GameState& position = context.Position;
+		if (ply >= MAX_PLY - 1) return EvaluatePosition(context, ply);
+
+		//The root always searches its moves so there is a best move and principal variation to return
+		TranspositionEntry storedEntry;
+		const bool hasStoredEntry = context.Shared->Table->Probe(position.Hash, ply, storedEntry);
+		if (hasStoredEntry && ply > 0 && CanUseStoredScore(storedEntry, depth, alpha, beta)) return storedEntry.Score;
+
+		Board::MoveList moves;
+		Board::GenerateLegalMoves(position, moves);
+		if (moves.IsEmpty()) return position.Checkers ? -MATE_SCORE + ply : 0;
+
+		//At the root the best move of the last iteration is preferred since another search may have replaced the entry
+		Board::Move hashMove = hasStoredEntry ? storedEntry.BestMove : Board::NULL_MOVE;
+		if (ply == 0 && !context.PrincipalVariations[0][0].IsNull()) hashMove = context.PrincipalVariations[0][0];
+		MovePicker picker(position, moves, hashMove, context.OrderingTables, ply);
+
+		const int originalAlpha = alpha;
+		int bestScore = -INFINITE_SCORE;
+		Board::Move bestMove = Board::NULL_MOVE;
+		std::array<Board::Move, Board::MAX_MOVES> searchedQuiets;
+		size_t searchedQuietCount = 0;
+		size_t searchedMoveCount = 0;
+
+		Board::Move move;
+		while (picker.TryGetNextMove(move))
+		{
+			if (ply == 0 && context.Shared->ExcludedRootMoves.Contains(move)) continue;
+
+			MakeSearchMove(context, ply, move);
+			const int score = -Negamax(context, depth - 1, ply + 1, -beta, -alpha);
+			Board::UnmakeMove(position);
+
+			searchedMoveCount++;
+			const bool isQuiet = !move.IsCapture() && !move.IsPromotion();
+			if (isQuiet) searchedQuiets[searchedQuietCount++] = move;
+
+			if (score <= bestScore) continue;
+			bestScore = score;
+			if (score <= alpha) continue;
+
+			alpha = score;
+			bestMove = move;
+			UpdatePrincipalVariation(context, ply, move);
+			if (alpha < beta) continue;
+
+			context.CutoffNodes++;
+			if (searchedMoveCount == 1) context.FirstMoveCutoffs++;
+			if (isQuiet && !context.Stopped) 
+				context.OrderingTables.UpdateQuietCutoff(position, ply, depth, move, searchedQuiets.data(), searchedQuietCount);
+			break;
+		}
+
+		if (context.Stopped) return 0;
+
+		Bound bound = Bound::Exact;
+		if (bestScore <= originalAlpha) bound = Bound::Upper;
+		else if (bestScore >= beta) bound = Bound::Lower;
+		//A root that skipped moves did not find the score of the position so it would mislead later searches
+		if (ply > 0 || context.Shared->ExcludedRootMoves.IsEmpty()) 
+			context.Shared->Table->Store(position.Hash, ply, bestMove, bestScore, depth, bound);
+		return bestScore;
+	}
+
+	static bool HasAnyLimit(const SearchLimits& limits)
+	{
+		return limits.Depth > 0 || limits.Nodes > 0 || limits.MoveTime.count() > 0 ||
+			limits.RemainingTime.count() > 0 || limits.StopSignal != nullptr;
+	}
+
+	TranspositionTable& GetDefaultTranspositionTable()
+	{
+		static TranspositionTable defaultTable(DEFAULT_HASH_MEGABYTES);
+		return defaultTable;
+	}
+
+	SearchResult Search(const GameState& state, const SearchLimits& limits)
+	{
+		return Search(state, limits, GetDefaultTranspositionTable());
+	}
+
+	/// <summary>
+	/// Runs the iterative deepening loop of one thread. Helper threads start every other one a depth ahead
+	/// so the threads spread over different depths and fill the table with results the others can use
+	/// </summary>
+	/// <param name="context"></param>
+	/// <param name="maxDepth"></param>
+	/// <param name="result"></param>
+	static void IterativeDeepening(SearchContext& context, const int maxDepth, SearchResult& result)
+	{
+		const int depthOffset = context.ThreadIndex % 2;
+		for (int depth = 1 + depthOffset; depth <= maxDepth; depth++)
+		{
+			const int score = Negamax(context, depth, 0, -INFINITE_SCORE, INFINITE_SCORE);
+			if (context.Stopped)
+			{
+				result.WasStopped = true;
+				break;
+			}
+
+			result.Score = score;
+			result.Depth = depth;
+			const int lineLength = context.PrincipalVariationLengths[0];
+			result.PrincipalVariation.assign(context.PrincipalVariations[0].begin(), context.PrincipalVariations[0].begin() + lineLength);
+			result.BestMove = lineLength > 0 ? result.PrincipalVariation[0] : Board::NULL_MOVE;
+			context.CanStop = true;
+
+			const SearchLimits& limits = *context.Shared->Limits;
+			if (context.ThreadIndex == 0 && limits.OnProgress)
+			{
+				const std::uint64_t nodes = context.Shared->TotalNodes.load(std::memory_order_relaxed) + context.Nodes - context.ReportedNodes;
+				limits.OnProgress({ depth, score, nodes, context.Shared->Timer->GetElapsedSeconds(), result.PrincipalVariation, false });
+			}
+
+			//No legal moves or a forced mate will not change with more depth
+			if (result.BestMove.IsNull() || IsMateScore(score)) break;
+			if ((!IsPondering(limits) && context.Shared->Timer->IsSoftDeadlineReached()) || ShouldStop(context)) break;
+		}
+	}
+
+	/// <summary>
+	/// Searches the position without the excluded root moves. The table is not aged 
+	/// so the passes of a multi-PV search all count as the same search
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="limits"></param>
+	/// <param name="table"></param>
+	/// <param name="excludedRootMoves"></param>
+	/// <returns></returns>
+	static SearchResult RunSearch(const GameState& state, const SearchLimits& limits, TranspositionTable& table,
+		const Board::MoveList& excludedRootMoves)
+	{
+		SearchResult result = { Board::NULL_MOVE, 0, 0, 0, 0, {}, false, 0, 0 };
+		if (limits.Depth < 0 || limits.Depth >= MAX_PLY)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to search to depth: {} but it must be "
+				"between 0 (no depth limit) and {}", limits.Depth, MAX_PLY - 1));
+			return result;
+		}
+		if (limits.Threads < 1 || limits.Threads > MAX_SEARCH_THREADS)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to search with {} threads but it must be "
+				"between 1 and {}", limits.Threads, MAX_SEARCH_THREADS));
+			return result;
+		}
+		if (limits.Network != nullptr && !limits.Network->IsLoaded())
+		{
+			Utils::Log(Utils::LogType::Error, "Tried to search with a network evaluation but the network is not loaded");
+			return result;
+		}
+
+		const TimeManager timer(limits);
+		int maxDepth = limits.Depth > 0 ? limits.Depth : MAX_PLY - 1;
+		if (!HasAnyLimit(limits)) maxDepth = DEFAULT_SEARCH_DEPTH;
+
+		SharedSearchState shared;
+		shared.Limits = &limits;
+		shared.Timer = &timer;
+		shared.Table = &table;
+		shared.ExcludedRootMoves = excludedRootMoves;
+
+		//Each context holds an undo stack and PV table so they are too big for the stack
+		std::vector<std::unique_ptr<SearchContext>> contexts;
+		for (int i = 0; i < limits.Threads; i++)
+		{
+			auto& context = contexts.emplace_back(std::make_unique<SearchContext>());
+			context->Shared = &shared;
+			context->ThreadIndex = i;
+			context->OrderingTables.Clear();
+			//Helpers have no result to guarantee so they can stop at any point
+			context->CanStop = i > 0;
+			CopyPosition(state, context->Position);
+			if (limits.Network != nullptr) limits.Network->RefreshAccumulator(context->Position, context->Accumulators[0]);
+		}
+
+		std::vector<SearchResult> helperResults(contexts.size(), result);
+		std::vector<std::thread> helpers;
+		helpers.reserve(contexts.size() - 1);
+		for (size_t i = 1; i < contexts.size(); i++)
+		{
+			helpers.emplace_back(IterativeDeepening, std::ref(*contexts[i]), maxDepth, std::ref(helperResults[i]));
+		}
+
+		IterativeDeepening(*contexts[0], maxDepth, result);
+		shared.StopHelpers.store(true, std::memory_order_relaxed);
+		for (auto& helper : helpers) helper.join();
+
+		std::uint64_t cutoffNodes = 0;
+		std::uint64_t firstMoveCutoffs = 0;
+		for (const auto& context : contexts)
+		{
+			result.Nodes += context->Nodes;
+			cutoffNodes += context->CutoffNodes;
+			firstMoveCutoffs += context->FirstMoveCutoffs;
+			result.TablebaseHits += context->TablebaseHits;
+		}
+		result.FirstMoveCutoffRate = cutoffNodes > 0 ? static_cast<double>(firstMoveCutoffs) / cutoffNodes : 0;
+		result.Seconds = timer.GetElapsedSeconds();
+		return result;
+	}
+
+	SearchResult Search(const GameState& state, const SearchLimits& limits, TranspositionTable& table)
+	{
+		table.NewSearch();
+		return RunSearch(state, limits, table, Board::MoveList());
+	}
+
+	std::vector<SearchResult> SearchMultiPv(const GameState& state, const SearchLimits& limits, const int lineCount,
+		TranspositionTable& table)
+	{
+		if (lineCount < 1)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to search for {} lines but it must be at least 1", lineCount));
+			return {};
+		}
+
+		Board::MoveList legalMoves;
+		Board::GenerateLegalMoves(state, legalMoves);
+		const size_t passCount = std::min(static_cast<size_t>(lineCount), legalMoves.Size());
+
+		//Later passes find the positions the earlier ones searched in the table so they are much cheaper than the first
+		table.NewSearch();
+		Board::MoveList excludedRootMoves;
+		std::vector<SearchResult> lines;
+		lines.reserve(passCount);
+		for (size_t i = 0; i < passCount; i++)
+		{
+			SearchResult line = RunSearch(state, limits, table, excludedRootMoves);
+			if (line.BestMove.IsNull()) break;
+
+			excludedRootMoves.Add(line.BestMove);
+			lines.push_back(std::move(line));
+			if (limits.StopSignal != nullptr && limits.StopSignal->load(std::memory_order_relaxed)) break;
+		}
+		return lines;
+	}
+
+	double GetNodesPerSecond(const SearchResult& result)
+	{
+		return result.Seconds > 0 ? result.Nodes / result.Seconds : 0;
+	}
+
+	std::string ToScoreString(const int score)
+	{
+		if (!IsMateScore(score)) return std::format("{:+.2f}", score / 100.0);
+
+		const int matePlies = MATE_SCORE - std::abs(score);
+		return std::format("{}M{}", score > 0 ? "+" : "-", (matePlies + 1) / 2);
+	}
+}
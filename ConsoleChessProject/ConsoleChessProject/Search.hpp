@@ -0,0 +1,146 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "GameState.hpp"
+#include "Move.hpp"
+#include "TranspositionTable.hpp"
+
+namespace Engine
+{
+	class NnueNetwork;
+	class Tablebase;
+
+	constexpr int INFINITE_SCORE = 32000;
+	//A mate found at ply N scores MATE_SCORE - N so shorter mates are preferred
+	constexpr int MATE_SCORE = 31000;
+	constexpr int MAX_PLY = 128;
+	constexpr int DEFAULT_SEARCH_DEPTH = 5;
+	constexpr int MAX_SEARCH_THREADS = 256;
+
+	inline bool IsMateScore(const int score) { return score >= MATE_SCORE - MAX_PLY || score <= -(MATE_SCORE - MAX_PLY); }
+
+	/// <summary>
+	/// The result of one completed depth, reported while the search is still running
+	/// </summary>
+	struct SearchProgress
+	{
+		int Depth;
+		//Centipawns from the point of view of the player to move
+		int Score;
+		//Nodes of all threads so far
+		std::uint64_t Nodes;
+		double Seconds;
+		std::vector<Board::Move> PrincipalVariation;
+		//Set on the last update of an analysis, which holds the final result of the search
+		bool IsFinal;
+	};
+
+	/// <summary>
+	/// What stops the search. Every limit left at 0 is not used and when no limit is set at all
+	/// the search goes to DEFAULT_SEARCH_DEPTH. The clock fields are for the player to move
+	/// </summary>
+	struct SearchLimits
+	{
+		int Depth = 0;
+		std::uint64_t Nodes = 0;
+		std::chrono::milliseconds MoveTime{ 0 };
+		std::chrono::milliseconds RemainingTime{ 0 };
+		std::chrono::milliseconds Increment{ 0 };
+		//Moves left until the next time control (0 means the time is split as if there are always a few dozen left)
+		int MovesToGo = 0;
+		//Setting this from any thread stops the search as soon as it checks it
+		const std::atomic<bool>* StopSignal = nullptr;
+		//While this is set the search is on the opponent's time (pondering) so the time limits are not used.
+		//Once it is cleared they apply as if the search had started on the player's own time, so a long ponder ends right away
+		const std::atomic<bool>* PonderSignal = nullptr;
+		//Threads that search the same root and share the transposition table (Lazy SMP).
+		//A single thread searches on the calling thread only and with a depth or node limit and a cleared
+		//table gives the same result every run, so it is the deterministic mode for tests
+		int Threads = 1;
+		//Evaluates with the network instead of the classical evaluation when set (it must be loaded)
+		const NnueNetwork* Network = nullptr;
+		//Positions below the root that are in the loaded tables get their score from them instead of being searched
+		const Tablebase* Tablebases = nullptr;
+		//Called on the searching thread every time a depth is completed (so it must not touch anything the caller's thread uses)
+		std::function<void(const SearchProgress&)> OnProgress;
+	};
+
+	struct SearchResult
+	{
+		//NULL_MOVE when the player to move has no legal moves
+		Board::Move BestMove;
+		//Centipawns from the point of view of the player to move
+		int Score;
+		//The deepest completed iteration (the result always comes from a completed iteration)
+		int Depth;
+		std::uint64_t Nodes;
+		double Seconds;
+		std::vector<Board::Move> PrincipalVariation;
+		//True if a limit or the stop signal ended the search in the middle of an iteration
+		bool WasStopped;
+		//Share of the nodes that failed high where the first move searched caused it (the closer to 1 the better the ordering)
+		double FirstMoveCutoffRate;
+		//Nodes of all threads whose score came from the tablebases
+		std::uint64_t TablebaseHits;
+	};
+
+	/// <summary>
+	/// Searches the position for the best move of the current player with iterative deepening negamax alpha-beta
+	/// until a limit is reached, returning the best move of the last completed depth.
+	/// The search runs on its own copy of the position so the state is never modified
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="limits"></param>
+	/// <returns></returns>
+	SearchResult Search(const GameState& state, const SearchLimits& limits);
+
+	/// <summary>
+	/// Searches like Search(state, limits) but with the table the caller owns instead of the default one,
+	/// so games can keep their results apart and size or clear them
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="limits"></param>
+	/// <param name="table"></param>
+	/// <returns></returns>
+	SearchResult Search(const GameState& state, const SearchLimits& limits, TranspositionTable& table);
+
+	/// <summary>
+	/// Finds the best lines for up to lineCount different first moves (fewer if there are not as many legal moves),
+	/// best first. Each line is its own pass that searches every root move but the ones the lines before it start with,
+	/// and all passes share the table. The limits apply to each pass on its own, so each line's nodes and seconds
+	/// are only what its pass took
+	/// </summary>
+	/// <param name="state"></param>
+	/// <param name="limits"></param>
+	/// <param name="lineCount"></param>
+	/// <param name="table"></param>
+	/// <returns></returns>
+	std::vector<SearchResult> SearchMultiPv(const GameState& state, const SearchLimits& limits, const int lineCount, 
+		TranspositionTable& table);
+
+	double GetNodesPerSecond(const SearchResult& result);
+
+	/// <summary>
+	/// Formats a score in pawns like +0.35, or a mate in moves like +M3 (negative when being mated)
+	/// </summary>
+	/// <param name="score"></param>
+	/// <returns></returns>
+	std::string ToScoreString(const int score);
+
+	//The table searches use when no table is given
+	TranspositionTable& GetDefaultTranspositionTable();
+
+	/// <summary>
+	/// Copies only what the search reads (the bitboards, side to move, rights, en passant square, checkers, hash,
+	/// evaluation and the latest moves of the state history so repetitions of the game are seen) and not the pieces, 
+	/// maps or previous moves, so a position can be searched apart from its game.
+	/// Piece pointers still point into the source state but the search never dereferences them
+	/// </summary>
+	/// <param name="source"></param>
+	/// <param name="target"></param>
+	void CopyPosition(const GameState& source, GameState& target);
+}
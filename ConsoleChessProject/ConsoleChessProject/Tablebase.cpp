@@ -0,0 +1,951 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include "Tablebase.hpp"
+#include "Search.hpp"
+#include "Attacks.hpp"
+#include "Bitboard.hpp"
+#include "MoveGeneration.hpp"
+#include "MoveExecution.hpp"
+#include "HelperFunctions.hpp"
+
+namespace Engine
+{
+	//Every file is this header (little endian) followed by one value per index
+	struct TablebaseFileHeader
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t MaterialIndex;
+		std::uint32_t Reserved;
+		std::uint64_t EntryCount;
+	};
+	static_assert(sizeof(TablebaseFileHeader) == 24, "The tablebase file header must not have padding");
+
+	//"CCTB"
+	static constexpr std::uint32_t TABLEBASE_MAGIC = 0x42544343;
+	static constexpr std::uint32_t TABLEBASE_VERSION = 1;
+
+	//The pieces besides the two kings
+	static constexpr int MAX_EXTRA_PIECES = MAX_TABLEBASE_PIECES - 2;
+	//Strongest first, which is also the order each side's pieces are listed in a table's name
+	static constexpr std::array<PieceType, 5> EXTRA_PIECE_ORDER = {
+		PieceType::Queen, PieceType::Rook, PieceType::Bishop, PieceType::Knight, PieceType::Pawn };
+	static constexpr std::array<char, Board::PIECE_TYPE_COUNT> PIECE_LETTERS = { 'P', 'N', 'B', 'R', 'Q', 'K' };
+
+	//Light's king is on the 10 squares of the a1-d1-d4 triangle without pawns and on the 32 squares of files a to d with them
+	static constexpr int PAWNLESS_KING_SLOT_COUNT = 10;
+	static constexpr int PAWN_KING_SLOT_COUNT = 32;
+
+	static constexpr int MIRROR_FILES = 1 << 0;
+	static constexpr int MIRROR_RANKS = 1 << 1;
+	static constexpr int MIRROR_DIAGONAL = 1 << 2;
+
+	//File values: 0 is a draw, N is mate in N moves and -N is being mated in N - 1 moves
+	static constexpr std::int8_t DRAW_VALUE = 0;
+
+	//While generating, values are in plies: a win in N plies is N, a loss in N plies is -(N + 1) and a draw is 0
+	using PlyValue = std::int16_t;
+	static constexpr PlyValue UNKNOWN_PLY_VALUE = std::numeric_limits<PlyValue>::min();
+	static constexpr PlyValue DRAW_PLY_VALUE = 0;
+	//Bigger than the number of different moves any position of the tables has, so a counter with it never reaches 0
+	static constexpr std::uint8_t DRAWING_EXIT_COUNT = 128;
+	static constexpr std::uint64_t GENERATION_CHUNK_SIZE = 1 << 14;
+
+	struct TablebaseMaterial
+	{
+		std::string Name;
+		//Light's (the stronger side) first and each side's from the strongest down
+		std::array<Board::PieceCode, MAX_EXTRA_PIECES> ExtraPieces;
+		int ExtraPieceCount;
+		int PawnCount;
+		int KingSlotCount;
+		std::uint64_t EntryCount;
+		//How many of each piece code there are, 2 bits per code, which is how a position finds its table
+		std::uint32_t Signature;
+	};
+
+	//A position given by the square and code of each of its pieces (kings included)
+	struct TablebasePosition
+	{
+		ArmyColor SideToMove;
+		int PieceCount;
+		std::array<Board::Square, MAX_TABLEBASE_PIECES> Squares;
+		std::array<Board::PieceCode, MAX_TABLEBASE_PIECES> Codes;
+	};
+
+	//The squares of a position of a table by slot: light's king, dark's king and then the extra pieces in the material's order
+	using SlotSquares = std::array<Board::Square, MAX_TABLEBASE_PIECES>;
+
+	static constexpr std::array<int, Board::SQUARE_COUNT> CreateKingSlots(const bool hasPawns)
+	{
+		std::array<int, Board::SQUARE_COUNT> slots = {};
+		int nextSlot = 0;
+		for (Board::Square square = 0; square < Board::SQUARE_COUNT; square++)
+		{
+			const int rank = Board::GetRank(square);
+			const int file = Board::GetFile(square);
+			const bool isInRegion = hasPawns ? file < 4 : rank <= file && file < 4;
+			slots[square] = isInRegion ? nextSlot++ : -1;
+		}
+		return slots;
+	}
+
+	template<size_t SlotCount>
+	static constexpr std::array<Board::Square, SlotCount> CreateKingSquares(const std::array<int, Board::SQUARE_COUNT>& slots)
+	{
+		std::array<Board::Square, SlotCount> squares = {};
+		for (Board::Square square = 0; square < Board::SQUARE_COUNT; square++)
+		{
+			if (slots[square] >= 0) squares[slots[square]] = square;
+		}
+		return squares;
+	}
+
+	static constexpr std::array<int, Board::SQUARE_COUNT> PAWNLESS_KING_SLOTS = CreateKingSlots(false);
+	static constexpr std::array<int, Board::SQUARE_COUNT> PAWN_KING_SLOTS = CreateKingSlots(true);
+	static constexpr std::array<Board::Square, PAWNLESS_KING_SLOT_COUNT> PAWNLESS_KING_SQUARES =
+		CreateKingSquares<PAWNLESS_KING_SLOT_COUNT>(PAWNLESS_KING_SLOTS);
+	static constexpr std::array<Board::Square, PAWN_KING_SLOT_COUNT> PAWN_KING_SQUARES =
+		CreateKingSquares<PAWN_KING_SLOT_COUNT>(PAWN_KING_SLOTS);
+
+	static Board::PieceCode SwapCodeColor(const Board::PieceCode code)
+	{
+		return Board::ToPieceCode(GetOppositeColor(Board::GetColorFromCode(code)), Board::GetTypeFromCode(code));
+	}
+
+	static std::uint32_t ToSignatureBit(const Board::PieceCode code)
+	{
+		return std::uint32_t{ 1 } << (2 * code);
+	}
+
+	static void AddMaterial(std::vector<TablebaseMaterial>& materials, const std::vector<PieceType>& lightPieces,
+		const std::vector<PieceType>& darkPieces)
+	{
+		TablebaseMaterial material = {};
+		material.Name = "K";
+		for (const auto& type : lightPieces)
+		{
+			material.Name += PIECE_LETTERS[Board::ToIndex(type)];
+			material.ExtraPieces[material.ExtraPieceCount++] = Board::ToPieceCode(ArmyColor::Light, type);
+		}
+		material.Name += "vK";
+		for (const auto& type : darkPieces)
+		{
+			material.Name += PIECE_LETTERS[Board::ToIndex(type)];
+			material.ExtraPieces[material.ExtraPieceCount++] = Board::ToPieceCode(ArmyColor::Dark, type);
+		}
+
+		for (int i = 0; i < material.ExtraPieceCount; i++)
+		{
+			if (Board::GetTypeFromCode(material.ExtraPieces[i]) == PieceType::Pawn) material.PawnCount++;
+			material.Signature += ToSignatureBit(material.ExtraPieces[i]);
+		}
+
+		material.KingSlotCount = material.PawnCount > 0 ? PAWN_KING_SLOT_COUNT : PAWNLESS_KING_SLOT_COUNT;
+		//Side to move, light's king, then every other piece on any square
+		material.EntryCount = static_cast<std::uint64_t>(TEAMS_COUNT) * material.KingSlotCount;
+		for (int i = 0; i < 1 + material.ExtraPieceCount; i++) material.EntryCount *= Board::SQUARE_COUNT;
+		materials.push_back(material);
+	}
+
+	static std::vector<TablebaseMaterial> CreateMaterials()
+	{
+		std::vector<TablebaseMaterial> materials;
+		for (size_t strongest = 0; strongest < EXTRA_PIECE_ORDER.size(); strongest++)
+		{
+			const PieceType strongestType = EXTRA_PIECE_ORDER[strongest];
+			AddMaterial(materials, { strongestType }, {});
+			//The second piece is never stronger than the first so every material is listed once
+			for (size_t second = strongest; second < EXTRA_PIECE_ORDER.size(); second++)
+			{
+				AddMaterial(materials, { strongestType, EXTRA_PIECE_ORDER[second] }, {});
+				AddMaterial(materials, { strongestType }, { EXTRA_PIECE_ORDER[second] });
+			}
+		}
+
+		//Captures lead to fewer pieces and promotions to fewer pawns so those tables have to be done first
+		std::stable_sort(materials.begin(), materials.end(), [](const TablebaseMaterial& first, const TablebaseMaterial& second) -> bool
+			{
+				if (first.ExtraPieceCount != second.ExtraPieceCount) return first.ExtraPieceCount < second.ExtraPieceCount;
+				return first.PawnCount < second.PawnCount;
+			});
+		return materials;
+	}
+
+	static const std::vector<TablebaseMaterial>& GetMaterials()
+	{
+		static const std::vector<TablebaseMaterial> materials = CreateMaterials();
+		return materials;
+	}
+
+	static const std::unordered_map<std::uint32_t, size_t>& GetMaterialIndexes()
+	{
+		static const std::unordered_map<std::uint32_t, size_t> indexes = []() -> std::unordered_map<std::uint32_t, size_t>
+			{
+				std::unordered_map<std::uint32_t, size_t> signatureIndexes;
+				const auto& materials = GetMaterials();
+				for (size_t i = 0; i < materials.size(); i++) signatureIndexes.emplace(materials[i].Signature, i);
+				return signatureIndexes;
+			}();
+		return indexes;
+	}
+
+	static Board::PieceCode GetSlotCode(const TablebaseMaterial& material, const int slot)
+	{
+		if (slot == 0) return Board::ToPieceCode(ArmyColor::Light, PieceType::King);
+		if (slot == 1) return Board::ToPieceCode(ArmyColor::Dark, PieceType::King);
+		return material.ExtraPieces[slot - 2];
+	}
+
+	static int GetSlotCount(const TablebaseMaterial& material)
+	{
+		return 2 + material.ExtraPieceCount;
+	}
+
+	static Board::Square TransformSquare(Board::Square square, const int transform)
+	{
+		if (transform & MIRROR_FILES) square ^= 7;
+		if (transform & MIRROR_RANKS) square ^= 56;
+		if (transform & MIRROR_DIAGONAL) square = Board::GetFile(square) * BOARD_DIMENSION + Board::GetRank(square);
+		return square;
+	}
+
+	//Note: light's king must already be in the king region of the material
+	static std::uint64_t CalculateIndex(const TablebaseMaterial& material, const ArmyColor sideToMove, SlotSquares squares)
+	{
+		//Two of the same piece can swap squares and it is the same position so they are kept in ascending order
+		if (material.ExtraPieceCount == 2 && material.ExtraPieces[0] == material.ExtraPieces[1] && squares[2] > squares[3])
+		{
+			std::swap(squares[2], squares[3]);
+		}
+
+		const int kingSlot = material.PawnCount > 0 ? PAWN_KING_SLOTS[squares[0]] : PAWNLESS_KING_SLOTS[squares[0]];
+		std::uint64_t index = static_cast<std::uint64_t>(Board::ToIndex(sideToMove)) * material.KingSlotCount + kingSlot;
+		for (int slot = 1; slot < GetSlotCount(material); slot++) index = index * Board::SQUARE_COUNT + squares[slot];
+		return index;
+	}
+
+	static SlotSquares TransformSquares(const TablebaseMaterial& material, const SlotSquares& squares, const int transform)
+	{
+		SlotSquares transformed = {};
+		for (int slot = 0; slot < GetSlotCount(material); slot++) transformed[slot] = TransformSquare(squares[slot], transform);
+		return transformed;
+	}
+
+	/// <summary>
+	/// Returns the index of the position, which is the same for every mirror of it
+	/// </summary>
+	/// <param name="material"></param>
+	/// <param name="sideToMove"></param>
+	/// <param name="squares"></param>
+	/// <returns></returns>
+	static std::uint64_t CalculateCanonicalIndex(const TablebaseMaterial& material, const ArmyColor sideToMove, const SlotSquares& squares)
+	{
+		const Board::Square king = squares[0];
+		int transform = Board::GetFile(king) >= 4 ? MIRROR_FILES : 0;
+		if (material.PawnCount > 0) return CalculateIndex(material, sideToMove, TransformSquares(material, squares, transform));
+
+		if (Board::GetRank(king) >= 4) transform |= MIRROR_RANKS;
+		const Board::Square mirroredKing = TransformSquare(king, transform);
+		if (Board::GetRank(mirroredKing) > Board::GetFile(mirroredKing)) transform |= MIRROR_DIAGONAL;
+
+		const std::uint64_t index = CalculateIndex(material, sideToMove, TransformSquares(material, squares, transform));
+		if (Board::GetRank(mirroredKing) != Board::GetFile(mirroredKing)) return index;
+		//A king on the diagonal stays in the triangle when the board is mirrored along it, so of the two the lower index is used
+		return std::min(index, CalculateIndex(material, sideToMove, TransformSquares(material, squares, transform ^ MIRROR_DIAGONAL)));
+	}
+
+	static void DecodeIndex(const TablebaseMaterial& material, std::uint64_t index, ArmyColor& sideToMove, SlotSquares& squares)
+	{
+		for (int slot = GetSlotCount(material) - 1; slot >= 1; slot--)
+		{
+			squares[slot] = static_cast<Board::Square>(index % Board::SQUARE_COUNT);
+			index /= Board::SQUARE_COUNT;
+		}
+
+		const int kingSlot = static_cast<int>(index % material.KingSlotCount);
+		squares[0] = material.PawnCount > 0 ? PAWN_KING_SQUARES[kingSlot] : PAWNLESS_KING_SQUARES[kingSlot];
+		sideToMove = static_cast<ArmyColor>(index / material.KingSlotCount);
+	}
+
+	static Board::Bitboard GetPieceAttacks(const PieceType type, const ArmyColor color, const Board::Square square,
+		const Board::Bitboard occupancy)
+	{
+		switch (type)
+		{
+		case PieceType::Pawn:
+			return Board::GetPawnAttacks(color, square);
+		case PieceType::Knight:
+			return Board::GetKnightAttacks(square);
+		case PieceType::Bishop:
+			return Board::GetBishopAttacks(square, occupancy);
+		case PieceType::Rook:
+			return Board::GetRookAttacks(square, occupancy);
+		case PieceType::Queen:
+			return Board::GetQueenAttacks(square, occupancy);
+		default:
+			return Board::GetKingAttacks(square);
+		}
+	}
+
+	static Board::Bitboard GetOccupancy(const TablebaseMaterial& material, const SlotSquares& squares)
+	{
+		Board::Bitboard occupancy = Board::EMPTY_BITBOARD;
+		for (int slot = 0; slot < GetSlotCount(material); slot++) occupancy |= Board::ToBitboard(squares[slot]);
+		return occupancy;
+	}
+
+	static bool IsAttackedBy(const TablebaseMaterial& material, const SlotSquares& squares, const Board::Square target,
+		const ArmyColor byColor)
+	{
+		const Board::Bitboard occupancy = GetOccupancy(material, squares);
+		for (int slot = 0; slot < GetSlotCount(material); slot++)
+		{
+			const Board::PieceCode code = GetSlotCode(material, slot);
+			if (Board::GetColorFromCode(code) != byColor) continue;
+
+			const Board::Bitboard attacks = GetPieceAttacks(Board::GetTypeFromCode(code), byColor, squares[slot], occupancy);
+			if (attacks & Board::ToBitboard(target)) return true;
+		}
+		return false;
+	}
+
+	static bool IsLegalPosition(const TablebaseMaterial& material, const ArmyColor sideToMove, const SlotSquares& squares)
+	{
+		Board::Bitboard occupancy = Board::EMPTY_BITBOARD;
+		for (int slot = 0; slot < GetSlotCount(material); slot++)
+		{
+			const Board::Bitboard bit = Board::ToBitboard(squares[slot]);
+			if (occupancy & bit) return false;
+			occupancy |= bit;
+
+			const int rank = Board::GetRank(squares[slot]);
+			const bool isPawn = Board::GetTypeFromCode(GetSlotCode(material, slot)) == PieceType::Pawn;
+			if (isPawn && (rank == 0 || rank == BOARD_DIMENSION - 1)) return false;
+		}
+
+		//The player that just moved can not have left its king in check (which also keeps the kings apart)
+		const ArmyColor waitingColor = GetOppositeColor(sideToMove);
+		return !IsAttackedBy(material, squares, squares[Board::ToIndex(waitingColor)], sideToMove);
+	}
+
+	static TablebaseResult ToResult(const std::int8_t value)
+	{
+		if (value > 0) return { TablebaseOutcome::Win, 2 * value - 1 };
+		if (value < 0) return { TablebaseOutcome::Loss, 2 * (-value - 1) };
+		return { TablebaseOutcome::Draw, 0 };
+	}
+
+	/// <summary>
+	/// Returns the file value of the position from the table of its material, mirroring the colors when dark is the stronger side
+	/// </summary>
+	/// <param name="tables"></param>
+	/// <param name="position"></param>
+	/// <returns></returns>
+	static std::optional<std::int8_t> ProbeValue(const std::vector<const std::int8_t*>& tables, const TablebasePosition& position)
+	{
+		//Two bare kings can never mate
+		if (position.PieceCount == 2) return DRAW_VALUE;
+		if (position.PieceCount > MAX_TABLEBASE_PIECES) return std::nullopt;
+
+		std::uint32_t signature = 0;
+		std::uint32_t swappedSignature = 0;
+		for (int i = 0; i < position.PieceCount; i++)
+		{
+			if (Board::GetTypeFromCode(position.Codes[i]) == PieceType::King) continue;
+			signature += ToSignatureBit(position.Codes[i]);
+			swappedSignature += ToSignatureBit(SwapCodeColor(position.Codes[i]));
+		}
+
+		const auto& materialIndexes = GetMaterialIndexes();
+		bool isSwapped = false;
+		auto materialIt = materialIndexes.find(signature);
+		if (materialIt == materialIndexes.end())
+		{
+			materialIt = materialIndexes.find(swappedSignature);
+			isSwapped = true;
+		}
+		if (materialIt == materialIndexes.end()) return std::nullopt;
+
+		const std::int8_t* values = tables[materialIt->second];
+		if (values == nullptr) return std::nullopt;
+		const TablebaseMaterial& material = GetMaterials()[materialIt->second];
+
+		SlotSquares squares = {};
+		std::array<bool, MAX_TABLEBASE_PIECES> isSlotUsed = {};
+		for (int i = 0; i < position.PieceCount; i++)
+		{
+			//Swapping the colors also turns the board around so pawns keep moving the way their new color does
+			const Board::PieceCode code = isSwapped ? SwapCodeColor(position.Codes[i]) : position.Codes[i];
+			const Board::Square square = isSwapped ? position.Squares[i] ^ 56 : position.Squares[i];
+			if (Board::GetTypeFromCode(code) == PieceType::King)
+			{
+				squares[Board::ToIndex(Board::GetColorFromCode(code))] = square;
+				continue;
+			}
+
+			for (int slot = 2; slot < GetSlotCount(material); slot++)
+			{
+				if (isSlotUsed[slot] || GetSlotCode(material, slot) != code) continue;
+				squares[slot] = square;
+				isSlotUsed[slot] = true;
+				break;
+			}
+		}
+
+		const ArmyColor sideToMove = isSwapped ? GetOppositeColor(position.SideToMove) : position.SideToMove;
+		return values[CalculateCanonicalIndex(material, sideToMove, squares)];
+	}
+
+	static std::optional<std::int8_t> ProbeBoard(const std::vector<const std::int8_t*>& tables, const Board::BitboardSet& board,
+		const ArmyColor sideToMove)
+	{
+		if (Board::PopCount(board.Occupancy) > MAX_TABLEBASE_PIECES) return std::nullopt;
+
+		TablebasePosition position = {};
+		position.SideToMove = sideToMove;
+		Board::Bitboard occupancy = board.Occupancy;
+		while (occupancy)
+		{
+			const Board::Square square = Board::PopLeastSignificantSquare(occupancy);
+			position.Squares[position.PieceCount] = square;
+			position.Codes[position.PieceCount] = board.PieceCodes[square];
+			position.PieceCount++;
+		}
+		return ProbeValue(tables, position);
+	}
+
+	static std::string GetTablePath(const std::string& directory, const TablebaseMaterial& material)
+	{
+		return (std::filesystem::path(directory) / (material.Name + TABLEBASE_FILE_EXTENSION)).string();
+	}
+
+	Tablebase::Tablebase() : m_files(), m_tables(GetMaterials().size(), nullptr) {}
+
+	Tablebase::~Tablebase() = default;
+
+	size_t Tablebase::MapTables(const std::string& directory)
+	{
+		Unload();
+		const auto& materials = GetMaterials();
+		for (size_t i = 0; i < materials.size(); i++)
+		{
+			const std::string path = GetTablePath(directory, materials[i]);
+			std::error_code error;
+			if (!std::filesystem::exists(path, error)) continue;
+
+			auto file = std::make_unique<Utils::MappedFile>(path);
+			if (!file->IsMapped())
+			{
+				Utils::Log(Utils::LogType::Error, std::format("Tried to load the tablebase at: {} but it could not be mapped", path));
+				continue;
+			}
+
+			TablebaseFileHeader header = {};
+			if (file->GetSize() >= sizeof(header)) std::memcpy(&header, file->GetData(), sizeof(header));
+			const bool isValid = file->GetSize() == sizeof(header) + materials[i].EntryCount && header.Magic == TABLEBASE_MAGIC &&
+				header.Version == TABLEBASE_VERSION && header.MaterialIndex == i && header.EntryCount == materials[i].EntryCount;
+			if (!isValid)
+			{
+				Utils::Log(Utils::LogType::Error, std::format("Tried to load the tablebase at: {} but it is not a version {} "
+					"table of {} entries", path, TABLEBASE_VERSION, materials[i].EntryCount));
+				continue;
+			}
+
+			m_tables[i] = reinterpret_cast<const std::int8_t*>(file->GetData() + sizeof(header));
+			m_files.push_back(std::move(file));
+		}
+		return m_files.size();
+	}
+
+	bool Tablebase::TryLoad(const std::string& directory)
+	{
+		if (MapTables(directory) > 0) return true;
+
+		Utils::Log(Utils::LogType::Error, std::format("Tried to load the tablebases in: {} but it has no valid table", directory));
+		return false;
+	}
+
+	void Tablebase::Unload()
+	{
+		std::fill(m_tables.begin(), m_tables.end(), nullptr);
+		m_files.clear();
+	}
+
+	size_t Tablebase::GetTableCount() const
+	{
+		return m_files.size();
+	}
+
+	std::optional<TablebaseResult> Tablebase::Probe(const GameState& state) const
+	{
+		if (state.CastlingRights != Board::NO_CASTLING || state.EnPassantSquare != Board::NO_SQUARE) return std::nullopt;
+
+		const std::optional<std::int8_t> value = ProbeBoard(m_tables, state.Bitboards, state.CurrentPlayer);
+		if (!value.has_value()) return std::nullopt;
+		return ToResult(value.value());
+	}
+
+	Board::Move Tablebase::GetBestMove(const GameState& state) const
+	{
+		if (!Probe(state).has_value()) return Board::NULL_MOVE;
+
+		//Positions are too large for the stack
+		auto position = std::make_unique<GameState>();
+		CopyPosition(state, *position);
+		Board::MoveList moves;
+		Board::GenerateLegalMoves(*position, moves);
+
+		Board::Move bestMove = Board::NULL_MOVE;
+		int bestScore = -INFINITE_SCORE;
+		for (const auto& move : moves)
+		{
+			if (!Board::MakeMove(*position, move)) continue;
+			//A double pawn push leaves an en passant square but the tables never have en passant captures anyway
+			const std::optional<std::int8_t> value = ProbeBoard(m_tables, position->Bitboards, position->CurrentPlayer);
+			Board::UnmakeMove(*position);
+			if (!value.has_value()) continue;
+
+			const int score = -ToSearchScore(ToResult(value.value()), 1);
+			if (score <= bestScore) continue;
+			bestScore = score;
+			bestMove = move;
+		}
+		return bestMove;
+	}
+
+	int ToSearchScore(const TablebaseResult& result, const int ply)
+	{
+		const int mateScore = MATE_SCORE - (ply + result.PliesToMate);
+		switch (result.Outcome)
+		{
+		case TablebaseOutcome::Win:
+			return mateScore;
+		case TablebaseOutcome::Loss:
+			return -mateScore;
+		default:
+			return 0;
+		}
+	}
+
+	std::vector<std::string> GetTablebaseNames()
+	{
+		std::vector<std::string> names;
+		for (const auto& material : GetMaterials()) names.push_back(material.Name);
+		return names;
+	}
+
+	static constexpr PlyValue ToWinValue(const int plies) { return static_cast<PlyValue>(plies); }
+	static constexpr PlyValue ToLossValue(const int plies) { return static_cast<PlyValue>(-(plies + 1)); }
+
+	/// <summary>
+	/// What a table being generated keeps for each of its indexes. Values and counters are atomic since the threads
+	/// of a pass update the predecessors of their positions, which can be anywhere in the table
+	/// </summary>
+	struct GenerationTable
+	{
+		std::vector<std::atomic<PlyValue>> Values;
+		//Moves to other positions of the table whose value is not known yet to be a win for the opponent
+		std::vector<std::atomic<std::uint8_t>> RemainingChildren;
+		//The plies to being mated through the slowest capture or promotion that loses (-1 when there is none)
+		std::vector<std::int16_t> LongestExitLoss;
+		std::atomic<int> LongestPlies;
+		std::atomic<bool> IsMissingTable;
+
+		explicit GenerationTable(const std::uint64_t entryCount)
+			: Values(entryCount), RemainingChildren(entryCount), LongestExitLoss(entryCount, -1), LongestPlies(0), IsMissingTable(false) {}
+	};
+
+	static void UpdateLongestPlies(GenerationTable& table, const int plies)
+	{
+		int longest = table.LongestPlies.load(std::memory_order_relaxed);
+		while (plies > longest && !table.LongestPlies.compare_exchange_weak(longest, plies, std::memory_order_relaxed)) {}
+	}
+
+	/// <summary>
+	/// Splits the indexes into chunks that the threads take one at a time until none are left
+	/// </summary>
+	/// <param name="count"></param>
+	/// <param name="threadCount"></param>
+	/// <param name="work"></param>
+	static void RunParallel(const std::uint64_t count, const int threadCount, const std::function<void(std::uint64_t, std::uint64_t)>& work)
+	{
+		std::atomic<std::uint64_t> nextChunk = 0;
+		auto runChunks = [&]() -> void
+			{
+				while (true)
+				{
+					const std::uint64_t begin = nextChunk.fetch_add(GENERATION_CHUNK_SIZE, std::memory_order_relaxed);
+					if (begin >= count) return;
+					work(begin, std::min(begin + GENERATION_CHUNK_SIZE, count));
+				}
+			};
+
+		std::vector<std::thread> helpers;
+		for (int i = 1; i < threadCount; i++) helpers.emplace_back(runChunks);
+		runChunks();
+		for (auto& helper : helpers) helper.join();
+	}
+
+	static void SetUpState(GameState& state, const TablebaseMaterial& material, const ArmyColor sideToMove, const SlotSquares& squares)
+	{
+		state.Bitboards.Clear();
+		for (int slot = 0; slot < GetSlotCount(material); slot++) state.Bitboards.AddPiece(squares[slot], GetSlotCode(material, slot), nullptr);
+		state.CurrentPlayer = sideToMove;
+		state.CastlingRights = Board::NO_CASTLING;
+		state.EnPassantSquare = Board::NO_SQUARE;
+		state.Checkers = Board::CalculateCheckers(state.Bitboards, sideToMove);
+	}
+
+	static TablebasePosition CreateChildPosition(const TablebaseMaterial& material, const ArmyColor sideToMove,
+		const SlotSquares& squares, const Board::Move& move)
+	{
+		TablebasePosition child = {};
+		child.SideToMove = GetOppositeColor(sideToMove);
+		for (int slot = 0; slot < GetSlotCount(material); slot++)
+		{
+			if (move.IsCapture() && squares[slot] == move.GetTo()) continue;
+
+			Board::Square square = squares[slot];
+			Board::PieceCode code = GetSlotCode(material, slot);
+			if (square == move.GetFrom())
+			{
+				square = move.GetTo();
+				if (move.IsPromotion()) code = Board::ToPieceCode(sideToMove, move.GetPromotionType());
+			}
+			child.Squares[child.PieceCount] = square;
+			child.Codes[child.PieceCount] = code;
+			child.PieceCount++;
+		}
+		return child;
+	}
+
+	static bool ContainsIndex(const std::array<std::uint64_t, Board::MAX_MOVES>& indexes, const size_t count, const std::uint64_t index)
+	{
+		return std::find(indexes.begin(), indexes.begin() + count, index) != indexes.begin() + count;
+	}
+
+	/// <summary>
+	/// Finds the value of every position that is decided by its own moves (mates, stalemates and captures or promotions that win)
+	/// and counts the moves that stay in the table for the rest. Unused indexes (illegal or mirrors) are left as draws
+	/// </summary>
+	static void InitializePositions(const TablebaseMaterial& material, const std::vector<const std::int8_t*>& tables,
+		GenerationTable& table, const std::uint64_t begin, const std::uint64_t end)
+	{
+		auto state = std::make_unique<GameState>();
+		std::array<std::uint64_t, Board::MAX_MOVES> children = {};
+
+		for (std::uint64_t index = begin; index < end; index++)
+		{
+			ArmyColor sideToMove = ArmyColor::Light;
+			SlotSquares squares = {};
+			DecodeIndex(material, index, sideToMove, squares);
+			table.Values[index].store(DRAW_PLY_VALUE, std::memory_order_relaxed);
+			if (!IsLegalPosition(material, sideToMove, squares) || CalculateCanonicalIndex(material, sideToMove, squares) != index) continue;
+
+			SetUpState(*state, material, sideToMove, squares);
+			Board::MoveList moves;
+			Board::GenerateLegalMoves(*state, moves);
+			if (moves.IsEmpty())
+			{
+				if (state->Checkers) table.Values[index].store(ToLossValue(0), std::memory_order_relaxed);
+				continue;
+			}
+
+			size_t childCount = 0;
+			int fastestExitWin = -1;
+			int longestExitLoss = -1;
+			bool hasDrawingExit = false;
+			for (const auto& move : moves)
+			{
+				if (move.IsCapture() || move.IsPromotion())
+				{
+					const std::optional<std::int8_t> value = ProbeValue(tables, CreateChildPosition(material, sideToMove, squares, move));
+					if (!value.has_value())
+					{
+						table.IsMissingTable.store(true, std::memory_order_relaxed);
+						continue;
+					}
+
+					//The value is for the opponent
+					const TablebaseResult result = ToResult(value.value());
+					if (result.Outcome == TablebaseOutcome::Loss)
+					{
+						const int plies = result.PliesToMate + 1;
+						if (fastestExitWin < 0 || plies < fastestExitWin) fastestExitWin = plies;
+					}
+					else if (result.Outcome == TablebaseOutcome::Win) longestExitLoss = std::max(longestExitLoss, result.PliesToMate + 1);
+					else hasDrawingExit = true;
+					continue;
+				}
+
+				SlotSquares childSquares = squares;
+				for (int slot = 0; slot < GetSlotCount(material); slot++)
+				{
+					if (childSquares[slot] == move.GetFrom()) childSquares[slot] = move.GetTo();
+				}
+				const std::uint64_t childIndex = CalculateCanonicalIndex(material, GetOppositeColor(sideToMove), childSquares);
+				if (!ContainsIndex(children, childCount, childIndex)) children[childCount++] = childIndex;
+			}
+
+			//A faster win through the table is still found by the passes, which replace slower wins
+			if (fastestExitWin >= 0)
+			{
+				table.Values[index].store(ToWinValue(fastestExitWin), std::memory_order_relaxed);
+				UpdateLongestPlies(table, fastestExitWin);
+			}
+			else if (childCount == 0)
+			{
+				if (hasDrawingExit) continue;
+				table.Values[index].store(ToLossValue(longestExitLoss), std::memory_order_relaxed);
+				UpdateLongestPlies(table, longestExitLoss);
+			}
+			else
+			{
+				table.Values[index].store(UNKNOWN_PLY_VALUE, std::memory_order_relaxed);
+				const size_t remaining = childCount + (hasDrawingExit ? DRAWING_EXIT_COUNT : 0);
+				table.RemainingChildren[index].store(static_cast<std::uint8_t>(remaining), std::memory_order_relaxed);
+				table.LongestExitLoss[index] = static_cast<std::int16_t>(longestExitLoss);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Returns the squares the piece could have come from with a move that is not a capture or promotion
+	/// </summary>
+	static Board::Bitboard GetRetractionOrigins(const PieceType type, const ArmyColor color, const Board::Square square,
+		const Board::Bitboard occupancy)
+	{
+		if (type != PieceType::Pawn) return GetPieceAttacks(type, color, square, occupancy) & ~occupancy;
+
+		const int direction = color == ArmyColor::Light ? -BOARD_DIMENSION : BOARD_DIMENSION;
+		const Board::Square from = square + direction;
+		const int fromRank = Board::GetRank(from);
+		if (fromRank < 1 || fromRank > BOARD_DIMENSION - 2 || (occupancy & Board::ToBitboard(from))) return Board::EMPTY_BITBOARD;
+
+		Board::Bitboard origins = Board::ToBitboard(from);
+		const int doublePushRank = color == ArmyColor::Light ? 3 : 4;
+		const Board::Square doublePushFrom = from + direction;
+		if (Board::GetRank(square) == doublePushRank && !(occupancy & Board::ToBitboard(doublePushFrom)))
+		{
+			origins |= Board::ToBitboard(doublePushFrom);
+		}
+		return origins;
+	}
+
+	/// <summary>
+	/// Fills the list with the index of every different position of the table that has a move to this one
+	/// </summary>
+	static size_t GeneratePredecessors(const TablebaseMaterial& material, const ArmyColor sideToMove, const SlotSquares& squares,
+		std::array<std::uint64_t, Board::MAX_MOVES>& predecessors)
+	{
+		const ArmyColor moverColor = GetOppositeColor(sideToMove);
+		const Board::Bitboard occupancy = GetOccupancy(material, squares);
+		size_t count = 0;
+
+		for (int slot = 0; slot < GetSlotCount(material); slot++)
+		{
+			const Board::PieceCode code = GetSlotCode(material, slot);
+			if (Board::GetColorFromCode(code) != moverColor) continue;
+
+			Board::Bitboard origins = GetRetractionOrigins(Board::GetTypeFromCode(code), moverColor, squares[slot], occupancy);
+			while (origins)
+			{
+				SlotSquares predecessor = squares;
+				predecessor[slot] = Board::PopLeastSignificantSquare(origins);
+				//The player to move before can not have had the other king in check
+				if (IsAttackedBy(material, predecessor, predecessor[Board::ToIndex(sideToMove)], moverColor)) continue;
+
+				const std::uint64_t index = CalculateCanonicalIndex(material, moverColor, predecessor);
+				if (!ContainsIndex(predecessors, count, index)) predecessors[count++] = index;
+			}
+		}
+		return count;
+	}
+
+	static void MarkWin(GenerationTable& table, const std::uint64_t index, const int plies)
+	{
+		const PlyValue winValue = ToWinValue(plies);
+		PlyValue current = table.Values[index].load(std::memory_order_relaxed);
+		while (current == UNKNOWN_PLY_VALUE || current > winValue)
+		{
+			if (table.Values[index].compare_exchange_weak(current, winValue, std::memory_order_relaxed))
+			{
+				UpdateLongestPlies(table, plies);
+				return;
+			}
+		}
+	}
+
+	static void CountLosingChild(GenerationTable& table, const std::uint64_t index, const int childPlies)
+	{
+		if (table.Values[index].load(std::memory_order_relaxed) != UNKNOWN_PLY_VALUE) return;
+		//Only the thread that counts the last child down gets 1 back so the loss is set once
+		if (table.RemainingChildren[index].fetch_sub(1, std::memory_order_relaxed) != 1) return;
+
+		const int plies = std::max(childPlies + 1, static_cast<int>(table.LongestExitLoss[index]));
+		table.Values[index].store(ToLossValue(plies), std::memory_order_relaxed);
+		UpdateLongestPlies(table, plies);
+	}
+
+	/// <summary>
+	/// Works back from the positions whose value is known in plies order: every position that can move into a loss
+	/// in N plies is a win in N + 1, and a position whose moves all lead to wins for the opponent is a loss once
+	/// the last of them is counted. Whatever is never reached is a draw
+	/// </summary>
+	static void RunRetrogradePasses(const TablebaseMaterial& material, GenerationTable& table, const int threadCount)
+	{
+		for (int plies = 0; plies <= table.LongestPlies.load(std::memory_order_relaxed); plies++)
+		{
+			//Losses are always an even number of plies away from the mate and wins an odd number
+			const bool isLossPass = plies % 2 == 0;
+			const PlyValue passValue = isLossPass ? ToLossValue(plies) : ToWinValue(plies);
+
+			RunParallel(material.EntryCount, threadCount, [&](const std::uint64_t begin, const std::uint64_t end) -> void
+				{
+					std::array<std::uint64_t, Board::MAX_MOVES> predecessors = {};
+					for (std::uint64_t index = begin; index < end; index++)
+					{
+						if (table.Values[index].load(std::memory_order_relaxed) != passValue) continue;
+
+						ArmyColor sideToMove = ArmyColor::Light;
+						SlotSquares squares = {};
+						DecodeIndex(material, index, sideToMove, squares);
+						const size_t count = GeneratePredecessors(material, sideToMove, squares, predecessors);
+						for (size_t i = 0; i < count; i++)
+						{
+							if (isLossPass) MarkWin(table, predecessors[i], plies + 1);
+							else CountLosingChild(table, predecessors[i], plies);
+						}
+					}
+				});
+		}
+	}
+
+	static bool TryWriteTable(const std::string& path, const size_t materialIndex, const std::vector<std::int8_t>& values)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to write the tablebase at: {} but the file could not be opened", path));
+			return false;
+		}
+
+		const TablebaseFileHeader header = { TABLEBASE_MAGIC, TABLEBASE_VERSION, static_cast<std::uint32_t>(materialIndex), 0, values.size() };
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size()));
+		if (!file)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to write the tablebase at: {} but writing failed", path));
+			return false;
+		}
+		return true;
+	}
+
+	static TablebaseTableReport CreateReport(const TablebaseMaterial& material, const std::int8_t* values)
+	{
+		TablebaseTableReport report = {};
+		report.Name = material.Name;
+		for (std::uint64_t index = 0; index < material.EntryCount; index++)
+		{
+			ArmyColor sideToMove = ArmyColor::Light;
+			SlotSquares squares = {};
+			DecodeIndex(material, index, sideToMove, squares);
+			if (!IsLegalPosition(material, sideToMove, squares) || CalculateCanonicalIndex(material, sideToMove, squares) != index) continue;
+
+			report.PositionCount++;
+			const TablebaseResult result = ToResult(values[index]);
+			if (result.Outcome == TablebaseOutcome::Win) report.WinCount++;
+			else if (result.Outcome == TablebaseOutcome::Loss) report.LossCount++;
+			report.LongestMatePlies = std::max(report.LongestMatePlies, result.PliesToMate);
+		}
+		return report;
+	}
+
+	bool TryGenerateTablebases(const std::string& directory, const int threadCount, const std::vector<std::string>& tableNames,
+		const TablebaseProgressCallback& onTableDone)
+	{
+		if (threadCount < 1)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to generate tablebases with {} threads but it must be at least 1", threadCount));
+			return false;
+		}
+
+		const auto& materials = GetMaterials();
+		for (const auto& name : tableNames)
+		{
+			const bool isKnown = std::any_of(materials.begin(), materials.end(),
+				[&name](const TablebaseMaterial& material) -> bool { return material.Name == name; });
+			if (isKnown) continue;
+
+			Utils::Log(Utils::LogType::Error, std::format("Tried to generate the tablebase: {} but there is no such table", name));
+			return false;
+		}
+
+		//Finished tables are probed through their files like at runtime, so only the pages captures and promotions reach are loaded
+		Tablebase tablebase;
+		tablebase.MapTables(directory);
+		const size_t totalCount = tableNames.empty() ? materials.size() : tableNames.size();
+		size_t doneCount = 0;
+
+		for (size_t i = 0; i < materials.size(); i++)
+		{
+			const TablebaseMaterial& material = materials[i];
+			if (!tableNames.empty() && std::find(tableNames.begin(), tableNames.end(), material.Name) == tableNames.end()) continue;
+			doneCount++;
+
+			const auto startTime = std::chrono::steady_clock::now();
+			const bool wasLoaded = tablebase.m_tables[i] != nullptr;
+			if (!wasLoaded)
+			{
+				GenerationTable table(material.EntryCount);
+				RunParallel(material.EntryCount, threadCount, [&](const std::uint64_t begin, const std::uint64_t end) -> void
+					{
+						InitializePositions(material, tablebase.m_tables, table, begin, end);
+					});
+				if (table.IsMissingTable.load())
+				{
+					Utils::Log(Utils::LogType::Error, std::format("Tried to generate the tablebase: {} but a table its captures "
+						"or promotions lead into is not in: {}", material.Name, directory));
+					return false;
+				}
+				RunRetrogradePasses(material, table, threadCount);
+
+				std::vector<std::int8_t> values(material.EntryCount, DRAW_VALUE);
+				for (std::uint64_t index = 0; index < material.EntryCount; index++)
+				{
+					const PlyValue value = table.Values[index].load(std::memory_order_relaxed);
+					if (value == UNKNOWN_PLY_VALUE || value == DRAW_PLY_VALUE) continue;
+					const int moves = value > 0 ? (value + 1) / 2 : -value / 2;
+					if (moves > std::numeric_limits<std::int8_t>::max() - 1)
+					{
+						Utils::Log(Utils::LogType::Error, std::format("Tried to generate the tablebase: {} but it has a mate in {} "
+							"which does not fit the file format", material.Name, moves));
+						return false;
+					}
+					values[index] = static_cast<std::int8_t>(value > 0 ? moves : -(moves + 1));
+				}
+
+				if (!TryWriteTable(GetTablePath(directory, material), i, values)) return false;
+				tablebase.MapTables(directory);
+				if (tablebase.m_tables[i] == nullptr) return false;
+			}
+
+			TablebaseTableReport report = CreateReport(material, tablebase.m_tables[i]);
+			report.DoneCount = doneCount;
+			report.TotalCount = totalCount;
+			report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+			report.WasLoaded = wasLoaded;
+			if (onTableDone) onTableDone(report);
+		}
+		return true;
+	}
+}
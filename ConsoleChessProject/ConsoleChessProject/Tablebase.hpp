@@ -0,0 +1,139 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "GameState.hpp"
+#include "Move.hpp"
+#include "MappedFile.hpp"
+
+namespace Engine
+{
+	//Every material with up to this many pieces (kings included) has a table
+	constexpr int MAX_TABLEBASE_PIECES = 4;
+	constexpr const char* TABLEBASE_FILE_EXTENSION = ".cctb";
+
+	enum class TablebaseOutcome
+	{
+		Loss,
+		Draw,
+		Win,
+	};
+
+	/// <summary>
+	/// The value of a position with perfect play from both sides
+	/// </summary>
+	struct TablebaseResult
+	{
+		//For the player to move
+		TablebaseOutcome Outcome;
+		//Plies until the player that is winning mates (0 for draws and when the player to move is already mated)
+		int PliesToMate;
+	};
+
+	struct TablebaseTableReport
+	{
+		std::string Name;
+		//Tables done so far (this one included) out of all of them
+		size_t DoneCount;
+		size_t TotalCount;
+		//Positions that are stored (legal and not a mirror of another one)
+		std::uint64_t PositionCount;
+		std::uint64_t WinCount;
+		std::uint64_t LossCount;
+		//The longest mate of the table in plies
+		int LongestMatePlies;
+		double Seconds;
+		//True when the file was already there so the table was not generated again
+		bool WasLoaded;
+	};
+
+	//Called on the generating thread once each table is written (or found already written)
+	using TablebaseProgressCallback = std::function<void(const TablebaseTableReport& report)>;
+
+	/// <summary>
+	/// Win/draw/loss and distance to mate for every position with up to MAX_TABLEBASE_PIECES pieces, read from files that
+	/// are mapped into memory (so only the parts the probes touch are ever loaded).
+	/// Tables are for light being the stronger side and only keep one position of each group of mirrored positions:
+	/// the board is mirrored so light's king is on the a1-d1-d4 triangle, or only on files a to d when there are pawns
+	/// since those can not be turned around. Positions with castling rights or an en passant square are not in the tables
+	/// </summary>
+	class Tablebase
+	{
+	private:
+		std::vector<std::unique_ptr<Utils::MappedFile>> m_files;
+		//The values of each table by its index in the material list (null when its file was not loaded)
+		std::vector<const std::int8_t*> m_tables;
+
+		//Maps the valid table files of the directory and returns how many there were
+		size_t MapTables(const std::string& directory);
+
+		friend bool TryGenerateTablebases(const std::string& directory, const int threadCount, 
+			const std::vector<std::string>& tableNames, const TablebaseProgressCallback& onTableDone);
+
+	public:
+		Tablebase();
+		~Tablebase();
+
+		Tablebase(const Tablebase&) = delete;
+		Tablebase& operator=(const Tablebase&) = delete;
+
+		/// <summary>
+		/// Maps every table file found in the directory, replacing the tables that were loaded before.
+		/// Returns false if no valid table was found. Must not be called during a search that probes the tables
+		/// </summary>
+		/// <param name="directory"></param>
+		/// <returns></returns>
+		bool TryLoad(const std::string& directory);
+		void Unload();
+		size_t GetTableCount() const;
+
+		/// <summary>
+		/// Returns the value of the position for the player to move, or nothing when it has too many pieces,
+		/// castling rights, an en passant square or its table is not loaded
+		/// </summary>
+		/// <param name="state"></param>
+		/// <returns></returns>
+		std::optional<TablebaseResult> Probe(const GameState& state) const;
+
+		/// <summary>
+		/// Returns the move that wins the fastest, or else draws, or else loses the slowest.
+		/// NULL_MOVE when the position can not be probed or has no legal moves
+		/// </summary>
+		/// <param name="state"></param>
+		/// <returns></returns>
+		Board::Move GetBestMove(const GameState& state) const;
+	};
+
+	/// <summary>
+	/// Turns a probe at the ply into a search score (a mate score when it is won or lost)
+	/// </summary>
+	/// <param name="result"></param>
+	/// <param name="ply"></param>
+	/// <returns></returns>
+	int ToSearchScore(const TablebaseResult& result, const int ply);
+
+	/// <summary>
+	/// The names of every table (like KQvKR) in the order they are generated, which is fewest pieces and pawns first
+	/// since captures and promotions lead into those
+	/// </summary>
+	/// <returns></returns>
+	std::vector<std::string> GetTablebaseNames();
+
+	/// <summary>
+	/// Generates the tables with retrograde analysis and writes them to the directory (which must exist).
+	/// Only the named tables are generated when names are given, in which case the tables their captures and promotions
+	/// lead into must already be in the directory. Tables whose files are already there are loaded instead of generated again.
+	/// Each pass over a table is split between the threads
+	/// </summary>
+	/// <param name="directory"></param>
+	/// <param name="threadCount"></param>
+	/// <param name="tableNames"></param>
+	/// <param name="onTableDone"></param>
+	/// <returns></returns>
+	bool TryGenerateTablebases(const std::string& directory, const int threadCount, const std::vector<std::string>& tableNames,
+		const TablebaseProgressCallback& onTableDone);
+}
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <format>
+#include <thread>
+#include <algorithm>
+#include "GameState.hpp"
+#include "BoardManager.hpp"
+#include "MoveGeneration.hpp"
+#include "Tablebase.hpp"
+
+//Headless endgame tablebase tool (built as its own console target with CONSOLE_LOGGING defined):
+//	generate <directory> [threads] [tables...]	generates every table (or only the named ones) into the directory,
+//												skipping the ones already there. Threads default to every core
+//	probe <directory> <fen>						the value of the position and the best move from the tables
+//	list										the name of every table in the order they are generated
+
+static void PrintUsage()
+{
+	std::cout << "Usage:\n"
+		<< "  generate <directory> [threads] [tables...]\n"
+		<< "  probe <directory> <fen>\n"
+		<< "  list" << std::endl;
+}
+
+static std::string GetRemainingArgs(const int argc, char* argv[], const int startIndex)
+{
+	std::string args;
+	for (int i = startIndex; i < argc; i++)
+	{
+		if (!args.empty()) args += ' ';
+		args += argv[i];
+	}
+	return args;
+}
+
+static std::string ToString(const Engine::TablebaseOutcome outcome)
+{
+	switch (outcome)
+	{
+	case Engine::TablebaseOutcome::Win:
+		return "win";
+	case Engine::TablebaseOutcome::Loss:
+		return "loss";
+	default:
+		return "draw";
+	}
+}
+
+static void PrintReport(const Engine::TablebaseTableReport& report)
+{
+	const std::uint64_t drawCount = report.PositionCount - report.WinCount - report.LossCount;
+	std::cout << std::format("[{}/{}] {}: {} positions ({} wins, {} draws, {} losses) longest mate: {} plies {}",
+		report.DoneCount, report.TotalCount, report.Name, report.PositionCount, report.WinCount, drawCount, report.LossCount,
+		report.LongestMatePlies, report.WasLoaded ? "(already generated)" : std::format("{:.1f}s", report.Seconds)) << std::endl;
+}
+
+static int RunGenerate(const int argc, char* argv[])
+{
+	const std::string directory = argv[2];
+	const int threads = argc > 3 ? std::stoi(argv[3]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<std::string> tableNames;
+	for (int i = 4; i < argc; i++) tableNames.push_back(argv[i]);
+
+	std::cout << std::format("Generating tablebases in: {} with {} threads", directory, threads) << std::endl;
+	return Engine::TryGenerateTablebases(directory, threads, tableNames, PrintReport) ? 0 : 1;
+}
+
+static int RunProbe(const int argc, char* argv[])
+{
+	Engine::Tablebase tablebase;
+	if (!tablebase.TryLoad(argv[2])) return 1;
+
+	//The game state holds the whole undo stack so it lives on the heap
+	auto state = std::make_unique<GameState>();
+	if (!Board::TryLoadFen(*state, GetRemainingArgs(argc, argv, 3))) return 1;
+
+	const std::optional<Engine::TablebaseResult> result = tablebase.Probe(*state);
+	if (!result.has_value())
+	{
+		std::cout << "The position is not in the loaded tables" << std::endl;
+		return 1;
+	}
+
+	const Board::Move bestMove = tablebase.GetBestMove(*state);
+	std::cout << std::format("Result: {} Plies to mate: {} Best move: {}", ToString(result->Outcome), result->PliesToMate,
+		bestMove.IsNull() ? "none" : Board::ToCoordinateNotation(bestMove)) << std::endl;
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::string command = argc > 1 ? argv[1] : "";
+	if (command == "list")
+	{
+		for (const auto& name : Engine::GetTablebaseNames()) std::cout << name << std::endl;
+		return 0;
+	}
+	if (command == "generate" && argc > 2) return RunGenerate(argc, argv);
+	if (command == "probe" && argc > 3) return RunProbe(argc, argv);
+
+	PrintUsage();
+	return 1;
+}
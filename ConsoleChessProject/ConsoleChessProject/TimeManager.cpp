@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <chrono>
+#include "TimeManager.hpp"
+#include "Search.hpp"
+
+namespace Engine
+{
+	TimeManager::TimeManager(const SearchLimits& limits)
+		: m_startTime(std::chrono::steady_clock::now()), m_softDeadline(), m_hardDeadline(), m_hasDeadline(false)
+	{
+		using std::chrono::milliseconds;
+		if (limits.MoveTime > milliseconds::zero())
+		{
+			//A fixed move time is used fully so both deadlines are the same
+			const milliseconds moveTime = std::max(limits.MoveTime - MOVE_OVERHEAD, milliseconds{ 1 });
+			m_softDeadline = m_startTime + moveTime;
+			m_hardDeadline = m_softDeadline;
+			m_hasDeadline = true;
+		}
+		else if (limits.RemainingTime > milliseconds::zero())
+		{
+			const int movesToGo = limits.MovesToGo > 0 ? limits.MovesToGo : DEFAULT_MOVES_TO_GO;
+			const milliseconds usableTime = std::max(limits.RemainingTime - MOVE_OVERHEAD, milliseconds{ 1 });
+			const milliseconds softTime = std::min(usableTime / movesToGo + limits.Increment * 3 / 4, usableTime);
+			//The hard deadline can never use more than half of what is left on the clock
+			const milliseconds hardTime = std::min(softTime * HARD_DEADLINE_FACTOR, std::max(usableTime / 2, softTime));
+			m_softDeadline = m_startTime + softTime;
+			m_hardDeadline = m_startTime + hardTime;
+			m_hasDeadline = true;
+		}
+	}
+
+	bool TimeManager::HasDeadline() const
+	{
+		return m_hasDeadline;
+	}
+
+	bool TimeManager::IsSoftDeadlineReached() const
+	{
+		return m_hasDeadline && std::chrono::steady_clock::now() >= m_softDeadline;
+	}
+
+	bool TimeManager::IsHardDeadlineReached() const
+	{
+		return m_hasDeadline && std::chrono::steady_clock::now() >= m_hardDeadline;
+	}
+
+	double TimeManager::GetElapsedSeconds() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+	}
+}
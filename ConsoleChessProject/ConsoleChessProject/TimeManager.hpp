@@ -0,0 +1,34 @@
+#pragma once
+#include <chrono>
+#include "Search.hpp"
+
+namespace Engine
+{
+	//Time kept back from every move for the move to be sent and played
+	constexpr std::chrono::milliseconds MOVE_OVERHEAD{ 30 };
+	//Moves the remaining time is split over when the limits do not say how many are left
+	constexpr int DEFAULT_MOVES_TO_GO = 30;
+	//How far past the soft deadline the search may run to finish an iteration
+	constexpr int HARD_DEADLINE_FACTOR = 4;
+
+	/// <summary>
+	/// Turns the limits into deadlines on the steady clock. No new iteration starts after the soft deadline
+	/// and the search is stopped wherever it is at the hard deadline
+	/// </summary>
+	class TimeManager
+	{
+	private:
+		std::chrono::steady_clock::time_point m_startTime;
+		std::chrono::steady_clock::time_point m_softDeadline;
+		std::chrono::steady_clock::time_point m_hardDeadline;
+		bool m_hasDeadline;
+
+	public:
+		TimeManager(const SearchLimits& limits);
+
+		bool HasDeadline() const;
+		bool IsSoftDeadlineReached() const;
+		bool IsHardDeadlineReached() const;
+		double GetElapsedSeconds() const;
+	};
+}
@@ -0,0 +1,194 @@
+#include <format>
+#include <algorithm>
+#include <new>
+#include "TranspositionTable.hpp"
+#include "Search.hpp"
+#include "HelperFunctions.hpp"
+
+namespace Engine
+{
+	//Data layout: move (16 bits) | score (16) | depth (8) | bound (2) | age (6)
+	static constexpr int SCORE_SHIFT = 16;
+	static constexpr int DEPTH_SHIFT = 32;
+	static constexpr int BOUND_SHIFT = 40;
+	static constexpr int AGE_SHIFT = 42;
+	static constexpr std::uint8_t AGE_MASK = 0x3F;
+	static constexpr size_t BYTES_PER_MEGABYTE = 1024 * 1024;
+	static constexpr size_t HASHFULL_SAMPLE_CLUSTERS = 250;
+
+	static std::uint64_t PackData(const Board::Move& move, const int score, const int depth, const Bound bound, const std::uint8_t age)
+	{
+		return static_cast<std::uint64_t>(move.GetData()) |
+			(static_cast<std::uint64_t>(static_cast<std::uint16_t>(score)) << SCORE_SHIFT) |
+			(static_cast<std::uint64_t>(static_cast<std::uint8_t>(depth)) << DEPTH_SHIFT) |
+			(static_cast<std::uint64_t>(bound) << BOUND_SHIFT) |
+			(static_cast<std::uint64_t>(age & AGE_MASK) << AGE_SHIFT);
+	}
+
+	static Board::Move GetMove(const std::uint64_t data) { return Board::Move(static_cast<std::uint16_t>(data)); }
+	static int GetScore(const std::uint64_t data) { return static_cast<std::int16_t>(data >> SCORE_SHIFT); }
+	static int GetDepth(const std::uint64_t data) { return static_cast<std::uint8_t>(data >> DEPTH_SHIFT); }
+	static Bound GetBound(const std::uint64_t data) { return static_cast<Bound>((data >> BOUND_SHIFT) & 0b11); }
+	static std::uint8_t GetAge(const std::uint64_t data) { return (data >> AGE_SHIFT) & AGE_MASK; }
+
+	//Mates are stored as distance from the position instead of from the root so they stay correct when reached at another ply
+	static int ToStoredScore(const int score, const int ply)
+	{
+		if (score >= MATE_SCORE - MAX_PLY) return score + ply;
+		if (score <= -(MATE_SCORE - MAX_PLY)) return score - ply;
+		return score;
+	}
+
+	static int FromStoredScore(const int score, const int ply)
+	{
+		if (score >= MATE_SCORE - MAX_PLY) return score - ply;
+		if (score <= -(MATE_SCORE - MAX_PLY)) return score + ply;
+		return score;
+	}
+
+	TranspositionTable::TranspositionTable(const size_t megabytes)
+		: m_clusters(), m_clusterCount(0), m_age(0)
+	{
+		TryResize(megabytes);
+	}
+
+	bool TranspositionTable::TryResize(const size_t megabytes)
+	{
+		if (megabytes == 0 || megabytes > MAX_HASH_MEGABYTES)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to resize the transposition table to {}MB "
+				"but it must be between 1 and {}MB", megabytes, MAX_HASH_MEGABYTES));
+			return false;
+		}
+
+		const size_t clusterCount = megabytes * BYTES_PER_MEGABYTE / sizeof(Cluster);
+		if (clusterCount == m_clusterCount)
+		{
+			Clear();
+			return true;
+		}
+
+		m_clusters.reset();
+		m_clusters.reset(new (std::nothrow) Cluster[clusterCount]);
+		if (m_clusters == nullptr)
+		{
+			Utils::Log(Utils::LogType::Error, std::format("Tried to resize the transposition table to {}MB "
+				"but the memory could not be allocated", megabytes));
+			m_clusterCount = 0;
+			return false;
+		}
+		m_clusterCount = clusterCount;
+		Clear();
+		return true;
+	}
+
+	size_t TranspositionTable::GetSizeInMegabytes() const
+	{
+		return m_clusterCount * sizeof(Cluster) / BYTES_PER_MEGABYTE;
+	}
+
+	void TranspositionTable::Clear()
+	{
+		for (size_t i = 0; i < m_clusterCount; i++)
+		{
+			for (auto& entry : m_clusters[i].Entries)
+			{
+				entry.KeyXorData.store(0, std::memory_order_relaxed);
+				entry.Data.store(0, std::memory_order_relaxed);
+			}
+		}
+		m_age.store(0, std::memory_order_relaxed);
+	}
+
+	void TranspositionTable::NewSearch()
+	{
+		m_age.store((m_age.load(std::memory_order_relaxed) + 1) & AGE_MASK, std::memory_order_relaxed);
+	}
+
+	TranspositionTable::Cluster& TranspositionTable::GetCluster(const Board::ZobristKey key) const
+	{
+		//Maps the top 32 bits of the key onto the cluster count without a division
+		return m_clusters[((key >> 32) * m_clusterCount) >> 32];
+	}
+
+	bool TranspositionTable::Probe(const Board::ZobristKey key, const int ply, TranspositionEntry& entry) const
+	{
+		if (m_clusterCount == 0) return false;
+
+		for (const auto& storedEntry : GetCluster(key).Entries)
+		{
+			const std::uint64_t data = storedEntry.Data.load(std::memory_order_relaxed);
+			if ((storedEntry.KeyXorData.load(std::memory_order_relaxed) ^ data) != key || GetBound(data) == Bound::None) continue;
+
+			entry.BestMove = GetMove(data);
+			entry.Score = FromStoredScore(GetScore(data), ply);
+			entry.Depth = GetDepth(data);
+			entry.BoundType = GetBound(data);
+			return true;
+		}
+		return false;
+	}
+
+	void TranspositionTable::Store(const Board::ZobristKey key, const int ply, const Board::Move& bestMove,
+		const int score, const int depth, const Bound bound)
+	{
+		if (m_clusterCount == 0) return;
+
+		//The entry of the same position is overwritten, otherwise the entry that is oldest and shallowest
+		const std::uint8_t age = m_age.load(std::memory_order_relaxed);
+		Entry* replaceEntry = nullptr;
+		int lowestWorth = INFINITE_SCORE;
+		bool isSamePosition = false;
+		std::uint64_t replaceData = 0;
+		for (auto& storedEntry : GetCluster(key).Entries)
+		{
+			const std::uint64_t data = storedEntry.Data.load(std::memory_order_relaxed);
+			if ((storedEntry.KeyXorData.load(std::memory_order_relaxed) ^ data) == key)
+			{
+				replaceEntry = &storedEntry;
+				replaceData = data;
+				isSamePosition = true;
+				break;
+			}
+
+			const int ageDistance = (age - GetAge(data)) & AGE_MASK;
+			const int worth = GetDepth(data) - 8 * ageDistance;
+			if (worth < lowestWorth)
+			{
+				lowestWorth = worth;
+				replaceEntry = &storedEntry;
+			}
+		}
+
+		//A shallower result for the same position only replaces exact scores when it is also exact,
+		//and keeps the stored move when it has none of its own
+		Board::Move moveToStore = bestMove;
+		if (isSamePosition)
+		{
+			if (bound != Bound::Exact && GetBound(replaceData) == Bound::Exact && depth < GetDepth(replaceData)) return;
+			if (moveToStore.IsNull()) moveToStore = GetMove(replaceData);
+		}
+
+		const std::uint64_t data = PackData(moveToStore, ToStoredScore(score, ply), std::clamp(depth, 0, 255), bound, age);
+		replaceEntry->KeyXorData.store(key ^ data, std::memory_order_relaxed);
+		replaceEntry->Data.store(data, std::memory_order_relaxed);
+	}
+
+	int TranspositionTable::GetHashfull() const
+	{
+		const size_t sampleCount = std::min(HASHFULL_SAMPLE_CLUSTERS, m_clusterCount);
+		if (sampleCount == 0) return 0;
+
+		const std::uint8_t age = m_age.load(std::memory_order_relaxed);
+		size_t usedEntries = 0;
+		for (size_t i = 0; i < sampleCount; i++)
+		{
+			for (const auto& entry : m_clusters[i].Entries)
+			{
+				const std::uint64_t data = entry.Data.load(std::memory_order_relaxed);
+				if (GetBound(data) != Bound::None && GetAge(data) == age) usedEntries++;
+			}
+		}
+		return static_cast<int>(usedEntries * 1000 / (sampleCount * CLUSTER_SIZE));
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "Move.hpp"
+#include "Zobrist.hpp"
+
+namespace Engine
+{
+	constexpr size_t DEFAULT_HASH_MEGABYTES = 16;
+	constexpr size_t MAX_HASH_MEGABYTES = 64 * 1024;
+
+	enum class Bound : std::uint8_t
+	{
+		None = 0,
+		//The score is at most this (no move raised alpha)
+		Upper = 1,
+		//The score is at least this (a move failed high)
+		Lower = 2,
+		Exact = 3,
+	};
+
+	struct TranspositionEntry
+	{
+		Board::Move BestMove;
+		int Score;
+		int Depth;
+		Bound BoundType;
+	};
+
+	/// <summary>
+	/// Position hash to search result cache shared by every search thread without locks.
+	/// Each entry stores its data next to the key xored with that data, so an entry torn by two threads 
+	/// writing at once no longer matches its key and is treated as a miss instead of a wrong hit.
+	/// Entries are grouped in clusters of one cache line that a position can be stored anywhere in
+	/// </summary>
+	class TranspositionTable
+	{
+	private:
+		struct Entry
+		{
+			std::atomic<std::uint64_t> KeyXorData;
+			std::atomic<std::uint64_t> Data;
+		};
+
+		static constexpr size_t CLUSTER_SIZE = 4;
+		struct alignas(64) Cluster
+		{
+			std::array<Entry, CLUSTER_SIZE> Entries;
+		};
+		static_assert(sizeof(Cluster) == 64, "A cluster must fill exactly one cache line");
+
+		std::unique_ptr<Cluster[]> m_clusters;
+		size_t m_clusterCount;
+		//Increased every search so entries from older searches are replaced first
+		std::atomic<std::uint8_t> m_age;
+
+		Cluster& GetCluster(const Board::ZobristKey key) const;
+
+	public:
+		TranspositionTable(const size_t megabytes = DEFAULT_HASH_MEGABYTES);
+		TranspositionTable(const TranspositionTable&) = delete;
+		TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+		/// <summary>
+		/// Reallocates the table to the size (which clears it). Must not be called while a search uses the table
+		/// </summary>
+		/// <param name="megabytes"></param>
+		/// <returns></returns>
+		bool TryResize(const size_t megabytes);
+		size_t GetSizeInMegabytes() const;
+
+		void Clear();
+		//Marks the start of a new search so entries of earlier searches become the first to be replaced
+		void NewSearch();
+
+		/// <summary>
+		/// Returns true and fills the entry if the position is stored. Mate scores are relative
+		/// to the root so they are adjusted by the ply the position was reached at
+		/// </summary>
+		/// <param name="key"></param>
+		/// <param name="ply"></param>
+		/// <param name="entry"></param>
+		/// <returns></returns>
+		bool Probe(const Board::ZobristKey key, const int ply, TranspositionEntry& entry) const;
+		void Store(const Board::ZobristKey key, const int ply, const Board::Move& bestMove, 
+			const int score, const int depth, const Bound bound);
+
+		//Returns how full the table is in permill, sampled from the first clusters
+		int GetHashfull() const;
+	};
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include "WinProbability.hpp"
+#include "Search.hpp"
+#include "GameState.hpp"
+#include "Color.hpp"
+
+namespace Engine
+{
+	float ToWinProbability(const int centipawns)
+	{
+		return static_cast<float>(1.0 / (1.0 + std::pow(10.0, -centipawns / WIN_PROBABILITY_SCALE)));
+	}
+
+	WinProbabilityService::WinProbabilityService()
+		: m_table(WIN_PROBABILITY_HASH_MEGABYTES), m_cache(), m_pending(nullptr), m_requestedHash(std::nullopt), m_isBusy(false),
+		m_isShuttingDown(false), m_stopSignal(false), m_mutex(), m_requestAdded(), m_becameIdle(), m_worker()
+	{
+		m_worker = std::thread([this]() -> void { RunWorker(); });
+	}
+
+	WinProbabilityService::~WinProbabilityService()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isShuttingDown = true;
+			m_pending.reset();
+			m_stopSignal.store(true, std::memory_order_relaxed);
+		}
+		m_requestAdded.notify_one();
+		if (m_worker.joinable()) m_worker.join();
+	}
+
+	void WinProbabilityService::RunWorker()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true)
+		{
+			m_requestAdded.wait(lock, [this]() -> bool { return m_isShuttingDown || m_pending != nullptr; });
+			if (m_isShuttingDown) return;
+
+			std::unique_ptr<PendingRequest> request = std::move(m_pending);
+			m_stopSignal.store(false, std::memory_order_relaxed);
+			m_isBusy = true;
+			lock.unlock();
+
+			SearchLimits limits = request->Limits;
+			limits.StopSignal = &m_stopSignal;
+			limits.OnProgress = nullptr;
+			limits.Threads = 1;
+			const SearchResult result = Search(*request->Position, limits, m_table);
+
+			//Scores are for the player to move so they are turned around when dark is to move
+			const int lightScore = request->Position->CurrentPlayer == ArmyColor::Light ? result.Score : -result.Score;
+			const WinProbability probability = { request->Position->Hash, ToWinProbability(lightScore), lightScore, result.Depth };
+
+			lock.lock();
+			//A stopped search still returns its deepest completed iteration so it is cached as long as one was completed,
+			//but only the position that was asked for last is still wanted by the callback
+			if (result.Depth > 0)
+			{
+				if (m_cache.size() >= MAX_CACHED_WIN_PROBABILITIES) m_cache.clear();
+				m_cache.insert_or_assign(probability.Hash, probability);
+
+				if (m_requestedHash == probability.Hash)
+				{
+					lock.unlock();
+					if (request->Callback) request->Callback(probability);
+					lock.lock();
+				}
+			}
+
+			m_isBusy = false;
+			m_becameIdle.notify_all();
+		}
+	}
+
+	void WinProbabilityService::Request(const GameState& state, const SearchLimits& limits, const WinProbabilityCallback& callback)
+	{
+		std::optional<WinProbability> cached = std::nullopt;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			//Whatever was asked before is out of date now
+			m_pending.reset();
+			m_requestedHash = state.Hash;
+			if (m_isBusy) m_stopSignal.store(true, std::memory_order_relaxed);
+
+			auto cachedIt = m_cache.find(state.Hash);
+			if (cachedIt != m_cache.end()) cached = cachedIt->second;
+			else
+			{
+				auto request = std::make_unique<PendingRequest>();
+				request->Position = std::make_unique<GameState>();
+				CopyPosition(state, *request->Position);
+				request->Limits = limits;
+				request->Callback = callback;
+				m_pending = std::move(request);
+			}
+		}
+
+		if (cached.has_value())
+		{
+			if (callback) callback(cached.value());
+			return;
+		}
+		m_requestAdded.notify_one();
+	}
+
+	std::optional<WinProbability> WinProbabilityService::TryGetCached(const Board::ZobristKey hash) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto cachedIt = m_cache.find(hash);
+		if (cachedIt == m_cache.end()) return std::nullopt;
+		return cachedIt->second;
+	}
+
+	void WinProbabilityService::Cancel()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_pending.reset();
+		m_requestedHash = std::nullopt;
+		if (m_isBusy) m_stopSignal.store(true, std::memory_order_relaxed);
+		m_becameIdle.wait(lock, [this]() -> bool { return !m_isBusy; });
+	}
+
+	void WinProbabilityService::Clear()
+	{
+		Cancel();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_cache.clear();
+		m_table.Clear();
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include "GameState.hpp"
+#include "Zobrist.hpp"
+#include "Search.hpp"
+#include "TranspositionTable.hpp"
+
+namespace Engine
+{
+	//A score of this many centipawns is a 10 to 1 favourite (the same curve as elo ratings)
+	constexpr double WIN_PROBABILITY_SCALE = 400;
+	//The cache is cleared once it has this many positions so a long session does not keep growing it
+	constexpr size_t MAX_CACHED_WIN_PROBABILITIES = 4096;
+	//The searches are short so a small table of their own keeps them from pushing out the engine's entries
+	constexpr size_t WIN_PROBABILITY_HASH_MEGABYTES = 4;
+
+	struct WinProbability
+	{
+		Board::ZobristKey Hash;
+		//From 0 to 1 (dark's chance is 1 minus this)
+		float Light;
+		//Centipawns from light's point of view
+		int Score;
+		int Depth;
+	};
+
+	//Called on the worker thread once a search is done, or on the requesting thread if the position was cached
+	using WinProbabilityCallback = std::function<void(const WinProbability& probability)>;
+
+	/// <summary>
+	/// Maps a score to the chance the player it is for wins, with a logistic curve
+	/// </summary>
+	/// <param name="centipawns"></param>
+	/// <returns></returns>
+	float ToWinProbability(const int centipawns);
+
+	/// <summary>
+	/// Estimates win chances with short searches on a worker thread of its own, so asking never waits on the engine.
+	/// Only the latest request matters: a new one stops the search of the one before it, whose result is only cached.
+	/// Results are cached by position hash
+	/// </summary>
+	class WinProbabilityService
+	{
+	private:
+		struct PendingRequest
+		{
+			std::unique_ptr<GameState> Position;
+			SearchLimits Limits;
+			WinProbabilityCallback Callback;
+		};
+
+		TranspositionTable m_table;
+		std::unordered_map<Board::ZobristKey, WinProbability> m_cache;
+		std::unique_ptr<PendingRequest> m_pending;
+		//The position of the latest request (none once cancelled), the only one whose result is still handed to its callback
+		std::optional<Board::ZobristKey> m_requestedHash;
+		//True from taking a request until its callback is done
+		bool m_isBusy;
+		bool m_isShuttingDown;
+		std::atomic<bool> m_stopSignal;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_requestAdded;
+		std::condition_variable m_becameIdle;
+		//Declared last so everything the worker uses exists before it starts
+		std::thread m_worker;
+
+		void RunWorker();
+
+	public:
+		WinProbabilityService();
+		~WinProbabilityService();
+
+		WinProbabilityService(const WinProbabilityService&) = delete;
+		WinProbabilityService& operator=(const WinProbabilityService&) = delete;
+
+		/// <summary>
+		/// Estimates the win chances of the position within the limits (the stop signal, progress callback and
+		/// thread count are replaced). The network in the limits must stay loaded until Cancel is called or the result arrives
+		/// </summary>
+		/// <param name="state"></param>
+		/// <param name="limits"></param>
+		/// <param name="callback"></param>
+		void Request(const GameState& state, const SearchLimits& limits, const WinProbabilityCallback& callback);
+		std::optional<WinProbability> TryGetCached(const Board::ZobristKey hash) const;
+
+		/// <summary>
+		/// Drops the pending request, stops the current search and waits until the worker no longer calls any callback
+		/// </summary>
+		void Cancel();
+		/// <summary>
+		/// Cancels and forgets every cached result (for when the evaluation changes)
+		/// </summary>
+		void Clear();
+	};
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include "WorkStealingPool.hpp"
+
+namespace Utils
+{
+	//Which pool and worker the current thread is, so tasks submitting tasks can put them on their own queue
+	static thread_local const WorkStealingPool* t_currentPool = nullptr;
+	static thread_local int t_currentWorkerIndex = -1;
+
+	WorkStealingPool::WorkStealingPool(const int threadCount)
+		: m_queues(), m_workers(), m_stateMutex(), m_workAvailable(), m_idle(), m_queuedCount(0), m_pendingCount(0),
+		m_stolenCount(0), m_nextQueue(0), m_isStopping(false)
+	{
+		const int workerCount = std::max(threadCount, 1);
+		for (int i = 0; i < workerCount; i++) m_queues.push_back(std::make_unique<WorkerQueue>());
+
+		m_workers.reserve(workerCount);
+		for (int i = 0; i < workerCount; i++) m_workers.emplace_back(&WorkStealingPool::RunWorker, this, i);
+	}
+
+	WorkStealingPool::~WorkStealingPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_stateMutex);
+			m_isStopping = true;
+		}
+		m_workAvailable.notify_all();
+		for (auto& worker : m_workers) worker.join();
+	}
+
+	void WorkStealingPool::Submit(Task task)
+	{
+		const bool isOwnWorker = t_currentPool == this;
+		const size_t queueIndex = isOwnWorker ? static_cast<size_t>(t_currentWorkerIndex) :
+			static_cast<size_t>(m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size());
+
+		m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+		{
+			//Counted under the state mutex so a worker checking for work right before it sleeps can not miss this task.
+			//Counted before it is queued so the count never drops below zero when a worker takes it right away
+			std::lock_guard<std::mutex> lock(m_stateMutex);
+			m_queuedCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		WorkerQueue& queue = *m_queues[queueIndex];
+		{
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			queue.Tasks.push_back(std::move(task));
+		}
+		m_workAvailable.notify_one();
+	}
+
+	void WorkStealingPool::WaitUntilIdle()
+	{
+		std::unique_lock<std::mutex> lock(m_stateMutex);
+		m_idle.wait(lock, [this]() -> bool { return m_pendingCount.load(std::memory_order_acquire) == 0; });
+	}
+
+	int WorkStealingPool::GetThreadCount() const
+	{
+		return static_cast<int>(m_workers.size());
+	}
+
+	std::uint64_t WorkStealingPool::GetStolenTaskCount() const
+	{
+		return m_stolenCount.load(std::memory_order_relaxed);
+	}
+
+	bool WorkStealingPool::TryPopOwnTask(const int workerIndex, Task& task)
+	{
+		WorkerQueue& queue = *m_queues[workerIndex];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (queue.Tasks.empty()) return false;
+
+		task = std::move(queue.Tasks.back());
+		queue.Tasks.pop_back();
+		return true;
+	}
+
+	bool WorkStealingPool::TryStealTask(const int workerIndex, Task& task)
+	{
+		//Starting at the next worker instead of the first keeps all thieves from lining up on the same queue
+		for (size_t offset = 1; offset < m_queues.size(); offset++)
+		{
+			WorkerQueue& queue = *m_queues[(workerIndex + offset) % m_queues.size()];
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			if (queue.Tasks.empty()) continue;
+
+			task = std::move(queue.Tasks.front());
+			queue.Tasks.pop_front();
+			m_stolenCount.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+		return false;
+	}
+
+	void WorkStealingPool::RunWorker(const int workerIndex)
+	{
+		t_currentPool = this;
+		t_currentWorkerIndex = workerIndex;
+
+		Task task;
+		while (true)
+		{
+			if (TryPopOwnTask(workerIndex, task) || TryStealTask(workerIndex, task))
+			{
+				m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+				task(workerIndex);
+				task = nullptr;
+
+				if (m_pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					std::lock_guard<std::mutex> lock(m_stateMutex);
+					m_idle.notify_all();
+				}
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_stateMutex);
+			m_workAvailable.wait(lock, [this]() -> bool { return m_isStopping || m_queuedCount.load(std::memory_order_relaxed) > 0; });
+			//Queued tasks still run when stopping so the destructor does not drop work
+			if (m_isStopping && m_queuedCount.load(std::memory_order_relaxed) == 0) return;
+		}
+	}
+}
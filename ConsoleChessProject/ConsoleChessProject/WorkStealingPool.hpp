@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+	/// <summary>
+	/// Fixed set of worker threads that each have their own queue of tasks. A worker runs the newest task of its own queue
+	/// first (tasks submitted by a task go on its worker's queue, so related work stays on the same thread) and when that is empty
+	/// it steals the oldest task of another worker's queue, so no thread sits idle while others still have work queued
+	/// </summary>
+	class WorkStealingPool
+	{
+	public:
+		//Called with the index of the worker running it (0 to thread count - 1) so tasks can use per worker resources
+		using Task = std::function<void(int)>;
+
+	private:
+		struct WorkerQueue
+		{
+			std::deque<Task> Tasks;
+			std::mutex Mutex;
+		};
+
+		std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+		std::vector<std::thread> m_workers;
+		//Guards sleeping and waking up: the count of queued tasks only goes up and the stop flag is only set while holding it
+		std::mutex m_stateMutex;
+		std::condition_variable m_workAvailable;
+		std::condition_variable m_idle;
+		std::atomic<std::uint64_t> m_queuedCount;
+		//Queued and running tasks
+		std::atomic<std::uint64_t> m_pendingCount;
+		std::atomic<std::uint64_t> m_stolenCount;
+		std::atomic<std::uint64_t> m_nextQueue;
+		bool m_isStopping;
+
+		bool TryPopOwnTask(const int workerIndex, Task& task);
+		bool TryStealTask(const int workerIndex, Task& task);
+		void RunWorker(const int workerIndex);
+
+	public:
+		/// <summary>
+		/// Starts the workers right away (at least 1)
+		/// </summary>
+		/// <param name="threadCount"></param>
+		explicit WorkStealingPool(const int threadCount);
+		/// <summary>
+		/// Runs every task still queued and then stops the workers
+		/// </summary>
+		~WorkStealingPool();
+
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+		/// <summary>
+		/// Queues the task on the calling worker's own queue when called from one of this pool's tasks
+		/// and on the workers' queues in turn from any other thread
+		/// </summary>
+		/// <param name="task"></param>
+		void Submit(Task task);
+		/// <summary>
+		/// Blocks until every task (including the ones submitted by tasks while waiting) has finished
+		/// </summary>
+		void WaitUntilIdle();
+
+		int GetThreadCount() const;
+		//Tasks that ran on another worker than the one whose queue they were on
+		std::uint64_t GetStolenTaskCount() const;
+	};
+}
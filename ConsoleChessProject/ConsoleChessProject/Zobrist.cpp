@@ -0,0 +1,22 @@
+#include "Zobrist.hpp"
+#include "GameState.hpp"
+#include "Bitboard.hpp"
+
+namespace Board
+{
+	ZobristKey CalculateHash(const GameState& state)
+	{
+		ZobristKey hash = 0;
+		Bitboard occupied = state.Bitboards.Occupancy;
+		while (occupied)
+		{
+			const Square square = PopLeastSignificantSquare(occupied);
+			hash ^= GetPieceKey(state.Bitboards.PieceCodes[square], square);
+		}
+
+		hash ^= GetCastlingKey(state.CastlingRights);
+		hash ^= GetEnPassantKey(state.EnPassantSquare);
+		hash ^= GetSideToMoveKey(state.CurrentPlayer);
+		return hash;
+	}
+}
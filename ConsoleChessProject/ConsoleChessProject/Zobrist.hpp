@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "Bitboard.hpp"
+#include "GameState.hpp"
+
+namespace Board
+{
+	using ZobristKey = std::uint64_t;
+
+	//Every combination of the 4 castling rights gets its own key so a change of rights is one xor
+	constexpr int CASTLING_RIGHTS_COMBINATIONS = 16;
+
+	struct ZobristKeys
+	{
+		std::array<std::array<ZobristKey, SQUARE_COUNT>, NO_PIECE> Pieces;
+		std::array<ZobristKey, CASTLING_RIGHTS_COMBINATIONS> CastlingRights;
+		//Only the file matters since the rank follows from the side to move
+		std::array<ZobristKey, BOARD_DIMENSION> EnPassantFiles;
+		//Xored in when dark is to move
+		ZobristKey DarkToMove;
+	};
+
+	//SplitMix64 so the keys are fixed at compile time and identical in every build and run
+	constexpr ZobristKey NextZobristKey(std::uint64_t& seed)
+	{
+		seed += 0x9E3779B97F4A7C15ULL;
+		std::uint64_t result = seed;
+		result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		result = (result ^ (result >> 27)) * 0x94D049BB133111EBULL;
+		return result ^ (result >> 31);
+	}
+
+	constexpr ZobristKeys CreateZobristKeys()
+	{
+		ZobristKeys keys = {};
+		std::uint64_t seed = 0x436865737343686BULL;
+		for (auto& pieceKeys : keys.Pieces)
+		{
+			for (auto& key : pieceKeys) key = NextZobristKey(seed);
+		}
+		for (auto& key : keys.CastlingRights) key = NextZobristKey(seed);
+		for (auto& key : keys.EnPassantFiles) key = NextZobristKey(seed);
+		keys.DarkToMove = NextZobristKey(seed);
+
+		//No rights hash to nothing so a position without castling only depends on its pieces and side
+		keys.CastlingRights[NO_CASTLING] = 0;
+		return keys;
+	}
+
+	inline constexpr ZobristKeys ZOBRIST_KEYS = CreateZobristKeys();
+
+	inline ZobristKey GetPieceKey(const PieceCode code, const Square square) { return ZOBRIST_KEYS.Pieces[code][square]; }
+	inline ZobristKey GetCastlingKey(const CastlingRights rights) { return ZOBRIST_KEYS.CastlingRights[rights]; }
+	inline ZobristKey GetEnPassantKey(const Square square)
+	{
+		return square == NO_SQUARE ? 0 : ZOBRIST_KEYS.EnPassantFiles[GetFile(square)];
+	}
+	inline ZobristKey GetSideToMoveKey(const ArmyColor color) { return color == ArmyColor::Dark ? ZOBRIST_KEYS.DarkToMove : 0; }
+
+	/// <summary>
+	/// Calculates the key of the position from scratch (pieces, side to move, castling rights and en passant square).
+	/// MakeMove/UnmakeMove keep GameState::Hash equal to this incrementally, so this is for setting up
+	/// positions and for validating the incremental key
+	/// </summary>
+	/// <param name="state"></param>
+	/// <returns></returns>
+	ZobristKey CalculateHash(const GameState& state);
+}